@@ -0,0 +1,34 @@
+# profile the sequences of operations executed by the programs of a corpus and
+# generate the superinstructions header from the profile
+#
+# the input of a program <name>.yog is read from <name>.in if it exists
+
+file(REMOVE ${PROFILE})
+file(WRITE ${PROFILE}.empty "")
+
+file(GLOB PROGRAMS ${CORPUS}/*.yog)
+
+foreach(PROGRAM ${PROGRAMS})
+      get_filename_component(NAME ${PROGRAM} NAME_WE)
+
+      set(INPUT ${CORPUS}/${NAME}.in)
+      if(NOT EXISTS ${INPUT})
+            set(INPUT ${PROFILE}.empty)
+      endif()
+
+      execute_process(COMMAND ${YOG} --profile-sequences=${PROFILE} ${PROGRAM}
+                      INPUT_FILE ${INPUT}
+                      OUTPUT_QUIET
+                      ERROR_QUIET)
+endforeach()
+
+if(NOT EXISTS ${PROFILE})
+      message(FATAL_ERROR "no sequence profile collected from ${CORPUS}")
+endif()
+
+execute_process(COMMAND ${SUPERGEN} -n ${COUNT} -o ${OUTPUT} ${PROFILE}
+                RESULT_VARIABLE RESULT)
+
+if(NOT RESULT EQUAL 0)
+      message(FATAL_ERROR "supergen failed")
+endif()
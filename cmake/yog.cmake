@@ -0,0 +1,34 @@
+# yog_add_executable(<target> <source>)
+#
+# translate the yog program <source> to C with yog --emit-c and build it into
+# the executable <target>, the yog target of this project is used if defined,
+# otherwise the yog executable found in the path (YOG_EXECUTABLE)
+#
+# the signed arithmetic of yog wraps around, so the translation is compiled
+# with -fwrapv if the compiler supports it
+
+function(yog_add_executable TARGET SOURCE)
+      get_filename_component(SOURCE ${SOURCE} ABSOLUTE)
+      set(OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/${TARGET}.c)
+
+      if(TARGET yog)
+            set(YOG yog)
+      else()
+            find_program(YOG_EXECUTABLE yog)
+            if(NOT YOG_EXECUTABLE)
+                  message(FATAL_ERROR "yog not found, set YOG_EXECUTABLE")
+            endif()
+            set(YOG ${YOG_EXECUTABLE})
+      endif()
+
+      add_custom_command(OUTPUT ${OUTPUT}
+                         COMMAND ${YOG} --emit-c ${OUTPUT} ${SOURCE}
+                         DEPENDS ${YOG} ${SOURCE}
+                         COMMENT "Translating ${SOURCE} to C")
+
+      add_executable(${TARGET} ${OUTPUT})
+
+      if(CMAKE_C_COMPILER_ID MATCHES "GNU|Clang")
+            target_compile_options(${TARGET} PRIVATE -fwrapv)
+      endif()
+endfunction()
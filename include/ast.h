@@ -80,3 +80,9 @@ struct ast *ast_add_child(struct ast *tree, struct ast *child);
  */
 void ast_clear(struct ast *tree);
 
+/**
+ * @brief Get the source location of an abstract syntax tree
+ * @param tree The abstract syntax tree
+ * @return The location of the first terminal node of the tree, row 0 if none
+ */
+struct location ast_location(const struct ast *tree);
@@ -0,0 +1,133 @@
+
+/*! @file batch.h */
+
+#pragma once
+
+#include "interpreter.h"
+
+/*! @brief The execution of the program over one input file */
+struct batch_job
+{
+	/*! @brief The name of the input file */
+	const char *filename;
+
+	/*! @brief The values written by the execution */
+	char *output;
+
+	/*! @brief The number of characters of the written values */
+	size_t output_len;
+
+	/*! @brief Set if the input file could not be opened */
+	bool failed;
+
+	/*! @brief Set if the output of the execution could not be buffered, the job is then not executed */
+	bool unbuffered;
+
+	/*! @brief The outcome of the execution */
+	enum interpreter_status status;
+
+	/*! @brief The program counter where the execution stopped */
+	size_t pc;
+
+	/*! @brief The number of instructions retired by the execution */
+	uint64_t retired;
+};
+
+struct batch_state;
+
+/**
+ * @brief The batch runner executes one compiled program over many input files with a pool of workers
+ *
+ * The bytecode is shared read-only, each worker has its own interpreter, i.e. its own frame
+ * of variables and temporaries, and reuses it for all its jobs. The jobs are split among the workers,
+ * which steal the jobs of the others once theirs are done, and the outputs are written in the order of the inputs
+ */
+struct batch
+{
+	/*! @brief The executed bytecode */
+	const struct bytecode *bc;
+
+	/*! @brief The instruction dispatch technique of the interpreters */
+	enum interpreter_dispatch dispatch;
+
+	/*! @brief The number of instructions each job may retire, UINT64_MAX if unlimited */
+	uint64_t fuel;
+
+	/*! @brief The wall-clock time in seconds each job may take, zero if unlimited */
+	double timeout;
+
+	/*! @brief The number of workers */
+	size_t workers_cnt;
+
+	/*! @brief Set if the workers are pinned to the processors */
+	bool pin;
+
+	/*! @brief Set if the input files hold raw little-endian integers */
+	bool binary_input;
+
+	/*! @brief Set if the values are written as raw little-endian integers */
+	bool binary_output;
+
+	/*! @brief The jobs */
+	struct batch_job *jobs;
+
+	/*! @brief The number of jobs */
+	size_t jobs_cnt;
+
+	/*! @brief The number of jobs stolen from another worker */
+	uint64_t steals;
+
+	/*! @brief The synchronization state of the workers */
+	struct batch_state *state;
+};
+
+/**
+ * @brief Check if the batch runner executes the jobs in parallel on this platform (POSIX threads)
+ * @return true if the jobs are executed in parallel, false if they are executed in order by the caller
+ */
+bool batch_supported(void);
+
+/**
+ * @brief Get the number of online processors
+ * @return The number of online processors, 1 if unknown
+ */
+size_t batch_processors(void);
+
+/**
+ * @brief Initialize a batch runner
+ * @param b A pointer to the batch runner to initialize
+ * @param bc A pointer to the bytecode to execute
+ * @param dispatch The instruction dispatch technique of the interpreters
+ * @param workers_cnt The number of workers
+ */
+void batch_init(struct batch *b, const struct bytecode *bc, enum interpreter_dispatch dispatch, size_t workers_cnt);
+
+/**
+ * @brief Clear a batch runner
+ * @param b A pointer to the batch runner to clear
+ */
+void batch_clear(struct batch *b);
+
+/**
+ * @brief Execute the bytecode once for each input file
+ *
+ * The read statements read the values from the input file without prompting, the values written by
+ * each job are written to out in the order of the input files, a job is reported on err if its input
+ * file could not be opened, if it reached a limit or if it stopped at a division by zero
+ * @param b A pointer to the batch runner
+ * @param filenames The names of the input files
+ * @param cnt The number of input files
+ * @param out The output of the jobs
+ * @param err The output of the failures
+ * @return 0 if all the jobs halted, otherwise the status of the first failed job (2 input not opened or output not buffered, 4 fuel exhausted, 5 deadline exceeded, 6 division by zero, 7 end of input, 8 invalid input)
+ */
+int batch_execute(struct batch *b, const char **filenames, size_t cnt, FILE *out, FILE *err);
+
+/**
+ * @brief Write the output of a completed job and report its failure, if any
+ * @param job A pointer to the completed job
+ * @param out The output of the jobs
+ * @param err The output of the failures
+ * @return 0 if the job halted, otherwise its status as returned by batch_execute
+ */
+int batch_report(const struct batch_job *job, FILE *out, FILE *err);
@@ -0,0 +1,101 @@
+
+/*! @file bytecode.h */
+
+#pragma once
+
+#include "instruction.h"
+
+/*! @brief Pack the kinds of the operands of a bytecode instruction */
+#define BYTECODE_KINDS(src1, src2, dest) ((src1) | (src2) << 2 | (dest) << 4)
+
+/*! @brief Unpack the kind of the first source operand */
+#define BYTECODE_KIND_SRC1(kinds) ((enum operand_type)((kinds) & 3))
+
+/*! @brief Unpack the kind of the second source operand */
+#define BYTECODE_KIND_SRC2(kinds) ((enum operand_type)((kinds) >> 2 & 3))
+
+/*! @brief Unpack the kind of the destination operand */
+#define BYTECODE_KIND_DEST(kinds) ((enum operand_type)((kinds) >> 4 & 3))
+
+/**
+ * @brief The compact fixed-width bytecode instruction (16 bytes)
+ *
+ * The operands are indices, of a frame slot for the variables and the temporaries,
+ * of a constant in the constant pool or of an instruction, depending on their kinds
+ */
+struct bytecode_instruction
+{
+	/*! @brief The type of the instruction */
+	uint8_t type;
+
+	/*! @brief The specialized operation of the instruction */
+	uint8_t op;
+
+	/*! @brief The kinds of the operands, two bits for each operand */
+	uint8_t kinds;
+
+	/*! @brief The superinstruction starting at the instruction, zero if none */
+	uint8_t super;
+
+	/*! @brief The index of the first source operand */
+	uint32_t src1;
+
+	/*! @brief The index of the second source operand */
+	uint32_t src2;
+
+	/*! @brief The index of the destination operand */
+	uint32_t dest;
+};
+
+/*! @brief The bytecode of a program */
+struct bytecode
+{
+	/*! @brief The bytecode instructions */
+	struct bytecode_instruction *code;
+
+	/*! @brief The number of bytecode instructions */
+	size_t size;
+
+	/*! @brief The constant pool of the literals */
+	int64_t *constants;
+
+	/*! @brief The number of constants */
+	size_t constants_cnt;
+
+	/*! @brief The identifiers of the variables, indexed by frame slot */
+	char (*names)[ID_STR_SIZE];
+
+	/*! @brief The number of variables, which occupy the first slots of the frame */
+	size_t vars_cnt;
+
+	/*! @brief The number of temporary variables, which follow the variables in the frame */
+	size_t tmp_cnt;
+};
+
+/**
+ * @brief Initialize a bytecode by encoding a specialized instruction list
+ * @param bc A pointer to the bytecode to initialize, to be cleared only if initialized
+ * @param instrs The specialized instruction list to encode
+ * @param st The symbol table of the variables
+ * @param vars_cnt The number of variables
+ * @param tmp_cnt The number of temporary variables
+ * @return true if initialized, false if the instructions or the slots do not fit the 32-bit operands of the bytecode
+ */
+bool bytecode_init(struct bytecode *bc, struct instruction_list instrs, struct symbol_table st, size_t vars_cnt, size_t tmp_cnt);
+
+/**
+ * @brief Check that a bytecode which has not been encoded by bytecode_init, e.g. loaded from a file, can be executed
+ *
+ * The types, the operations, the kinds and the superinstructions of the instructions must agree as the encoding
+ * makes them agree, the operands must be in the frame, in the constant pool or in the instructions, up to the halt,
+ * and the identifiers of the variables must be terminated
+ * @param bc A pointer to the bytecode to check
+ * @return true if the bytecode is valid, false otherwise
+ */
+bool bytecode_valid(const struct bytecode *bc);
+
+/**
+ * @brief Clear a bytecode
+ * @param bc A pointer to the bytecode to clear
+ */
+void bytecode_clear(struct bytecode *bc);
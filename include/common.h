@@ -56,3 +56,10 @@ void yfree(void *ptr);
  */
 char *ystrdup(char *str);
 
+/**
+ * @brief Read a whole file
+ * @param filename The name of the file
+ * @param size A pointer to the number of bytes read
+ * @return A pointer to the bytes of the file, NULL if it cannot be opened
+ */
+char *yread_file(const char *filename, size_t *size);
@@ -0,0 +1,45 @@
+
+/*! @file compiler.h */
+
+#pragma once
+
+#include "bytecode.h"
+#include "linetable.h"
+
+/*! @brief The compilation of a program to bytecode */
+struct compilation
+{
+	/*! @brief The symbol table of the variables */
+	struct symbol_table st;
+
+	/*! @brief The specialized instruction list */
+	struct instruction_list instrs;
+
+	/*! @brief The bytecode of the program */
+	struct bytecode bc;
+
+	/*! @brief The source locations of the instructions */
+	struct line_table lines;
+
+	/*! @brief The number of temporary variables before their allocation to registers */
+	size_t tmp_cnt;
+};
+
+/**
+ * @brief Compile a program to bytecode
+ *
+ * The source code is parsed and analysed, the temporaries are allocated to registers,
+ * the instructions are specialized, combined in superinstructions and encoded
+ * @param comp A pointer to the compilation to initialize, to be cleared only if the program is compiled
+ * @param source The source code buffer
+ * @param size The number of characters of the source code
+ * @param errors The file the compilation errors are printed to, NULL to discard them
+ * @return true if the program has been compiled, false if it has errors or it is too large for the bytecode
+ */
+bool compile(struct compilation *comp, const char *source, size_t size, FILE *errors);
+
+/**
+ * @brief Clear a compilation
+ * @param comp A pointer to the compilation to clear
+ */
+void compilation_clear(struct compilation *comp);
@@ -0,0 +1,22 @@
+
+/*! @file emitter.h */
+
+#pragma once
+
+#include "bytecode.h"
+#include "linetable.h"
+
+/**
+ * @brief Write a bytecode as a self-contained C translation unit
+ *
+ * The variables and the temporaries become locals of main, the jump targets become
+ * goto labels and the read and write instructions become calls to a small runtime
+ * emitted with the program. The arithmetic wraps around as in the interpreter
+ * only if the translation unit is compiled with -fwrapv. The runtime errors are reported
+ * with the source lines and the exit statuses of the interpreter
+ * @param out The output file
+ * @param bc A pointer to the bytecode to translate
+ * @param lines The source locations of the instructions
+ * @param filename The name of the source file of the program
+ */
+void emit_c(FILE *out, const struct bytecode *bc, struct line_table lines, const char *filename);
@@ -127,6 +127,13 @@ bool error_list_empty(struct error_list errs);
  */
 void error_list_show(struct error_list errs);
 
+/**
+ * @brief Print an error list to a file
+ * @param out The file to print to
+ * @param errs The error list to print
+ */
+void error_list_print(FILE *out, struct error_list errs);
+
 /**
  * @brief Add a new error node to an error list
  * @param errs A pointer to an error list
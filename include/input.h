@@ -0,0 +1,127 @@
+
+/*! @file input.h */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "common.h"
+
+/*! @brief The default size of the input buffer in bytes, when the input is not mapped */
+#define INPUT_BUFFER_SIZE 65536
+
+/*! @brief The outcomes of reading a value */
+enum input_result
+{
+	INPUT_VALUE,
+	INPUT_END,
+	INPUT_INVALID,
+	INPUT_PENDING
+};
+
+/**
+ * @brief The input of the read statements
+ *
+ * An interactive input reads the values with the standard streams. A non-interactive input parses them
+ * with its own scanner from the mapped file, or from a large buffer filled in chunks if the input
+ * is not a regular file. A value is a decimal integer with an optional sign, separated by white space,
+ * or the 8 bytes of a little-endian integer in a binary input. A non-blocking stream which has no more bytes
+ * yet leaves the value pending, and the scanner continues where it stopped once the bytes arrive
+ */
+struct input
+{
+	/*! @brief The bound input stream, NULL if not bound */
+	FILE *file;
+
+	/*! @brief Set if the values are read with the standard streams */
+	bool interactive;
+
+	/*! @brief Set if the values are raw little-endian integers, which are never read interactively */
+	bool binary;
+
+	/*! @brief Set if the contents are the mapped file */
+	bool mapped;
+
+	/*! @brief Set if the stream has no more bytes to buffer */
+	bool eof;
+
+	/*! @brief The contents of the input, mapped or buffered */
+	char *data;
+
+	/*! @brief The position of the next byte to parse */
+	size_t pos;
+
+	/*! @brief The number of bytes of the contents */
+	size_t size;
+
+	/*! @brief The size of the buffer in bytes, which bounds the length of a value */
+	size_t capacity;
+};
+
+/**
+ * @brief Check if a stream is a terminal, whose input is interactive by default
+ * @param file The stream
+ * @return true if the stream is a terminal, false otherwise or if not supported on this platform
+ */
+bool input_is_terminal(FILE *file);
+
+/**
+ * @brief Initialize an unbound text input
+ * @param in A pointer to the input to initialize
+ */
+void input_init(struct input *in);
+
+/**
+ * @brief Bind an input to a stream at its position, if the stream or the mode change
+ * @param in A pointer to the input
+ * @param file The input stream
+ * @param interactive Set if the values are read with the standard streams
+ */
+void input_bind(struct input *in, FILE *file, bool interactive);
+
+/**
+ * @brief Unbind an input from its stream, moving the stream after the parsed values where possible
+ * @param in A pointer to the input
+ */
+void input_unbind(struct input *in);
+
+/**
+ * @brief Read a value
+ * @param in A pointer to the bound input
+ * @param value A pointer to the value, unchanged if no value has been read
+ * @return INPUT_VALUE if a value has been read, INPUT_END at the end of the input
+ * and INPUT_INVALID if the next characters are not a value or the last value of a binary input is truncated,
+ * which are not consumed, INPUT_PENDING if a non-blocking stream has not received the whole next value yet
+ */
+enum input_result input_int(struct input *in, int64_t *value);
+
+/**
+ * @brief Parse a whole token as a value, as the text inputs do
+ * @param begin The first character of the token
+ * @param end The character after the token
+ * @param value A pointer to the value, unchanged if the token is not a value
+ * @return INPUT_VALUE if the token is a value, INPUT_INVALID if it has other characters than a sign and digits
+ * or if the value is out of range
+ */
+enum input_result input_parse(const char *begin, const char *end, int64_t *value);
+
+/**
+ * @brief Get the position of the next value in the stream of an input
+ * @param in A pointer to the bound input
+ * @return The position, negative if the stream cannot be positioned
+ */
+int64_t input_tell(struct input *in);
+
+/**
+ * @brief Move an input to a position of its stream
+ * @param in A pointer to the bound input
+ * @param offset The position
+ * @return true if the input has been moved, false if the stream cannot be positioned
+ */
+bool input_seek(struct input *in, int64_t offset);
+
+/**
+ * @brief Clear an input, unbinding it
+ * @param in A pointer to the input to clear
+ */
+void input_clear(struct input *in);
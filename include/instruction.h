@@ -4,6 +4,7 @@
 #pragma once
 
 #include "symtable.h"
+#include "opcode.h"
 
 /*! @brief The types of a variable */
 enum operand_type
@@ -52,7 +53,13 @@ enum instruction_type
 	INSTRUCTION_GT,
 	INSTRUCTION_GTE,
 	INSTRUCTION_GOTO,
-	INSTRUCTION_BRANCH
+	INSTRUCTION_BRANCH,
+	INSTRUCTION_BEQ,
+	INSTRUCTION_BNEQ,
+	INSTRUCTION_BLT,
+	INSTRUCTION_BLTE,
+	INSTRUCTION_BGT,
+	INSTRUCTION_BGTE
 };
 
 /*! @brief The three address code instruction */
@@ -61,6 +68,12 @@ struct instruction
 	/*! @brief The type of the instruction */
 	enum instruction_type type;
 
+	/*! @brief The operation specialized for the operand kinds, assigned by the specializer */
+	enum opcode op;
+
+	/*! @brief The superinstruction starting at the instruction, assigned by the peephole pass */
+	unsigned super;
+
 	/*! @brief The first operand */
 	struct operand src1;
 
@@ -84,6 +97,20 @@ struct instruction_list
 	size_t capacity;
 };
 
+/**
+ * @brief Get the number of source operands of an instruction type
+ * @param type The instruction type
+ * @return The number of source operands
+ */
+size_t instruction_src_cnt(enum instruction_type type);
+
+/**
+ * @brief Check if an instruction type has a destination operand
+ * @param type The instruction type
+ * @return true if the instruction type has a destination operand, false otherwise
+ */
+bool instruction_has_dest(enum instruction_type type);
+
 /**
  * @brief Initialize an instruction list
  * @param instrs A pointer to the instruction list to initialize
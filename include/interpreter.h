@@ -3,37 +3,173 @@
 
 #pragma once
 
-#include "instruction.h"
+#include <signal.h>
+#include <setjmp.h>
+
+#include "bytecode.h"
+#include "input.h"
+#include "output.h"
+
+/*! @brief The instruction dispatch techniques of the interpreter */
+enum interpreter_dispatch
+{
+	DISPATCH_CALL,
+	DISPATCH_THREADED,
+	DISPATCH_JIT,
+	DISPATCH_TIERED
+};
+
+/*! @brief The outcomes of an execution */
+enum interpreter_status
+{
+	INTERPRETER_HALTED,
+	INTERPRETER_FUEL_EXHAUSTED,
+	INTERPRETER_DEADLINE_EXCEEDED,
+	INTERPRETER_DIVISION_BY_ZERO,
+	INTERPRETER_END_OF_INPUT,
+	INTERPRETER_INVALID_INPUT,
+	INTERPRETER_NEEDS_INPUT
+};
+
+/*! @brief The default number of executions of a loop back-edge after which the loop is compiled */
+#define INTERPRETER_TIER_THRESHOLD 1000
+
+struct jit_code;
+struct offload;
 
 /*! @brief The interpreter data structure */
 struct interpreter
 {
-	/*! @brief The buffer of temporary variables */
-	int64_t *temporary;
+	/*! @brief The frame of the variables followed by the temporary variables */
+	int64_t *frame;
+
+	/*! @brief A pointer to the bytecode to execute */
+	const struct bytecode *bc;
+
+	/*! @brief The instruction dispatch technique */
+	enum interpreter_dispatch dispatch;
+
+	/*! @brief The threaded code, i.e. the handler address of each instruction */
+	const void **code;
+	const void *const *volatile running;
+
+	/*! @brief The native code of the bytecode, NULL if not compiled */
+	struct jit_code *jit;
+
+	/*! @brief The number of executions of a loop back-edge after which the loop is compiled */
+	uint64_t tier_threshold;
+
+	/*! @brief The output of the tier-up log, NULL if disabled */
+	FILE *tier_log;
+
+	/*! @brief The execution counters of the loop back-edges, indexed by instruction */
+	uint64_t *counters;
+
+	/*! @brief The native code of the compiled loop entered at each instruction, NULL if none */
+	struct jit_code **entries;
+
+	/*! @brief The native code of the compiled loops */
+	struct jit_code **loops;
+
+	/*! @brief The number of compiled loops */
+	size_t loops_cnt;
+
+	/*! @brief The number of instructions the execution may retire, UINT64_MAX if unlimited */
+	uint64_t fuel;
+
+	/*! @brief The monotonic time in seconds after which the execution stops, zero if unlimited */
+	double deadline;
+
+	/*! @brief The number of retired instructions at which the clock is read next */
+	uint64_t clock_retired;
+
+	/*! @brief The number of retired instructions, counted only if the execution is limited */
+	uint64_t retired;
+
+	/*! @brief The outcome of the last execution */
+	enum interpreter_status status;
+
+	/*! @brief The handler called before the instruction following an interrupt, NULL if none */
+	void (*interrupt_handler)(struct interpreter *vm);
+
+	/*! @brief The data of the interrupt handler */
+	void *interrupt_data;
+
+	/*! @brief Set if an interrupt is pending */
+	volatile sig_atomic_t interrupt_pending;
+
+	/*! @brief The input of the read statements */
+	FILE *in;
+
+	/*! @brief The output of the write statements */
+	FILE *out;
+
+	/*! @brief The buffer of the write statements, bound to the output at each execution and flushed at its end */
+	struct output output;
+
+	/*! @brief The scanner of the read statements, bound to the input at the first read and unbound once the execution cannot be resumed */
+	struct input input;
+
+	/*! @brief Set if the read statements prompt for the value of their variable and read it with the standard streams */
+	bool interactive;
+
+	/*! @brief The number of executed read statements */
+	uint64_t reads;
+
+	/*! @brief The threads which read and write the values instead of the input and the output, NULL if none */
+	struct offload *offload;
 
-	/*! @brief The instruction list */
-	struct instruction_list instrs;
+	/*! @brief The callback of the read statements, which replaces the input if not NULL */
+	bool (*read_callback)(void *data, const char *name, int64_t *value);
+
+	/*! @brief The callback of the write statements, which replaces the output if not NULL */
+	void (*write_callback)(void *data, int64_t value);
+
+	/*! @brief The data of the callbacks */
+	void *callback_data;
+
+	/*! @brief The state restored when a runtime error stops the execution */
+	jmp_buf fault;
 
 	/*! @brief The program counter */
 	size_t pc;
 };
 
 /**
- * @brief Get the value of an operand
+ * @brief Get the value of a bytecode operand
  * @param vm A pointer to the interpreter
- * @param op The operand
+ * @param type The kind of the operand
+ * @param index The index of the operand
  * @return The value of the operand
  */
-int64_t operand_get_value(struct interpreter *vm, struct operand op);
+int64_t operand_get_value(struct interpreter *vm, enum operand_type type, uint32_t index);
 
 /**
- * @brief Initialzie an interpreter
+ * @brief Read the value of a variable from the input of the interpreter
+ *
+ * The execution stops with INTERPRETER_END_OF_INPUT at the end of the input, with INTERPRETER_INVALID_INPUT
+ * if the input is not a value and with INTERPRETER_NEEDS_INPUT before the read if a non-blocking input
+ * has no value yet, where it can be resumed once the value arrives
  * @param vm A pointer to the interpreter
- * @param instrs The instruction list to bind
+ * @param slot The frame slot of the variable
+ * @param pc The program counter of the read statement
+ */
+void interpreter_read(struct interpreter *vm, uint32_t slot, size_t pc);
 
- * @param tmp_cnt The number of temporary variables
+/**
+ * @brief Write a value to the output of the interpreter
+ * @param vm A pointer to the interpreter
+ * @param value The value to write
  */
-void interpreter_init(struct interpreter *vm, struct instruction_list instrs, size_t tmp_cnt);
+void interpreter_write(struct interpreter *vm, int64_t value);
+
+/**
+ * @brief Initialzie an interpreter
+ * @param vm A pointer to the interpreter
+ * @param bc A pointer to the bytecode to bind
+ * @param dispatch The instruction dispatch technique, the threaded dispatch is used if the native code is not supported
+ */
+void interpreter_init(struct interpreter *vm, const struct bytecode *bc, enum interpreter_dispatch dispatch);
 
 /**
  * @brief Clear an interpreter
@@ -41,9 +177,77 @@ void interpreter_init(struct interpreter *vm, struct instruction_list instrs, si
  */
 void interpreter_clear(struct interpreter *vm);
 
+/**
+ * @brief Reset an interpreter to execute the bytecode again from the beginning
+ *
+ * The variables are cleared and the numbers of retired instructions and of reads restart from zero,
+ * the native code and the compiled loops are kept
+ * @param vm A pointer to the interpreter to reset
+ */
+void interpreter_reset(struct interpreter *vm);
+
+/**
+ * @brief Limit the execution of an interpreter
+ *
+ * The instructions are charged at the jumps, so an execution may retire a block of instructions
+ * more than its fuel, and it stops after the jump, where it can be resumed. The native code
+ * cannot be limited
+ * @param vm A pointer to the interpreter
+ * @param fuel The number of instructions the execution may retire, UINT64_MAX if unlimited
+ * @param seconds The wall-clock time the execution may take from now, zero if unlimited
+ */
+void interpreter_limit(struct interpreter *vm, uint64_t fuel, double seconds);
+
+/**
+ * @brief Set the handler of the interrupts of an interpreter
+ *
+ * The handler is called with the program counter of the next instruction to execute, the native code cannot be interrupted.
+ * The threaded code checks for the interrupts before each of its instructions if every is set, so the handler is called
+ * before the instruction following the interrupted one, and otherwise only at its back-edges, which keeps the execution
+ * at full speed between the interrupts, the other dispatches check before each instruction
+ * @param vm A pointer to the interpreter
+ * @param handler The interrupt handler
+ * @param data The data of the interrupt handler
+ * @param every Set to check for the interrupts before each instruction of the threaded code
+ */
+void interpreter_set_interrupt_handler(struct interpreter *vm, void (*handler)(struct interpreter *vm), void *data, bool every);
+
+/**
+ * @brief Interrupt the execution of an interpreter before its next checked instruction, it is async-signal-safe
+ *
+ * The interrupt only sets a flag, which the dispatch loops check as the handler was set, so it takes a constant time,
+ * the threaded code checks for it only once a handler is set
+ * @param vm A pointer to the interpreter
+ */
+void interpreter_interrupt(struct interpreter *vm);
+
 /**
  * @brief Execute the interpreter
+ *
+ * The values written by the execution are buffered and written to the output when the execution stops
+ * @param vm A pointer to the interpreter
+ * @return INTERPRETER_HALTED if the program has been executed to the end, otherwise the limit reached
+ * or the runtime error, the program counter and the number of retired instructions are left in the interpreter
+ */
+enum interpreter_status interpreter_execute(struct interpreter *vm);
+
+/**
+ * @brief Check if an execution stopped with a status can be resumed, executing the interpreter again
+ *
+ * The limits and a non-blocking input without a value stop the execution before an instruction,
+ * which keeps its frame and the values buffered from its input
+ * @param status The outcome of the execution
+ * @return true if the execution can be resumed, false if it has ended
+ */
+bool interpreter_resumable(enum interpreter_status status);
+
+/**
+ * @brief Execute the interpreter counting the executions of each instruction
+ *
+ * The instrumented dispatch loop is separate from the other ones, which do not pay for the counting
  * @param vm A pointer to the interpreter
+ * @param counts The execution counters, one for each bytecode instruction
+ * @param cycles The cycles spent in each bytecode instruction (time stamp counter or nanoseconds), NULL if not measured
  */
-void interpreter_execute(struct interpreter *vm);
+void interpreter_execute_counting(struct interpreter *vm, uint64_t *counts, uint64_t *cycles);
 
@@ -0,0 +1,74 @@
+
+/*! @file jit.h */
+
+#pragma once
+
+#include "interpreter.h"
+
+/**
+ * @brief The native code of a region of a bytecode
+ *
+ * The native code keeps all the values in the frame of the interpreter, so it can be
+ * entered at any instruction of the region and it leaves the region with the frame up to date
+ */
+struct jit_code
+{
+	/*! @brief The executable buffer of the native code */
+	uint8_t *buffer;
+
+	/*! @brief The size of the native code in bytes */
+	size_t size;
+
+	/*! @brief The size of the executable buffer in bytes */
+	size_t capacity;
+
+	/*! @brief The native offset of each instruction of the region */
+	uint32_t *offsets;
+
+	/*! @brief The index of the first instruction of the region */
+	size_t start;
+
+	/*! @brief The index of the instruction following the region */
+	size_t end;
+};
+
+/**
+ * @brief Check if the native code generation is supported on this platform (x86-64 System V)
+ * @return true if the native code generation is supported, false otherwise
+ */
+bool jit_supported(void);
+
+/**
+ * @brief Translate a region of a bytecode to native code
+ *
+ * The native code leaves the region when it jumps outside of it and before
+ * a division by zero, which is left to the interpreter to report
+ * @param jit A pointer to the native code to initialize
+ * @param bc A pointer to the bytecode to translate
+ * @param start The index of the first instruction of the region
+ * @param end The index of the instruction following the region
+ */
+void jit_compile(struct jit_code *jit, const struct bytecode *bc, size_t start, size_t end);
+
+/**
+ * @brief Clear the native code of a region
+ * @param jit A pointer to the native code to clear
+ */
+void jit_clear(struct jit_code *jit);
+
+/**
+ * @brief Execute the native code of a region
+ * @param jit A pointer to the native code
+ * @param vm A pointer to the interpreter whose frame is used
+ * @param pc The index of the instruction where to enter the region
+ * @return The index of the instruction where the execution left the region
+ */
+size_t jit_execute(const struct jit_code *jit, struct interpreter *vm, size_t pc);
+
+/**
+ * @brief Write the native code to a file, e.g. for objdump -D -b binary -m i386:x86-64
+ * @param jit A pointer to the native code
+ * @param filename The name of the file
+ * @return true if the native code has been written, false otherwise
+ */
+bool jit_dump(const struct jit_code *jit, const char *filename);
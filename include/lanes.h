@@ -0,0 +1,125 @@
+
+/*! @file lanes.h */
+
+#pragma once
+
+#include "interpreter.h"
+#include "linetable.h"
+
+/*! @brief The number of inputs executed together, one per lane */
+#define LANES_CNT 16
+
+/*! @brief The values read and written by the execution of one lane */
+struct lane
+{
+	/*! @brief The values of the input record of the lane */
+	int64_t *inputs;
+
+	/*! @brief The number of values of the input record */
+	size_t inputs_cnt;
+
+	/*! @brief The capacity of the input values */
+	size_t inputs_capacity;
+
+	/*! @brief The index of the next value to read */
+	size_t next_input;
+
+	/*! @brief Set if a malformed value follows the values of the record, which fails the read reaching it */
+	bool invalid;
+
+	/*! @brief The values written by the lane */
+	int64_t *outputs;
+
+	/*! @brief The number of written values */
+	size_t outputs_cnt;
+
+	/*! @brief The capacity of the written values */
+	size_t outputs_capacity;
+
+	/*! @brief The runtime error which has failed the lane, INTERPRETER_DIVISION_BY_ZERO, INTERPRETER_END_OF_INPUT
+	or INTERPRETER_INVALID_INPUT, INTERPRETER_HALTED otherwise */
+	enum interpreter_status status;
+
+	/*! @brief The program counter of the runtime error */
+	size_t pc;
+};
+
+/**
+ * @brief The multi-lane executor runs a bytecode over many independent input records at once
+ *
+ * Each frame slot is a vector of LANES_CNT values (structure of arrays) and each instruction is
+ * executed over all the lanes with vector operations. The lanes run together while they agree
+ * on the outcome of the branches, when they diverge each lane completes the execution alone.
+ * A lane which fails with a runtime error is masked off, so the other lanes complete their execution
+ */
+struct lanes
+{
+	/*! @brief The executed bytecode */
+	const struct bytecode *bc;
+
+	/*! @brief The frame slots, LANES_CNT values each */
+	int64_t *frame;
+
+	/*! @brief The constants broadcast to all the lanes, LANES_CNT values each */
+	int64_t *constants;
+
+	/*! @brief The state of each lane */
+	struct lane lane[LANES_CNT];
+
+	/*! @brief The number of lanes executing an input record, the others repeat the first one */
+	size_t active;
+
+	/*! @brief The input buffer */
+	char *buffer;
+
+	/*! @brief The index of the next character of the input buffer */
+	size_t buffer_pos;
+
+	/*! @brief The number of characters of the input buffer */
+	size_t buffer_len;
+
+	/*! @brief The characters of the value being read */
+	char *token;
+
+	/*! @brief The capacity of the characters of the value */
+	size_t token_capacity;
+
+	/*! @brief The number of executed input records */
+	uint64_t records;
+
+	/*! @brief The number of executed groups of records */
+	uint64_t groups;
+
+	/*! @brief The number of groups whose lanes diverged */
+	uint64_t diverged;
+};
+
+/**
+ * @brief Initialize a multi-lane executor
+ * @param vm A pointer to the executor to initialize
+ * @param bc A pointer to the bytecode to execute
+ */
+void lanes_init(struct lanes *vm, const struct bytecode *bc);
+
+/**
+ * @brief Clear a multi-lane executor
+ * @param vm A pointer to the executor to clear
+ */
+void lanes_clear(struct lanes *vm);
+
+/**
+ * @brief Execute the bytecode once per input record
+ *
+ * Each line of the input is a record, whose whitespace separated values are read in order and parsed
+ * as the values of the interpreter. A read past the last value fails the record with the end of the input,
+ * and a read of a malformed or out of range value fails it with an invalid input. The values written by a record
+ * are written on one line separated by spaces, in the order of the records, and a failed record is reported
+ * with its number, its runtime error and its line after the values it has written
+ * @param vm A pointer to the executor
+ * @param lines The line table of the bytecode
+ * @param in The input file
+ * @param out The output file
+ * @param err The output of the runtime errors
+ * @return The exit status of the interpreter for the runtime error of the first failed record, 0 if none has failed
+ */
+int lanes_execute(struct lanes *vm, struct line_table lines, FILE *in, FILE *out, FILE *err);
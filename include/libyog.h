@@ -0,0 +1,123 @@
+
+/*! @file libyog.h */
+
+#pragma once
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! @brief The outcomes of the compilation and of the execution of a program */
+enum yog_status
+{
+	YOG_OK,
+	YOG_COMPILE_ERROR,
+	YOG_DIVISION_BY_ZERO,
+	YOG_FUEL_EXHAUSTED,
+	YOG_DEADLINE_EXCEEDED,
+	YOG_END_OF_INPUT,
+	YOG_INVALID_INPUT
+};
+
+/**
+ * @brief The callback of the read statements
+ * @param data The data of the callbacks
+ * @param name The identifier of the read variable
+ * @param value A pointer to the value of the variable, unchanged if there is no value to read
+ * @return true if a value has been read, false otherwise, which stops the run with YOG_END_OF_INPUT
+ */
+typedef bool (*yog_read_callback)(void *data, const char *name, int64_t *value);
+
+/**
+ * @brief The callback of the write statements
+ * @param data The data of the callbacks
+ * @param value The written value
+ */
+typedef void (*yog_write_callback)(void *data, int64_t value);
+
+/*! @brief A compiled program, immutable and shared by any number of contexts, also among threads */
+struct yog_program;
+
+/*! @brief An execution context of a program, which can run it many times but only on one thread at a time */
+struct yog_context;
+
+/**
+ * @brief Compile a program from a buffer
+ * @param source The source code
+ * @param size The number of characters of the source code
+ * @param errors The file the compilation errors are printed to, NULL to discard them
+ * @param program A pointer to the compiled program, set to NULL if the program has errors
+ * @return YOG_OK if the program has been compiled, YOG_COMPILE_ERROR otherwise
+ */
+enum yog_status yog_compile(const char *source, size_t size, FILE *errors, struct yog_program **program);
+
+/**
+ * @brief Free a compiled program, after all its contexts
+ * @param program A pointer to the program to free, may be NULL
+ */
+void yog_program_free(struct yog_program *program);
+
+/**
+ * @brief Create an execution context of a program
+ *
+ * Without callbacks the read statements read from the standard input and the write statements
+ * write to the standard output
+ * @param program A pointer to the program to execute
+ * @return A pointer to the new context
+ */
+struct yog_context *yog_context_new(const struct yog_program *program);
+
+/**
+ * @brief Free an execution context
+ * @param ctx A pointer to the context to free, may be NULL
+ */
+void yog_context_free(struct yog_context *ctx);
+
+/**
+ * @brief Set the callbacks of the read and of the write statements of a context
+ * @param ctx A pointer to the context
+ * @param read The callback of the read statements
+ * @param write The callback of the write statements
+ * @param data The data passed to the callbacks
+ */
+void yog_context_set_callbacks(struct yog_context *ctx, yog_read_callback read, yog_write_callback write, void *data);
+
+/**
+ * @brief Limit each run of a context
+ *
+ * The instructions are charged at the jumps, so a run may retire a block of instructions more than its fuel
+ * @param ctx A pointer to the context
+ * @param fuel The number of instructions a run may retire, UINT64_MAX if unlimited
+ * @param seconds The wall-clock time a run may take, zero if unlimited
+ */
+void yog_context_set_limits(struct yog_context *ctx, uint64_t fuel, double seconds);
+
+/**
+ * @brief Run the program of a context from the beginning, with all the variables set to zero
+ * @param ctx A pointer to the context
+ * @return YOG_OK if the program has been executed to the end, otherwise the limit reached or the runtime error
+ */
+enum yog_status yog_run(struct yog_context *ctx);
+
+/**
+ * @brief Get the source line where the last run of a context stopped
+ * @param ctx A pointer to the context
+ * @return The line of the statement where the run stopped, zero if the run has been executed to the end
+ */
+size_t yog_context_line(const struct yog_context *ctx);
+
+/**
+ * @brief Translate a status to a string
+ * @param status The status to translate
+ * @return A constant string that describes the status, e.g. "division by zero"
+ */
+const char *yog_status_str(enum yog_status status);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,63 @@
+
+/*! @file linetable.h */
+
+#pragma once
+
+#include "location.h"
+#include "common.h"
+
+/*! @brief An entry of the line table */
+struct line_entry
+{
+	/*! @brief The index of the first instruction emitted for the source location */
+	size_t pc;
+
+	/*! @brief The source location of the instructions */
+	struct location loc;
+};
+
+/**
+ * @brief The line table maps the instructions to the locations of the statements that emitted them
+ *
+ * An entry is added only when the location changes, so an instruction belongs to the last entry
+ * whose index is not greater than its own
+ */
+struct line_table
+{
+	/*! @brief The entries sorted by instruction index */
+	struct line_entry *entries;
+
+	/*! @brief The number of entries */
+	size_t size;
+
+	/*! @brief The capacity of the table */
+	size_t capacity;
+};
+
+/**
+ * @brief Initialize a line table
+ * @param lt A pointer to the line table to initialize
+ */
+void line_table_init(struct line_table *lt);
+
+/**
+ * @brief Clear a line table
+ * @param lt A pointer to the line table to clear
+ */
+void line_table_clear(struct line_table *lt);
+
+/**
+ * @brief Map the instructions from an index onwards to a source location
+ * @param lt A pointer to the line table
+ * @param pc The index of the first instruction at the location
+ * @param loc The source location
+ */
+void line_table_add(struct line_table *lt, size_t pc, struct location loc);
+
+/**
+ * @brief Find the source location of an instruction
+ * @param lt The line table
+ * @param pc The index of the instruction
+ * @return The source location of the instruction, row 0 if unknown
+ */
+struct location line_table_find(struct line_table lt, size_t pc);
@@ -0,0 +1,185 @@
+
+/*! @file memo.h */
+
+#pragma once
+
+#include "interpreter.h"
+
+/*! @brief The version of the memo file format, increased at each incompatible change */
+#define MEMO_VERSION 2
+
+/*! @brief The default number of bytes of the stored outcomes */
+#define MEMO_CAPACITY (64 * 1024 * 1024)
+
+/*! @brief The key of an execution, its program, its fuel and its input, which are compared on a match of their hash */
+struct memo_key
+{
+	/*! @brief The hash of the other fields */
+	uint64_t hash;
+
+	/*! @brief The hash of the bytecode of the program */
+	uint64_t program;
+
+	/*! @brief The number of instructions the execution may retire, UINT64_MAX if unlimited */
+	uint64_t fuel;
+
+	/*! @brief How the input ends after its values, INPUT_END or INPUT_INVALID */
+	enum input_result end;
+
+	/*! @brief The values of the input, copied by the memo when the outcome is stored */
+	const int64_t *values;
+
+	/*! @brief The number of values of the input */
+	size_t cnt;
+};
+
+/*! @brief The outcome of an execution */
+struct memo_result
+{
+	/*! @brief The outcome of the execution */
+	enum interpreter_status status;
+
+	/*! @brief The program counter where the execution stopped */
+	size_t pc;
+
+	/*! @brief The number of instructions retired by the execution */
+	uint64_t retired;
+
+	/*! @brief The written values */
+	int64_t *output;
+
+	/*! @brief The number of written values */
+	size_t output_cnt;
+};
+
+struct memo_entry;
+
+/**
+ * @brief The memo keeps the outcomes of the executions keyed by their program and their input values
+ *
+ * A program only reads its input, computes and writes, so its outcome is a function of the values of its input and of its fuel:
+ * an execution whose key is in the memo writes the stored values and stops where the stored execution stopped, without
+ * being executed. The input values are stored with each outcome and compared in full on a match of the hash, so
+ * a collision never replays the outcome of another input. The memo is bounded by the bytes of its outcomes and inputs, the least recently used ones are evicted first,
+ * and it can be saved to a file and loaded back
+ */
+struct memo
+{
+	/*! @brief The maximum number of bytes of the stored outcomes and of their inputs */
+	size_t capacity;
+
+	/*! @brief The number of bytes of the stored outcomes and of their inputs */
+	size_t size;
+
+	/*! @brief The number of executions found in the memo */
+	uint64_t hits;
+
+	/*! @brief The number of executions not found in the memo */
+	uint64_t misses;
+
+	/*! @brief The number of outcomes evicted to bound the memo */
+	uint64_t evictions;
+
+	/*! @brief Set if outcomes have been stored since the memo was loaded */
+	bool modified;
+
+	/*! @brief The buckets of the hash table of the outcomes */
+	struct memo_entry **buckets;
+
+	/*! @brief The number of buckets, a power of two */
+	size_t buckets_cnt;
+
+	/*! @brief The number of stored outcomes */
+	size_t entries_cnt;
+
+	/*! @brief The most recently used outcome, NULL if none */
+	struct memo_entry *first;
+
+	/*! @brief The least recently used outcome, NULL if none */
+	struct memo_entry *last;
+};
+
+/**
+ * @brief Initialize an empty memo
+ * @param m A pointer to the memo to initialize
+ * @param capacity The maximum number of bytes of the stored outcomes and of their inputs
+ */
+void memo_init(struct memo *m, size_t capacity);
+
+/**
+ * @brief Compute the key of an execution, which refers to its input values
+ * @param program The hash of the bytecode of the program
+ * @param fuel The number of instructions the execution may retire, UINT64_MAX if unlimited
+ * @param values The values of the input
+ * @param cnt The number of values of the input
+ * @param end How the input ends after its values, INPUT_END or INPUT_INVALID
+ * @return The key of the execution
+ */
+struct memo_key memo_key(uint64_t program, uint64_t fuel, const int64_t *values, size_t cnt, enum input_result end);
+
+/**
+ * @brief Find the outcome of an execution, which becomes the most recently used one
+ * @param m A pointer to the memo
+ * @param key The key of the execution
+ * @return A pointer to the outcome, valid until the next store, NULL if not found
+ */
+const struct memo_result *memo_find(struct memo *m, struct memo_key key);
+
+/**
+ * @brief Store a copy of the outcome of an execution, evicting the least recently used outcomes while the memo is full
+ * @param m A pointer to the memo
+ * @param key The key of the execution
+ * @param result A pointer to the outcome, which is not stored if larger than the memo with its input
+ */
+void memo_store(struct memo *m, struct memo_key key, const struct memo_result *result);
+
+/**
+ * @brief Check if a bytecode has read statements, whose memoized executions read their whole input before them
+ * @param bc A pointer to the bytecode
+ * @return true if the bytecode reads values, false otherwise
+ */
+bool memo_reads(const struct bytecode *bc);
+
+/**
+ * @brief Execute the bytecode of an interpreter over its whole input, unless the outcome is in the memo
+ *
+ * The input is read to its end before the execution, which is then executed over its values, or replaced by the stored outcome.
+ * A bytecode without read statements is keyed without its input, which is not read.
+ * The written values are written to the output of the interpreter in both cases, and the status, the program counter
+ * and the retired instructions of the interpreter are those of the execution
+ * @param m A pointer to the memo
+ * @param vm A pointer to the interpreter, which has not been executed, without deadline and without callbacks
+ * @param program The hash of the bytecode of the interpreter
+ * @return The outcome of the execution
+ */
+enum interpreter_status memo_execute(struct memo *m, struct interpreter *vm, uint64_t program);
+
+/**
+ * @brief Get the path of the memo file of a program in the cache directory of the precompiled bytecodes
+ * @param path The buffer of the path, of YOGC_PATH_SIZE characters
+ * @param program The hash of the bytecode of the program
+ * @return true if the cache is available, false otherwise
+ */
+bool memo_cache_path(char *path, uint64_t program);
+
+/**
+ * @brief Load the outcomes of a memo file, keeping their order of use
+ * @param m A pointer to the memo
+ * @param filename The name of the memo file
+ * @return true if loaded, false if the file does not exist or it is not a memo file of this version
+ */
+bool memo_load(struct memo *m, const char *filename);
+
+/**
+ * @brief Save the outcomes of a memo to a file, replacing it at once
+ * @param m A pointer to the memo
+ * @param filename The name of the memo file
+ * @return true if saved, false otherwise
+ */
+bool memo_save(struct memo *m, const char *filename);
+
+/**
+ * @brief Clear a memo
+ * @param m A pointer to the memo to clear
+ */
+void memo_clear(struct memo *m);
@@ -0,0 +1,71 @@
+
+/*! @file offload.h */
+
+#pragma once
+
+#include "interpreter.h"
+
+/*! @brief The number of values of each ring, a power of two */
+#define OFFLOAD_RING_SIZE 4096
+
+struct offload_state;
+
+/**
+ * @brief The offload moves the input and the output of an interpreter to their own threads
+ *
+ * A reader thread parses the values of the input ahead of the execution into a ring, which the reads drain,
+ * and a writer thread formats and writes the values the writes put into a second ring. Each ring has a single
+ * producer and a single consumer, which synchronize with the atomic indices of the ring only: the consumer waits
+ * while the ring is empty and the producer while it is full, so a slow output holds the execution back.
+ * The reader parses ahead, so the values of the input after the last read are consumed
+ */
+struct offload
+{
+	/*! @brief The interpreter whose input and output are offloaded */
+	struct interpreter *vm;
+
+	/*! @brief The rings and the threads */
+	struct offload_state *state;
+
+	/*! @brief The number of reads which waited for the reader thread */
+	uint64_t read_stalls;
+
+	/*! @brief The number of writes which waited for the writer thread */
+	uint64_t write_stalls;
+};
+
+/**
+ * @brief Check if the threads of the offload are supported on this platform
+ * @return true if supported, false otherwise
+ */
+bool offload_supported(void);
+
+/**
+ * @brief Start the threads of the input and of the output of an interpreter, which are read
+ * and written in the formats and with the output buffer of the interpreter, without prompting,
+ * if the threads cannot be started the interpreter reads and writes its streams itself
+ * @param off A pointer to the offload to start
+ * @param vm A pointer to the interpreter, whose reads and writes go through the offload until it is stopped
+ */
+void offload_start(struct offload *off, struct interpreter *vm);
+
+/**
+ * @brief Take the next value parsed by the reader thread, waiting for it if none
+ * @param off A pointer to the started offload
+ * @param value A pointer to the value, unchanged if no value has been read
+ * @return INPUT_VALUE if a value has been read, otherwise how the input ended
+ */
+enum input_result offload_read(struct offload *off, int64_t *value);
+
+/**
+ * @brief Pass a value to the writer thread, waiting while its ring is full
+ * @param off A pointer to the started offload
+ * @param value The value
+ */
+void offload_write(struct offload *off, int64_t value);
+
+/**
+ * @brief Stop the threads of an offload, once the writer thread has written all the values
+ * @param off A pointer to the offload to stop
+ */
+void offload_stop(struct offload *off);
@@ -0,0 +1,109 @@
+
+/*! @file opcode.h */
+
+#pragma once
+
+#include "common.h"
+
+/**
+ * @brief The binary operations that cannot fail, as (name, C operator) pairs
+ *
+ * The division is not listed because it has to check for a division by zero
+ */
+#define OPCODE_BINARY_OPERATIONS(X) \
+	X(ADD, +)  \
+	X(SUB, -)  \
+	X(MUL, *)  \
+	X(EQ,  ==) \
+	X(NEQ, !=) \
+	X(LT,  <)  \
+	X(LTE, <=) \
+	X(GT,  >)  \
+	X(GTE, >=)
+
+/*! @brief The compare-and-branch operations, as (name, C operator) pairs */
+#define OPCODE_BRANCH_OPERATIONS(X) \
+	X(BEQ,  ==) \
+	X(BNEQ, !=) \
+	X(BLT,  <)  \
+	X(BLTE, <=) \
+	X(BGT,  >)  \
+	X(BGTE, >=)
+
+/*! @brief The unary operations, as (name, C operator) pairs */
+#define OPCODE_UNARY_OPERATIONS(X) \
+	X(PLS, +) \
+	X(NEG, -)
+
+/**
+ * @brief Expand X for each kind of the source operand of an operation
+ *
+ * The kinds are V for a variable or a temporary, both stored in the frame, and L for a literal
+ */
+#define OPCODE_KINDS_1(X, ...) \
+	X(__VA_ARGS__, V) X(__VA_ARGS__, L)
+
+/*! @brief Expand X for each pair of kinds of the source operands of an operation */
+#define OPCODE_KINDS_2(X, ...) \
+	X(__VA_ARGS__, V, V) X(__VA_ARGS__, V, L) \
+	X(__VA_ARGS__, L, V) X(__VA_ARGS__, L, L)
+
+/**
+ * @brief The list of all the specialized operations
+ * @param X0 Expanded as X0(name) for the operations without variants
+ * @param X1 Expanded as X1(name, k) for the operations with one source operand
+ * @param X2 Expanded as X2(name, k1, k2) for the operations with two source operands
+ */
+#define OPCODE_LIST(X0, X1, X2) \
+	OPCODE_KINDS_1(X1, ASSIGN) \
+	X0(READ) \
+	OPCODE_KINDS_1(X1, WRITE) \
+	OPCODE_KINDS_2(X2, ADD) \
+	OPCODE_KINDS_2(X2, SUB) \
+	OPCODE_KINDS_2(X2, MUL) \
+	OPCODE_KINDS_2(X2, DIV) \
+	OPCODE_KINDS_1(X1, PLS) \
+	OPCODE_KINDS_1(X1, NEG) \
+	OPCODE_KINDS_2(X2, EQ) \
+	OPCODE_KINDS_2(X2, NEQ) \
+	OPCODE_KINDS_2(X2, LT) \
+	OPCODE_KINDS_2(X2, LTE) \
+	OPCODE_KINDS_2(X2, GT) \
+	OPCODE_KINDS_2(X2, GTE) \
+	X0(GOTO) \
+	X0(BRANCH) \
+	OPCODE_KINDS_2(X2, BEQ) \
+	OPCODE_KINDS_2(X2, BNEQ) \
+	OPCODE_KINDS_2(X2, BLT) \
+	OPCODE_KINDS_2(X2, BLTE) \
+	OPCODE_KINDS_2(X2, BGT) \
+	OPCODE_KINDS_2(X2, BGTE)
+
+#define OPCODE_ENUM_0(name) OPCODE_##name,
+#define OPCODE_ENUM_1(name, k) OPCODE_##name##_##k,
+#define OPCODE_ENUM_2(name, k1, k2) OPCODE_##name##_##k1##k2,
+
+/*! @brief The operations of the instructions specialized for the kinds of their operands */
+enum opcode
+{
+	OPCODE_LIST(OPCODE_ENUM_0, OPCODE_ENUM_1, OPCODE_ENUM_2)
+	OPCODE_HALT
+};
+
+#undef OPCODE_ENUM_0
+#undef OPCODE_ENUM_1
+#undef OPCODE_ENUM_2
+
+/**
+ * @brief Translate a specialized operation to a string
+ * @param op The specialized operation to translate
+ * @return A constant string that rappresents the operation, e.g. "ADD_VL"
+ */
+const char *opcode_str(enum opcode op);
+
+/**
+ * @brief Check if a specialized operation may transfer the control to another instruction than the next
+ * @param op The specialized operation to check
+ * @return true if the operation is a jump, false otherwise
+ */
+bool opcode_is_jump(enum opcode op);
@@ -0,0 +1,126 @@
+
+/*! @file output.h */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "common.h"
+
+/*! @brief The default size of the output buffer in bytes */
+#define OUTPUT_BUFFER_SIZE 65536
+
+/*! @brief The minimum size of the output buffer, which holds at least a formatted value */
+#define OUTPUT_BUFFER_MIN 64
+
+/**
+ * @brief The buffered output of the write statements
+ *
+ * The values are formatted into a user-space buffer, which is written to the file descriptor of the output
+ * in large chunks, bypassing the locking and the format parsing of the standard streams. The streams without
+ * a file descriptor, as the memory streams, receive the chunks with fwrite
+ */
+struct output
+{
+	/*! @brief The bound output stream, NULL if not bound */
+	FILE *file;
+
+	/*! @brief The file descriptor of the output stream, negative if written with fwrite */
+	int fd;
+
+	/*! @brief The input stream whose reads flush the buffer, NULL if none */
+	FILE *input;
+
+	/*! @brief Set if the reads from the input may block, which flush the buffer before */
+	bool flush_on_read;
+
+	/*! @brief Set if each value is written as soon as it is formatted */
+	bool flush_lines;
+
+	/*! @brief Set if the output is line buffered even if it is not a terminal */
+	bool line_buffered;
+
+	/*! @brief Set if the values are written as the 8 bytes of little-endian integers instead of decimal lines */
+	bool binary;
+
+	/*! @brief The buffer, allocated at the first binding */
+	char *buffer;
+
+	/*! @brief The number of buffered bytes */
+	size_t size;
+
+	/*! @brief The size of the buffer */
+	size_t capacity;
+};
+
+/**
+ * @brief Initialize an unbound output
+ * @param out A pointer to the output to initialize
+ */
+void output_init(struct output *out);
+
+/**
+ * @brief Set the size of the buffer of an output and its line buffering, flushing it
+ * @param out A pointer to the output
+ * @param capacity The size of the buffer in bytes, at least OUTPUT_BUFFER_MIN
+ * @param line_buffered Set if the output is line buffered even if it is not a terminal
+ */
+void output_configure(struct output *out, size_t capacity, bool line_buffered);
+
+/**
+ * @brief Bind an output to a stream, flushing the buffer to the previous one, if the streams change
+ *
+ * The output is line buffered if its stream is a terminal, and the buffer is flushed
+ * before the reads from an input that is a terminal
+ * @param out A pointer to the output
+ * @param file The output stream
+ * @param input The input stream of the reads, NULL if none
+ */
+void output_bind(struct output *out, FILE *file, FILE *input);
+
+/**
+ * @brief Unbind an output from its stream, flushing the buffer
+ * @param out A pointer to the output
+ */
+void output_unbind(struct output *out);
+
+/**
+ * @brief Write a value followed by a new line, or its 8 bytes in a binary output
+ * @param out A pointer to the bound output
+ * @param value The value
+ */
+void output_int(struct output *out, int64_t value);
+
+/**
+ * @brief Write a string
+ * @param out A pointer to the bound output
+ * @param str The string
+ */
+void output_str(struct output *out, const char *str);
+
+/**
+ * @brief Write the buffered bytes to the stream
+ * @param out A pointer to the output
+ */
+void output_flush(struct output *out);
+
+/**
+ * @brief Get the position of the stream of an output, flushing it
+ * @param out A pointer to the bound output
+ * @return The position of the stream, negative if the stream cannot be positioned
+ */
+int64_t output_tell(struct output *out);
+
+/**
+ * @brief Clear an output, flushing it
+ * @param out A pointer to the output to clear
+ */
+void output_clear(struct output *out);
+
+/**
+ * @brief Format a value in decimal, ending at the end of a buffer
+ * @param end A pointer past the end of a buffer of at least 20 characters
+ * @param value The value
+ * @return The number of characters, which precede end
+ */
+size_t output_format(char *end, int64_t value);
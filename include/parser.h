@@ -28,6 +28,16 @@ struct parse_context
  */
 void parse_context_init(struct parse_context *ctx, FILE *source, struct symbol_table *st, struct error_list *errs);
 
+/**
+ * @brief Initialize a parse context reading the source code from a buffer
+ * @param ctx A pointer to the parse context to initialize
+ * @param buffer The source code buffer
+ * @param size The number of characters of the source code buffer
+ * @param st A pointer to the symbol table
+ * @param errs A pointer to the error list
+ */
+void parse_context_init_buffer(struct parse_context *ctx, const char *buffer, size_t size, struct symbol_table *st, struct error_list *errs);
+
 /**
  * @brief Parse the source code
  * 
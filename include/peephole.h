@@ -0,0 +1,56 @@
+
+/*! @file peephole.h */
+
+#pragma once
+
+#include "instruction.h"
+#include "superinstructions.h"
+
+#define SUPERINSTRUCTION_ENUM_2(a, b) SUPERINSTRUCTION_##a##__##b,
+#define SUPERINSTRUCTION_ENUM_3(a, b, c) SUPERINSTRUCTION_##a##__##b##__##c,
+
+/*! @brief The superinstructions, i.e. the sequences of operations executed with a single dispatch */
+enum superinstruction
+{
+	SUPERINSTRUCTION_NONE,
+	SUPERINSTRUCTION_PAIRS(SUPERINSTRUCTION_ENUM_2)
+	SUPERINSTRUCTION_TRIPLES(SUPERINSTRUCTION_ENUM_3)
+	SUPERINSTRUCTION_CNT
+};
+
+#undef SUPERINSTRUCTION_ENUM_2
+#undef SUPERINSTRUCTION_ENUM_3
+
+/**
+ * @brief Mark the instructions starting a sequence of operations that has a superinstruction
+ *
+ * The instructions of the sequence are left in place, so the jumps into the sequence still work
+ * @param instrs The specialized instruction list to rewrite
+ */
+void combine_superinstructions(struct instruction_list instrs);
+
+/**
+ * @brief Get the number of operations executed by a superinstruction
+ * @param super The superinstruction
+ * @return The number of operations, one for SUPERINSTRUCTION_NONE
+ */
+size_t superinstruction_length(enum superinstruction super);
+
+/**
+ * @brief Get an operation executed by a superinstruction
+ * @param super The superinstruction, not SUPERINSTRUCTION_NONE
+ * @param k The index of the operation, less than the length of the superinstruction
+ * @return The operation executed at the given index
+ */
+enum opcode superinstruction_operation(enum superinstruction super, size_t k);
+
+/**
+ * @brief Write the profile of the sequences of operations executed by a program
+ *
+ * Each line of the profile holds the execution count of a sequence of two or three
+ * operations that falls through, followed by the operations of the sequence
+ * @param out The file where to append the profile
+ * @param instrs The specialized instruction list of the program
+ * @param counts The execution count of each instruction
+ */
+void write_sequence_profile(FILE *out, struct instruction_list instrs, const uint64_t *counts);
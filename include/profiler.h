@@ -0,0 +1,39 @@
+
+/*! @file profiler.h */
+
+#pragma once
+
+#include "bytecode.h"
+#include "linetable.h"
+
+/*! @brief The maximum number of source lines and loops listed by a profile report */
+#define PROFILE_REPORT_SIZE 10
+
+/**
+ * @brief Report the hottest source lines and loops of a profiled execution, sorted by cost
+ *
+ * The loops are the regions closed by a jump to a previous instruction
+ * @param out The output file
+ * @param bc A pointer to the executed bytecode
+ * @param lines The line table of the bytecode instructions
+ * @param costs The cost of each instruction, e.g. its cycles
+ * @param unit The unit of the costs
+ * @param counts The execution count of each instruction, NULL if not counted
+ * @param filename The name of the source file, whose lines are quoted if it can be read
+ */
+void profile_report(FILE *out, const struct bytecode *bc, struct line_table lines,
+	const uint64_t *costs, const char *unit, const uint64_t *counts, const char *filename);
+
+/**
+ * @brief Write the costs of the instructions as folded stacks, one line per stack followed by its cost
+ *
+ * The frames of a stack are the name of the program, the loops enclosing the instructions
+ * from the outermost one, and their source line, e.g. "sum.yog;loop:9;line:11 42",
+ * as read by the flame graph tools
+ * @param out The output file
+ * @param bc A pointer to the executed bytecode
+ * @param lines The line table of the bytecode instructions
+ * @param costs The cost of each instruction
+ * @param name The name of the program
+ */
+void profile_write_folded(FILE *out, const struct bytecode *bc, struct line_table lines, const uint64_t *costs, const char *name);
@@ -0,0 +1,18 @@
+
+/*! @file regalloc.h */
+
+#pragma once
+
+#include "instruction.h"
+
+/**
+ * @brief Allocate the temporary variables to a small register file
+ *
+ * A temporary variable is live from its definition to its last use, the registers
+ * of the dead temporaries are reused by the following definitions. A temporary whose
+ * live range is entered by a jump keeps a register of its own
+ * @param instrs The instruction list whose temporaries are renamed to registers
+ * @param tmp_cnt The number of temporary variables
+ * @return The number of registers
+ */
+size_t allocate_temporaries(struct instruction_list instrs, size_t tmp_cnt);
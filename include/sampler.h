@@ -0,0 +1,50 @@
+
+/*! @file sampler.h */
+
+#pragma once
+
+#include "interpreter.h"
+
+/**
+ * @brief The sampling profiler counts the instructions interrupted by a profiling timer
+ *
+ * The timer signal interrupts the interpreter, which records the next instruction it executes,
+ * so the execution is not instrumented beyond a check of the interrupt before each instruction
+ */
+struct sampler
+{
+	/*! @brief The samples of each instruction, the last one counts the samples after the halt */
+	uint64_t *samples;
+
+	/*! @brief The number of instructions */
+	size_t size;
+
+	/*! @brief The sampling frequency in Hz */
+	unsigned hz;
+};
+
+/**
+ * @brief Check if the sampling profiler is supported on this platform (POSIX profiling timer)
+ * @return true if the sampling profiler is supported, false otherwise
+ */
+bool sampler_supported(void);
+
+/**
+ * @brief Start sampling the execution of an interpreter, only one sampler can be active
+ * @param sampler A pointer to the sampler to initialize
+ * @param vm A pointer to the interpreter to sample, its interrupt handler is replaced
+ * @param hz The sampling frequency in Hz of consumed CPU time
+ */
+void sampler_start(struct sampler *sampler, struct interpreter *vm, unsigned hz);
+
+/**
+ * @brief Stop sampling, the samples are kept
+ * @param sampler A pointer to the active sampler
+ */
+void sampler_stop(struct sampler *sampler);
+
+/**
+ * @brief Clear the samples of a sampler
+ * @param sampler A pointer to the sampler to clear
+ */
+void sampler_clear(struct sampler *sampler);
@@ -9,9 +9,18 @@
 /*! @brief The lexical context data structure */
 struct lex_context
 {
-	/*! @brief The source code file */
+	/*! @brief The source code file, NULL if the source code is read from a buffer */
 	FILE* source;
 
+	/*! @brief The source code buffer */
+	const char *buffer;
+
+	/*! @brief The number of characters of the source code buffer */
+	size_t buffer_size;
+
+	/*! @brief The index of the next character of the source code buffer */
+	size_t buffer_pos;
+
 	/*! @brief The lookahead character */
 	char lookahead;
 
@@ -34,6 +43,16 @@ struct lex_context
  */
 void lex_context_init(struct lex_context *ctx, FILE *source, struct symbol_table *st, struct error_list *errs);
 
+/**
+ * @brief Initialize a lexical context reading the source code from a buffer
+ * @param ctx A pointer to the lexical context to initialize
+ * @param buffer The source code buffer
+ * @param size The number of characters of the source code buffer
+ * @param st A pointer to the symbol table
+ * @param errs A pointer to the error list
+ */
+void lex_context_init_buffer(struct lex_context *ctx, const char *buffer, size_t size, struct symbol_table *st, struct error_list *errs);
+
 /**
  * @brief Get the next token from the token stream
  * @param ctx A pointer to the lexical context
@@ -0,0 +1,134 @@
+
+/*! @file scheduler.h */
+
+#pragma once
+
+#include "batch.h"
+
+/*! @brief The size of the input and of the output buffers of a session in bytes, small enough for thousands of sessions */
+#define SCHEDULER_BUFFER_SIZE 4096
+
+/*! @brief The maximum number of readiness events collected at once */
+#define SCHEDULER_EVENTS_CNT 64
+
+struct scheduler_state;
+
+/**
+ * @brief The scheduler multiplexes many sessions of one compiled program on a pool of workers
+ *
+ * A session is an execution of the program with its own interpreter over its own input and output streams.
+ * Its input is non-blocking, so a read without a value suspends the session where it stopped instead
+ * of blocking the worker, and the input is registered for the readiness events of the scheduler.
+ * The workers execute the ready sessions from their run queues, steal the sessions of the others once
+ * theirs are empty and wait for the readiness events when none is ready, so a worker keeps any number
+ * of waiting sessions. A quantum makes a session yield to the others after that many instructions
+ */
+struct scheduler
+{
+	/*! @brief The bytecode executed by the added sessions */
+	const struct bytecode *bc;
+
+	/*! @brief The instruction dispatch technique of the interpreters */
+	enum interpreter_dispatch dispatch;
+
+	/*! @brief The number of instructions each added session may retire, UINT64_MAX if unlimited */
+	uint64_t fuel;
+
+	/*! @brief The number of instructions a session executes before it yields to the others, UINT64_MAX if it runs until it waits */
+	uint64_t quantum;
+
+	/*! @brief The number of workers */
+	size_t workers_cnt;
+
+	/*! @brief Set if the inputs of the added sessions hold raw little-endian integers */
+	bool binary_input;
+
+	/*! @brief Set if the added sessions write their values as raw little-endian integers */
+	bool binary_output;
+
+	/*! @brief The callback of the completed sessions, called on the worker with the data and the interpreter of the session, whose streams it may close */
+	void (*completed)(void *data, struct interpreter *vm);
+
+	/*! @brief The number of times the sessions have been suspended waiting for their input, updated when the scheduler is stopped */
+	uint64_t suspensions;
+
+	/*! @brief The number of sessions stolen from another worker, updated when the scheduler is stopped */
+	uint64_t steals;
+
+	/*! @brief The run queues, the readiness events and the workers */
+	struct scheduler_state *state;
+};
+
+/**
+ * @brief Check if the scheduler multiplexes the sessions on this platform (epoll and POSIX threads)
+ * @return true if the sessions are multiplexed, false if each session is executed to its end when it is added
+ */
+bool scheduler_supported(void);
+
+/**
+ * @brief Initialize a scheduler
+ * @param s A pointer to the scheduler to initialize
+ * @param bc A pointer to the bytecode to execute
+ * @param dispatch The instruction dispatch technique of the interpreters
+ * @param workers_cnt The number of workers
+ */
+void scheduler_init(struct scheduler *s, const struct bytecode *bc, enum interpreter_dispatch dispatch, size_t workers_cnt);
+
+/**
+ * @brief Start the workers of a scheduler
+ * @param s A pointer to the initialized scheduler
+ */
+void scheduler_start(struct scheduler *s);
+
+/**
+ * @brief Add a session of the bytecode of the scheduler, with its fuel and its formats, from any thread
+ *
+ * The input is made non-blocking until the session is completed and must not be shared with another session
+ * @param s A pointer to the started scheduler
+ * @param in The input stream of the session
+ * @param out The output stream of the session
+ * @param data The data passed to the completion callback
+ */
+void scheduler_add(struct scheduler *s, FILE *in, FILE *out, void *data);
+
+/**
+ * @brief Add a session of its own bytecode, which is executed from the beginning of the program, from any thread
+ * @param s A pointer to the started scheduler
+ * @param bc A pointer to the bytecode of the session, which must outlive it
+ * @param fuel The number of instructions the session may retire, UINT64_MAX if unlimited
+ * @param binary_input Set if the input holds raw little-endian integers
+ * @param binary_output Set if the values are written as raw little-endian integers
+ * @param in The input stream of the session
+ * @param out The output stream of the session
+ * @param data The data passed to the completion callback
+ */
+void scheduler_submit(struct scheduler *s, const struct bytecode *bc, uint64_t fuel, bool binary_input, bool binary_output,
+	FILE *in, FILE *out, void *data);
+
+/**
+ * @brief Wait until all the sessions added to a scheduler have completed
+ * @param s A pointer to the started scheduler
+ */
+void scheduler_wait(struct scheduler *s);
+
+/**
+ * @brief Stop the workers of a scheduler after their current sessions, completing the sessions which have not ended
+ * where they stopped, with INTERPRETER_NEEDS_INPUT if they wait for their input and INTERPRETER_DEADLINE_EXCEEDED
+ * otherwise, e.g. if they have not been executed yet
+ * @param s A pointer to the started scheduler
+ */
+void scheduler_stop(struct scheduler *s);
+
+/**
+ * @brief Execute the bytecode once for each input file, FIFO or character device, multiplexing the sessions
+ *
+ * The inputs are opened without waiting for their writers, the values written by each session are
+ * written to out in the order of the inputs and the failures are reported on err as batch_execute does
+ * @param s A pointer to the initialized scheduler, which is started and stopped
+ * @param filenames The names of the inputs
+ * @param cnt The number of inputs
+ * @param out The output of the sessions
+ * @param err The output of the failures
+ * @return 0 if all the sessions halted, otherwise the status of the first failed session as returned by batch_execute
+ */
+int scheduler_execute(struct scheduler *s, const char **filenames, size_t cnt, FILE *out, FILE *err);
@@ -6,6 +6,7 @@
 #include "ast.h"
 #include "error.h"
 #include "instruction.h"
+#include "linetable.h"
 
 /*! @brief The semantic context data structure */
 struct semantic_context
@@ -22,6 +23,12 @@ struct semantic_context
 	/*! @brief The instruction list of the current statement */
 	struct instruction_list instrs;
 
+	/*! @brief The source locations of the emitted instructions */
+	struct line_table lines;
+
+	/*! @brief The number of declared variables */
+	size_t vars_cnt;
+
 	/*! @brief The number of temporary variables */
 	size_t tmp_cnt;
 };
@@ -0,0 +1,108 @@
+
+/*! @file server.h */
+
+#pragma once
+
+#include "scheduler.h"
+
+/*! @brief The version of the protocol between the clients and the server, increased at each incompatible change */
+#define SERVER_VERSION 1
+
+/*! @brief The maximum number of compiled programs kept by the server */
+#define SERVER_CACHE_SIZE 64
+
+/*! @brief The maximum number of characters of a served program */
+#define SERVER_SOURCE_SIZE (16 * 1024 * 1024)
+
+/*! @brief The maximum number of characters of the message sent back with the exit status */
+#define SERVER_MESSAGE_SIZE 256
+
+/*! @brief The default number of instructions a request may retire, so a request which does not end does not hold its worker forever */
+#define SERVER_FUEL 10000000000ULL
+
+/*! @brief The default number of instructions a request executes before it yields to the others */
+#define SERVER_QUANTUM (1024 * 1024)
+
+/*! @brief The maximum number of requests received and compiled at once, each by its own thread */
+#define SERVER_RECEIVERS_CNT 64
+
+/*! @brief The seconds the server waits for a client to send its request */
+#define SERVER_REQUEST_TIMEOUT 5
+
+struct server_state;
+
+/**
+ * @brief The server executes the programs of its clients over a Unix domain socket, without starting a process per execution
+ *
+ * A client sends the source code of its program with its standard input and output, which are passed as file descriptors,
+ * so the values are read and written by the server without going through the socket. The compiled programs are kept
+ * in a cache keyed by the hash of their source code, so a program is compiled at its first request only. Each request is
+ * received and compiled by its own thread, so the server keeps accepting the connections meanwhile, and the
+ * requests are sessions of a scheduler, which suspends them while they wait for their input. The exit status and the
+ * message of the runtime error, if any, are sent back once the session is completed
+ */
+struct server
+{
+	/*! @brief The path of the socket */
+	const char *path;
+
+	/*! @brief The instruction dispatch technique of the interpreters */
+	enum interpreter_dispatch dispatch;
+
+	/*! @brief The number of workers */
+	size_t workers_cnt;
+
+	/*! @brief The number of instructions a request may retire, SERVER_FUEL by default, a request may lower it */
+	uint64_t fuel;
+
+	/*! @brief The number of instructions a request executes before it yields to the others, SERVER_QUANTUM by default */
+	uint64_t quantum;
+
+	/*! @brief The number of requests served */
+	uint64_t requests;
+
+	/*! @brief The number of programs compiled, i.e. the requests whose program was not in the cache */
+	uint64_t compilations;
+
+	/*! @brief The number of times the requests have been suspended waiting for their input */
+	uint64_t suspensions;
+
+	/*! @brief The socket, the cache and the scheduler */
+	struct server_state *state;
+};
+
+/**
+ * @brief Check if the server and its clients are supported on this platform (Unix domain sockets)
+ * @return true if supported, false otherwise
+ */
+bool server_supported(void);
+
+/**
+ * @brief Initialize a server
+ * @param srv A pointer to the server to initialize
+ * @param path The path of the socket
+ * @param dispatch The instruction dispatch technique of the interpreters, which cannot be native code
+ * @param workers_cnt The number of workers
+ */
+void server_init(struct server *srv, const char *path, enum interpreter_dispatch dispatch, size_t workers_cnt);
+
+/**
+ * @brief Serve the requests until SIGINT or SIGTERM, then complete the requests which have not ended
+ * as failed, after the quantum they are executing, and remove the socket
+ * @param srv A pointer to the initialized server
+ * @param err The output of the failures
+ * @return 0 if the server has been stopped, 2 if the socket cannot be created
+ */
+int server_serve(struct server *srv, FILE *err);
+
+/**
+ * @brief Execute a program on a server, which reads the standard input and writes the standard output of the caller
+ * @param path The path of the socket of the server
+ * @param filename The name of the source code of the program
+ * @param fuel The number of instructions the execution may retire, UINT64_MAX if unlimited
+ * @param binary_input Set if the input holds raw little-endian integers
+ * @param binary_output Set if the values are written as raw little-endian integers
+ * @param err The output of the failures and of the runtime errors
+ * @return The exit status of the execution, as yog returns it, or 2 if the program or the server cannot be reached
+ */
+int server_request(const char *path, const char *filename, uint64_t fuel, bool binary_input, bool binary_output, FILE *err);
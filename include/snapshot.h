@@ -0,0 +1,154 @@
+
+/*! @file snapshot.h */
+
+#pragma once
+
+#include "interpreter.h"
+
+/*! @brief The version of the snapshot format, increased at each incompatible change */
+#define SNAPSHOT_VERSION 2
+
+/*! @brief The maximum length of the name of the program of a snapshot */
+#define SNAPSHOT_PROGRAM_SIZE 4096
+
+/**
+ * @brief The snapshot of the state of an interpreter, which resumes its execution
+ *
+ * The native code and the compiled loops are not part of the state, the input and the output
+ * are restored at their positions when they are files, otherwise the input skips the read values
+ */
+struct snapshot
+{
+	/*! @brief The name of the program */
+	char program[SNAPSHOT_PROGRAM_SIZE];
+
+	/*! @brief The hash of the bytecode of the program */
+	uint64_t hash;
+
+	/*! @brief The program counter */
+	size_t pc;
+
+	/*! @brief The number of retired instructions */
+	uint64_t retired;
+
+	/*! @brief The number of executed read statements */
+	uint64_t reads;
+
+	/*! @brief The position of the input, negative if the input is not a file */
+	int64_t input_offset;
+
+	/*! @brief The position of the output, negative if the output is not a file */
+	int64_t output_offset;
+
+	/*! @brief Set if the input holds raw little-endian integers */
+	bool binary_input;
+
+	/*! @brief Set if the output receives raw little-endian integers */
+	bool binary_output;
+
+	/*! @brief The values of the variables followed by the temporaries */
+	int64_t *frame;
+
+	/*! @brief The number of variables and temporaries */
+	size_t frame_size;
+};
+
+/**
+ * @brief The checkpointer writes the snapshots of an execution at an interval of retired instructions and on SIGUSR1
+ *
+ * The interval is metered by the fuel of the interpreter and the signal interrupts the interpreter,
+ * so the execution is checkpointed between two instructions. The native code cannot be checkpointed
+ */
+struct checkpointer
+{
+	/*! @brief The name of the snapshot file */
+	const char *filename;
+
+	/*! @brief The name of the program */
+	const char *program;
+
+	/*! @brief The number of retired instructions between two snapshots, zero if only on SIGUSR1 */
+	uint64_t every;
+
+	/*! @brief The number of instructions the execution may retire, UINT64_MAX if unlimited */
+	uint64_t fuel;
+
+	/*! @brief The number of written snapshots */
+	uint64_t written;
+};
+
+/**
+ * @brief Hash the bytecode of a program, a snapshot resumes only the program it has been taken from
+ * @param bc A pointer to the bytecode
+ * @return The hash of the bytecode
+ */
+uint64_t snapshot_hash(const struct bytecode *bc);
+
+/**
+ * @brief Take the snapshot of an interpreter, flushing its output
+ * @param snap A pointer to the snapshot to initialize
+ * @param vm A pointer to the interpreter
+ * @param program The name of the program
+ */
+void snapshot_take(struct snapshot *snap, struct interpreter *vm, const char *program);
+
+/**
+ * @brief Write a snapshot to a file, replacing it at once
+ * @param snap A pointer to the snapshot
+ * @param filename The name of the file
+ * @return true if the snapshot has been written, false otherwise
+ */
+bool snapshot_write(const struct snapshot *snap, const char *filename);
+
+/**
+ * @brief Read a snapshot from a file
+ * @param snap A pointer to the snapshot to initialize, to be cleared only if the snapshot is read
+ * @param filename The name of the file
+ * @return true if the snapshot has been read, false if the file cannot be read or is invalid
+ */
+bool snapshot_read(struct snapshot *snap, const char *filename);
+
+/**
+ * @brief Restore the state of an interpreter from a snapshot
+ *
+ * The input and the output take the formats of the snapshot, the input is moved to its position or,
+ * if it is not a file, the values read before the snapshot are skipped.
+ * The output is moved to its position, discarding what was written after the snapshot, if it is a file
+ * @param snap A pointer to the snapshot
+ * @param vm A pointer to the interpreter, initialized with the bytecode of the snapshot
+ * @return true if the state has been restored, false if the snapshot has been taken from another program
+ */
+bool snapshot_restore(const struct snapshot *snap, struct interpreter *vm);
+
+/**
+ * @brief Clear a snapshot
+ * @param snap A pointer to the snapshot to clear
+ */
+void snapshot_clear(struct snapshot *snap);
+
+/**
+ * @brief Start checkpointing the execution of an interpreter, only one checkpointer can be active
+ * @param cp A pointer to the checkpointer to initialize
+ * @param vm A pointer to the interpreter, its interrupt handler is replaced and it is limited
+ * @param filename The name of the snapshot file
+ * @param program The name of the program
+ * @param every The number of retired instructions between two snapshots, zero if only on SIGUSR1
+ * @param fuel The number of instructions the execution may retire, UINT64_MAX if unlimited
+ * @param seconds The wall-clock time the execution may take, zero if unlimited
+ */
+void checkpointer_start(struct checkpointer *cp, struct interpreter *vm, const char *filename, const char *program,
+	uint64_t every, uint64_t fuel, double seconds);
+
+/**
+ * @brief Execute an interpreter writing its snapshots
+ * @param cp A pointer to the active checkpointer
+ * @param vm A pointer to the interpreter
+ * @return The outcome of the execution, as interpreter_execute
+ */
+enum interpreter_status checkpointer_execute(struct checkpointer *cp, struct interpreter *vm);
+
+/**
+ * @brief Stop checkpointing
+ * @param cp A pointer to the active checkpointer
+ */
+void checkpointer_stop(struct checkpointer *cp);
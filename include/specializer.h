@@ -0,0 +1,23 @@
+
+/*! @file specializer.h */
+
+#pragma once
+
+#include "instruction.h"
+
+/**
+ * @brief Specialize each instruction for the kinds of its operands
+ *
+ * The operand kinds are fixed once the semantic analysis is done,
+ * so the interpreter can execute the specialized operations without
+ * checking the operand types at run-time
+ * @param instrs The instruction list to rewrite
+ */
+void specialize(struct instruction_list instrs);
+
+/**
+ * @brief Get the operation of an instruction specialized for the kinds of its operands
+ * @param instr The instruction to specialize
+ * @return The specialized operation
+ */
+enum opcode specialize_instruction(struct instruction instr);
@@ -0,0 +1,44 @@
+
+/*! @file superinstructions.h */
+
+// generated by supergen from a sequence profile, regenerate it with the superinstructions target
+
+#pragma once
+
+/*! @brief The superinstructions made of two operations */
+#define SUPERINSTRUCTION_PAIRS(X) \
+	X(ADD_VL, ASSIGN_V) \
+	X(WRITE_V, ADD_VL) \
+	X(ASSIGN_V, ASSIGN_V) \
+	X(ASSIGN_V, BLT_VL) \
+	X(ASSIGN_V, WRITE_V) \
+	X(ADD_VV, ASSIGN_V) \
+	X(ASSIGN_V, BLT_VV) \
+	X(ASSIGN_L, ASSIGN_L) \
+	X(READ, BLTE_VL) \
+	X(READ, READ) \
+	X(READ, ADD_VV) \
+	X(ADD_VV, MUL_VV) \
+	X(ASSIGN_L, GOTO)
+
+/*! @brief The superinstructions made of three operations */
+#define SUPERINSTRUCTION_TRIPLES(X) \
+	X(WRITE_V, ADD_VL, ASSIGN_V) \
+	X(ADD_VL, ASSIGN_V, BLT_VL) \
+	X(ADD_VL, ASSIGN_V, BLT_VV) \
+	X(ADD_VV, ASSIGN_V, ASSIGN_V) \
+	X(ASSIGN_V, ASSIGN_V, ASSIGN_V) \
+	X(ASSIGN_V, ASSIGN_V, WRITE_V) \
+	X(ASSIGN_V, WRITE_V, ADD_VL) \
+	X(ASSIGN_L, ASSIGN_L, ASSIGN_L) \
+	X(READ, READ, ADD_VV) \
+	X(ADD_VV, ASSIGN_V, WRITE_V) \
+	X(ADD_VV, MUL_VV, WRITE_V) \
+	X(ASSIGN_L, ASSIGN_L, WRITE_V) \
+	X(ASSIGN_L, WRITE_V, WRITE_V) \
+	X(NEG_V, ASSIGN_V, WRITE_V) \
+	X(READ, ADD_VV, ASSIGN_V) \
+	X(READ, ADD_VV, MUL_VV) \
+	X(READ, NEG_V, WRITE_V) \
+	X(READ, READ, READ) \
+	X(WRITE_V, WRITE_V, GOTO)
@@ -27,8 +27,8 @@ struct symbol
 	/*! @brief The identifier string of the symbol */
 	char id[ID_STR_SIZE];
 
-	/*! @brief The integral value of the symbol */
-	int64_t value;
+	/*! @brief The frame slot of the variable, assigned by the semanter */
+	size_t slot;
 
 	/*! @brief The next symbol in the symbol table bucket */
 	struct symbol *next;
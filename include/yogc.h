@@ -0,0 +1,128 @@
+
+/*! @file yogc.h */
+
+#pragma once
+
+#include "bytecode.h"
+#include "linetable.h"
+
+/*! @brief The version of the precompiled bytecode format, increased at each incompatible change */
+#define YOGC_VERSION 1
+
+/*! @brief The maximum length of the path of a cached precompiled bytecode */
+#define YOGC_PATH_SIZE 4096
+
+/**
+ * @brief The header of a precompiled bytecode file
+ *
+ * The sections follow the header at the given offsets, aligned to 8 bytes, in the layout of the structures in memory,
+ * so that a mapped file is executed in place without fixups
+ */
+struct yogc_header
+{
+	/*! @brief The magic number "YOGC" */
+	char magic[4];
+
+	/*! @brief The version of the format */
+	uint32_t version;
+
+	/*! @brief The fingerprint of the layout of the instructions, of the operations and of the superinstructions */
+	uint64_t layout;
+
+	/*! @brief The hash of the source code */
+	uint64_t hash;
+
+	/*! @brief The size of the file */
+	uint64_t file_size;
+
+	/*! @brief The number of instructions */
+	uint64_t size;
+
+	/*! @brief The number of constants */
+	uint64_t constants_cnt;
+
+	/*! @brief The number of variables */
+	uint64_t vars_cnt;
+
+	/*! @brief The number of temporary variables */
+	uint64_t tmp_cnt;
+
+	/*! @brief The number of entries of the line table */
+	uint64_t lines_cnt;
+
+	/*! @brief The offset of the instructions */
+	uint64_t code_offset;
+
+	/*! @brief The offset of the constant pool */
+	uint64_t constants_offset;
+
+	/*! @brief The offset of the identifiers of the variables */
+	uint64_t names_offset;
+
+	/*! @brief The offset of the line table */
+	uint64_t lines_offset;
+};
+
+/*! @brief A precompiled bytecode loaded from a file */
+struct yogc
+{
+	/*! @brief The contents of the file, mapped or read */
+	void *base;
+
+	/*! @brief The size of the contents */
+	size_t size;
+
+	/*! @brief Set if the contents are mapped */
+	bool mapped;
+
+	/*! @brief The bytecode, which points into the contents */
+	struct bytecode bc;
+
+	/*! @brief The line table, which points into the contents */
+	struct line_table lines;
+};
+
+/**
+ * @brief Hash a source code, the hash keys the cache of the precompiled bytecodes
+ * @param source The source code buffer
+ * @param size The number of characters of the source code
+ * @return The hash of the source code
+ */
+uint64_t yogc_hash(const char *source, size_t size);
+
+/**
+ * @brief Write a precompiled bytecode file
+ *
+ * The file is written to a temporary file renamed at the end, so a concurrent loader never sees it partially written
+ * @param filename The name of the file
+ * @param bc A pointer to the bytecode
+ * @param lines The line table of the bytecode
+ * @param hash The hash of the source code
+ * @return true if the file has been written, false otherwise
+ */
+bool yogc_write(const char *filename, const struct bytecode *bc, struct line_table lines, uint64_t hash);
+
+/**
+ * @brief Load a precompiled bytecode file, mapping it in memory where supported
+ * @param image A pointer to the precompiled bytecode to initialize
+ * @param filename The name of the file
+ * @param hash A pointer to the hash the source code must have, NULL to accept any source code
+ * @return true if the file has been loaded, false if it cannot be read, it is invalid, including its instructions, or it is stale
+ */
+bool yogc_load(struct yogc *image, const char *filename, const uint64_t *hash);
+
+/**
+ * @brief Clear a precompiled bytecode, unmapping its file
+ * @param image A pointer to the precompiled bytecode to clear
+ */
+void yogc_clear(struct yogc *image);
+
+/**
+ * @brief Get the path of the cached precompiled bytecode of a source code
+ *
+ * The cache directory is YOG_CACHE_DIR, otherwise $XDG_CACHE_HOME/yog or $HOME/.cache/yog, and it is created if missing
+ * @param path The buffer of the path, of YOGC_PATH_SIZE characters
+ * @param hash The hash of the source code
+ * @return true if the cache is available, false otherwise
+ */
+bool yogc_cache_path(char *path, uint64_t hash);
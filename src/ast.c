@@ -33,6 +33,7 @@ void ast_clear(struct ast *tree)
 	for(size_t i = 0; i < tree->children_cnt; ++i)
 		ast_clear(tree->children[i]);
 
+	yfree(tree->children);
 	yfree(tree);
 }
 
@@ -44,3 +45,15 @@ struct ast *ast_add_child(struct ast *tree, struct ast *child)
 	return child;
 }
 
+struct location ast_location(const struct ast *tree)
+{
+	struct location loc = { 0, 0 };
+
+	if(tree->type == AST_TERMINAL)
+		return tree->tok.loc;
+
+	for(size_t i = 0; i < tree->children_cnt && loc.row == 0; i++)
+		loc = ast_location(tree->children[i]);
+
+	return loc;
+}
@@ -0,0 +1,395 @@
+
+// the threads are not part of the strict C99 environment
+#if defined(__unix__) || defined(__APPLE__)
+#define YOG_BATCH_THREADS
+#if defined(__linux__)
+#define _GNU_SOURCE
+#else
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "batch.h"
+
+#ifdef YOG_BATCH_THREADS
+/*! @brief A worker of the pool, which owns the jobs from top to bottom */
+struct batch_worker
+{
+	/*! @brief The thread of the worker */
+	pthread_t thread;
+
+	/*! @brief The lock of the owned jobs */
+	pthread_mutex_t lock;
+
+	/*! @brief The index of the next owned job */
+	size_t top;
+
+	/*! @brief The index following the last owned job */
+	size_t bottom;
+
+	/*! @brief The index of the worker */
+	size_t index;
+
+	/*! @brief Set if the thread of the worker has started, otherwise the caller executes its jobs */
+	bool started;
+
+	/*! @brief A pointer to the batch runner */
+	struct batch *b;
+};
+
+struct batch_state
+{
+	/*! @brief The workers */
+	struct batch_worker *workers;
+
+	/*! @brief The lock of the completed jobs */
+	pthread_mutex_t lock;
+
+	/*! @brief Signaled when a job is completed */
+	pthread_cond_t completed;
+
+	/*! @brief Set for each completed job */
+	bool *done;
+};
+
+void *worker_main(void *arg);
+bool worker_take(struct batch_worker *worker, size_t *job);
+void worker_pin(struct batch_worker *worker);
+#endif
+
+void run_job(struct batch *b, struct interpreter *vm, struct batch_job *job, FILE *out);
+
+bool batch_supported(void)
+{
+#ifdef YOG_BATCH_THREADS
+	return true;
+#else
+	return false;
+#endif
+}
+
+size_t batch_processors(void)
+{
+#ifdef YOG_BATCH_THREADS
+	long cnt = sysconf(_SC_NPROCESSORS_ONLN);
+	return cnt > 0 ? (size_t)cnt : 1;
+#else
+	return 1;
+#endif
+}
+
+void batch_init(struct batch *b, const struct bytecode *bc, enum interpreter_dispatch dispatch, size_t workers_cnt)
+{
+	b->bc = bc;
+	b->dispatch = dispatch;
+	b->fuel = UINT64_MAX;
+	b->timeout = 0;
+	b->workers_cnt = workers_cnt > 0 ? workers_cnt : 1;
+	b->pin = false;
+	b->binary_input = false;
+	b->binary_output = false;
+	b->jobs = NULL;
+	b->jobs_cnt = 0;
+	b->steals = 0;
+	b->state = NULL;
+}
+
+void batch_clear(struct batch *b)
+{
+	for(size_t i = 0; i < b->jobs_cnt; i++)
+		free(b->jobs[i].output); // allocated by the output stream
+
+	yfree(b->jobs);
+	b->jobs = NULL;
+	b->jobs_cnt = 0;
+}
+
+int batch_execute(struct batch *b, const char **filenames, size_t cnt, FILE *out, FILE *err)
+{
+	batch_clear(b);
+
+	b->jobs = ycalloc(cnt, sizeof(struct batch_job));
+	b->jobs_cnt = cnt;
+	b->steals = 0;
+
+	for(size_t i = 0; i < cnt; i++)
+	{
+		b->jobs[i].filename = filenames[i];
+		b->jobs[i].output = NULL;
+		b->jobs[i].output_len = 0;
+		b->jobs[i].failed = false;
+		b->jobs[i].unbuffered = false;
+		b->jobs[i].status = INTERPRETER_HALTED;
+	}
+
+	int status = 0;
+
+#ifdef YOG_BATCH_THREADS
+	struct batch_state state;
+	size_t workers_cnt = b->workers_cnt < cnt ? b->workers_cnt : cnt;
+
+	state.workers = ymalloc(workers_cnt * sizeof(struct batch_worker));
+	state.done = ycalloc(cnt, sizeof(bool));
+	pthread_mutex_init(&state.lock, NULL);
+	pthread_cond_init(&state.completed, NULL);
+	b->state = &state;
+
+	// each worker owns a contiguous range of jobs, so the jobs are completed roughly in order
+	for(size_t w = 0; w < workers_cnt; w++)
+	{
+		struct batch_worker *worker = &state.workers[w];
+
+		worker->top = cnt * w / workers_cnt;
+		worker->bottom = cnt * (w + 1) / workers_cnt;
+		worker->index = w;
+		worker->b = b;
+		pthread_mutex_init(&worker->lock, NULL);
+	}
+
+	for(size_t w = 0; w < workers_cnt; w++)
+		state.workers[w].started = pthread_create(&state.workers[w].thread, NULL, worker_main, &state.workers[w]) == 0;
+
+	// the jobs of the workers which have not started are executed here, the others may steal them meanwhile
+	for(size_t w = 0; w < workers_cnt; w++)
+	{
+		if(!state.workers[w].started)
+			worker_main(&state.workers[w]);
+	}
+
+	// write the outputs in order while the following jobs are executed
+	for(size_t i = 0; i < cnt; i++)
+	{
+		pthread_mutex_lock(&state.lock);
+
+		while(!state.done[i])
+			pthread_cond_wait(&state.completed, &state.lock);
+
+		pthread_mutex_unlock(&state.lock);
+
+		int job_status = batch_report(&b->jobs[i], out, err);
+		if(status == 0)
+			status = job_status;
+	}
+
+	for(size_t w = 0; w < workers_cnt; w++)
+	{
+		if(state.workers[w].started)
+			pthread_join(state.workers[w].thread, NULL);
+
+		pthread_mutex_destroy(&state.workers[w].lock);
+	}
+
+	pthread_cond_destroy(&state.completed);
+	pthread_mutex_destroy(&state.lock);
+	yfree(state.done);
+	yfree(state.workers);
+	b->state = NULL;
+#else
+	// execute the jobs in order, writing their outputs directly
+	struct interpreter vm;
+	interpreter_init(&vm, b->bc, b->dispatch);
+	vm.interactive = false;
+	vm.input.binary = b->binary_input;
+	vm.output.binary = b->binary_output;
+
+	for(size_t i = 0; i < cnt; i++)
+	{
+		run_job(b, &vm, &b->jobs[i], out);
+
+		int job_status = batch_report(&b->jobs[i], out, err);
+		if(status == 0)
+			status = job_status;
+	}
+
+	interpreter_clear(&vm);
+#endif
+
+	return status;
+}
+
+int batch_report(const struct batch_job *job, FILE *out, FILE *err)
+{
+	if(job->output_len > 0)
+		fwrite(job->output, 1, job->output_len, out);
+
+	if(job->failed)
+	{
+		fprintf(err, "failed to open %s\n", job->filename);
+		return 2;
+	}
+
+	if(job->unbuffered)
+	{
+		fprintf(err, "%s: failed to buffer the output\n", job->filename);
+		return 2;
+	}
+
+	if(job->status == INTERPRETER_DIVISION_BY_ZERO)
+	{
+		fprintf(err, "%s: division by zero at instruction %zu\n", job->filename, job->pc);
+		return 6;
+	}
+
+	// a job which is not resumed ends where its input has no value yet
+	if(job->status == INTERPRETER_END_OF_INPUT || job->status == INTERPRETER_INVALID_INPUT || job->status == INTERPRETER_NEEDS_INPUT)
+	{
+		fprintf(err, "%s: %s at instruction %zu\n", job->filename,
+			job->status == INTERPRETER_INVALID_INPUT ? "invalid input" : "end of input", job->pc);
+
+		return job->status == INTERPRETER_INVALID_INPUT ? 8 : 7;
+	}
+
+	if(job->status != INTERPRETER_HALTED)
+	{
+		fprintf(err, "%s: %s at instruction %zu after %llu instructions\n", job->filename,
+			job->status == INTERPRETER_FUEL_EXHAUSTED ? "fuel exhausted" : "deadline exceeded",
+			job->pc, (unsigned long long)job->retired);
+
+		return job->status == INTERPRETER_FUEL_EXHAUSTED ? 4 : 5;
+	}
+
+	return 0;
+}
+
+// execute the bytecode over the input file of a job, writing its values to out
+void run_job(struct batch *b, struct interpreter *vm, struct batch_job *job, FILE *out)
+{
+	FILE *in = fopen(job->filename, b->binary_input ? "rb" : "r");
+	if(!in)
+	{
+		job->failed = true;
+		return;
+	}
+
+	vm->in = in;
+	vm->out = out;
+	interpreter_reset(vm);
+
+	if(b->fuel != UINT64_MAX || b->timeout > 0)
+		interpreter_limit(vm, b->fuel, b->timeout);
+
+	job->status = interpreter_execute(vm);
+	job->pc = vm->pc;
+	job->retired = vm->retired;
+
+	// a job stopped by a limit is not resumed, its input is released before it is closed
+	input_unbind(&vm->input);
+	fclose(in);
+}
+
+#ifdef YOG_BATCH_THREADS
+void *worker_main(void *arg)
+{
+	struct batch_worker *worker = arg;
+	struct batch *b = worker->b;
+
+	// the caller executing the jobs of a worker which has not started is not pinned
+	if(b->pin && worker->started)
+		worker_pin(worker);
+
+	// the interpreter is reused for all the jobs of the worker, so the native code is compiled once
+	struct interpreter vm;
+	interpreter_init(&vm, b->bc, b->dispatch);
+	vm.interactive = false;
+	vm.input.binary = b->binary_input;
+	vm.output.binary = b->binary_output;
+
+	size_t i;
+
+	while(worker_take(worker, &i))
+	{
+		struct batch_job *job = &b->jobs[i];
+		FILE *out = open_memstream(&job->output, &job->output_len);
+
+		if(out != NULL)
+		{
+			run_job(b, &vm, job, out);
+			fclose(out);
+		}
+		else
+		{
+			job->unbuffered = true;
+		}
+
+		pthread_mutex_lock(&b->state->lock);
+		b->state->done[i] = true;
+		pthread_cond_broadcast(&b->state->completed);
+		pthread_mutex_unlock(&b->state->lock);
+	}
+
+	interpreter_clear(&vm);
+
+	return NULL;
+}
+
+// take the next owned job, or steal the second half of the jobs of another worker
+bool worker_take(struct batch_worker *worker, size_t *job)
+{
+	struct batch_state *state = worker->b->state;
+	size_t workers_cnt = worker->b->workers_cnt < worker->b->jobs_cnt ? worker->b->workers_cnt : worker->b->jobs_cnt;
+
+	pthread_mutex_lock(&worker->lock);
+
+	if(worker->top < worker->bottom)
+	{
+		*job = worker->top++;
+		pthread_mutex_unlock(&worker->lock);
+		return true;
+	}
+
+	pthread_mutex_unlock(&worker->lock);
+
+	for(size_t k = 1; k < workers_cnt; k++)
+	{
+		struct batch_worker *victim = &state->workers[(worker->index + k) % workers_cnt];
+
+		pthread_mutex_lock(&victim->lock);
+
+		if(victim->top < victim->bottom)
+		{
+			size_t bottom = victim->bottom;
+			victim->bottom -= (bottom - victim->top) / 2;
+			size_t top = victim->bottom;
+
+			if(top == bottom)
+			{
+				// a single job left, take it
+				top = --victim->bottom;
+			}
+
+			pthread_mutex_unlock(&victim->lock);
+
+			pthread_mutex_lock(&worker->lock);
+			worker->top = top + 1;
+			worker->bottom = bottom;
+			pthread_mutex_unlock(&worker->lock);
+
+			pthread_mutex_lock(&state->lock);
+			worker->b->steals++;
+			pthread_mutex_unlock(&state->lock);
+
+			*job = top;
+			return true;
+		}
+
+		pthread_mutex_unlock(&victim->lock);
+	}
+
+	// the jobs are never added, so they are all taken
+	return false;
+}
+
+void worker_pin(struct batch_worker *worker)
+{
+#if defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(worker->index % batch_processors(), &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+	(void)worker;
+#endif
+}
+#endif
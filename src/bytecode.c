@@ -0,0 +1,301 @@
+
+#include "bytecode.h"
+#include "specializer.h"
+#include "peephole.h"
+
+// open addressing hash map from the literal values to their constant pool indices
+struct index_map
+{
+	uint64_t *keys;
+	uint32_t *values;
+	size_t capacity;
+	size_t size;
+};
+
+void index_map_init(struct index_map *map);
+void index_map_clear(struct index_map *map);
+uint32_t index_map_get(struct index_map *map, uint64_t key, uint32_t new_value);
+
+uint32_t encode_operand(struct bytecode *bc, struct operand op, struct index_map *consts);
+bool valid_instruction(const struct bytecode_instruction *instr, size_t size, size_t frame_size, size_t constants_cnt);
+bool valid_operand(enum operand_type kind, uint32_t index, size_t frame_size, size_t constants_cnt);
+
+bool bytecode_init(struct bytecode *bc, struct instruction_list instrs, struct symbol_table st, size_t vars_cnt, size_t tmp_cnt)
+{
+	if(instrs.size >= UINT32_MAX || vars_cnt + tmp_cnt > UINT32_MAX)
+		return false;
+
+	bc->code = ymalloc(instrs.size * sizeof(struct bytecode_instruction));
+	bc->size = instrs.size;
+	bc->constants_cnt = 0;
+	bc->vars_cnt = vars_cnt;
+	bc->tmp_cnt = tmp_cnt;
+
+	// each instruction adds at most two constants to the pool
+	bc->constants = ymalloc(2 * instrs.size * sizeof(int64_t));
+
+	// collect the identifiers of the declared variables by slot
+	bc->names = ycalloc(vars_cnt, ID_STR_SIZE);
+
+	for(size_t i = 0; i < st.buckets_cnt; i++)
+	{
+		for(struct symbol *sym = st.buckets[i]; sym != NULL; sym = sym->next)
+		{
+			if(sym->type != SYMBOL_UNKNOW)
+				strcpy(bc->names[sym->slot], sym->id);
+		}
+	}
+
+	struct index_map consts;
+	index_map_init(&consts);
+
+	for(size_t i = 0; i < instrs.size; i++)
+	{
+		struct instruction instr = instrs.data[i];
+		struct bytecode_instruction *bc_instr = &bc->code[i];
+
+		bc_instr->type = instr.type;
+		bc_instr->op = instr.op;
+		bc_instr->super = (uint8_t)instr.super;
+		bc_instr->src1 = 0;
+		bc_instr->src2 = 0;
+		bc_instr->dest = 0;
+
+		// encode only the operands used by the instruction type
+		enum operand_type src1_kind = OPERAND_TEMPORARY;
+		enum operand_type src2_kind = OPERAND_TEMPORARY;
+		enum operand_type dest_kind = OPERAND_TEMPORARY;
+
+		size_t src_cnt = instruction_src_cnt(instr.type);
+
+		if(src_cnt >= 1)
+		{
+			src1_kind = instr.src1.type;
+			bc_instr->src1 = encode_operand(bc, instr.src1, &consts);
+		}
+
+		if(src_cnt >= 2)
+		{
+			src2_kind = instr.src2.type;
+			bc_instr->src2 = encode_operand(bc, instr.src2, &consts);
+		}
+
+		if(instruction_has_dest(instr.type))
+		{
+			dest_kind = instr.dest.type;
+			bc_instr->dest = encode_operand(bc, instr.dest, &consts);
+		}
+
+		bc_instr->kinds = BYTECODE_KINDS(src1_kind, src2_kind, dest_kind);
+	}
+
+	index_map_clear(&consts);
+
+	// shrink the constant pool to its actual size
+	bc->constants = yrealloc(bc->constants, bc->constants_cnt * sizeof(int64_t));
+
+	return true;
+}
+
+bool bytecode_valid(const struct bytecode *bc)
+{
+	size_t frame_size = bc->vars_cnt + bc->tmp_cnt;
+
+	for(size_t i = 0; i < bc->size; i++)
+	{
+		const struct bytecode_instruction *instr = &bc->code[i];
+
+		if(!valid_instruction(instr, bc->size, frame_size, bc->constants_cnt) || instr->super >= SUPERINSTRUCTION_CNT)
+			return false;
+
+		// the superinstruction executes its own operations over the operands of the instructions it covers
+		if(instr->super != SUPERINSTRUCTION_NONE)
+		{
+			size_t length = superinstruction_length(instr->super);
+
+			if(length > bc->size - i)
+				return false;
+
+			for(size_t k = 0; k < length; k++)
+			{
+				if(bc->code[i + k].op != superinstruction_operation(instr->super, k))
+					return false;
+			}
+		}
+	}
+
+	for(size_t i = 0; i < bc->vars_cnt; i++)
+	{
+		if(memchr(bc->names[i], '\0', ID_STR_SIZE) == NULL)
+			return false;
+	}
+
+	return true;
+}
+
+void bytecode_clear(struct bytecode *bc)
+{
+	yfree(bc->code);
+	bc->code = NULL;
+	bc->size = 0;
+	yfree(bc->constants);
+	bc->constants = NULL;
+	bc->constants_cnt = 0;
+	yfree(bc->names);
+	bc->names = NULL;
+	bc->vars_cnt = 0;
+	bc->tmp_cnt = 0;
+}
+
+uint32_t encode_operand(struct bytecode *bc, struct operand op, struct index_map *consts)
+{
+	uint32_t index;
+
+	switch(op.type)
+	{
+		case OPERAND_LITERAL:
+			index = index_map_get(consts, (uint64_t)op.lit, bc->constants_cnt);
+
+			// add the literal to the constant pool if it is new
+			if(index == bc->constants_cnt)
+				bc->constants[bc->constants_cnt++] = op.lit;
+
+			return index;
+
+		case OPERAND_SYMBOL:
+			return (uint32_t)op.sym->slot;
+
+		case OPERAND_TEMPORARY:
+			// the temporaries follow the variables in the frame
+			return (uint32_t)(bc->vars_cnt + op.index);
+
+		default: // case OPERAND_LABEL:
+			return (uint32_t)op.index;
+	}
+}
+
+// check an instruction as bytecode_init encodes it, its operation is the specialization of its type for its kinds
+bool valid_instruction(const struct bytecode_instruction *instr, size_t size, size_t frame_size, size_t constants_cnt)
+{
+	if(instr->type > INSTRUCTION_BGTE || instr->kinds >> 6 != 0)
+		return false;
+
+	struct instruction decoded;
+	memset(&decoded, 0, sizeof(decoded));
+	decoded.type = instr->type;
+	decoded.src1.type = BYTECODE_KIND_SRC1(instr->kinds);
+	decoded.src2.type = BYTECODE_KIND_SRC2(instr->kinds);
+	decoded.dest.type = BYTECODE_KIND_DEST(instr->kinds);
+
+	// the unused operands are encoded as the first temporary
+	size_t src_cnt = instruction_src_cnt(decoded.type);
+
+	if(src_cnt >= 1 ? !valid_operand(decoded.src1.type, instr->src1, frame_size, constants_cnt)
+		: decoded.src1.type != OPERAND_TEMPORARY || instr->src1 != 0)
+		return false;
+
+	if(src_cnt >= 2 ? !valid_operand(decoded.src2.type, instr->src2, frame_size, constants_cnt)
+		: decoded.src2.type != OPERAND_TEMPORARY || instr->src2 != 0)
+		return false;
+
+	// the jumps may target the halt, which follows the last instruction
+	if(decoded.type >= INSTRUCTION_GOTO)
+	{
+		if(decoded.dest.type != OPERAND_LABEL || instr->dest > size)
+			return false;
+	}
+	else if(instruction_has_dest(decoded.type))
+	{
+		if(decoded.dest.type == OPERAND_LITERAL || !valid_operand(decoded.dest.type, instr->dest, frame_size, constants_cnt))
+			return false;
+	}
+	else if(decoded.dest.type != OPERAND_TEMPORARY || instr->dest != 0)
+	{
+		return false;
+	}
+
+	// the threaded code tests the condition of a branch in the frame
+	if(decoded.type == INSTRUCTION_BRANCH && decoded.src1.type == OPERAND_LITERAL)
+		return false;
+
+	return instr->op == specialize_instruction(decoded);
+}
+
+bool valid_operand(enum operand_type kind, uint32_t index, size_t frame_size, size_t constants_cnt)
+{
+	switch(kind)
+	{
+		case OPERAND_TEMPORARY:
+		case OPERAND_SYMBOL:
+			return index < frame_size;
+
+		case OPERAND_LITERAL:
+			return index < constants_cnt;
+
+		default: // case OPERAND_LABEL:
+			return false;
+	}
+}
+
+void index_map_init(struct index_map *map)
+{
+	map->capacity = 16;
+	map->size = 0;
+	map->keys = ymalloc(map->capacity * sizeof(uint64_t));
+	map->values = ymalloc(map->capacity * sizeof(uint32_t));
+
+	for(size_t i = 0; i < map->capacity; i++)
+		map->values[i] = UINT32_MAX;
+}
+
+void index_map_clear(struct index_map *map)
+{
+	yfree(map->keys);
+	yfree(map->values);
+	map->keys = NULL;
+	map->values = NULL;
+	map->capacity = 0;
+	map->size = 0;
+}
+
+uint32_t index_map_get(struct index_map *map, uint64_t key, uint32_t new_value)
+{
+	// fibonacci hashing of the key
+	size_t i = (size_t)((key * 0x9e3779b97f4a7c15ull) >> 32) & (map->capacity - 1);
+
+	while(map->values[i] != UINT32_MAX)
+	{
+		if(map->keys[i] == key)
+			return map->values[i];
+
+		i = (i + 1) & (map->capacity - 1);
+	}
+
+	map->keys[i] = key;
+	map->values[i] = new_value;
+	map->size++;
+
+	// keep the load factor under 0.5
+	if(2 * map->size > map->capacity)
+	{
+		struct index_map new_map;
+		new_map.capacity = 2 * map->capacity;
+		new_map.size = 0;
+		new_map.keys = ymalloc(new_map.capacity * sizeof(uint64_t));
+		new_map.values = ymalloc(new_map.capacity * sizeof(uint32_t));
+
+		for(size_t j = 0; j < new_map.capacity; j++)
+			new_map.values[j] = UINT32_MAX;
+
+		for(size_t j = 0; j < map->capacity; j++)
+		{
+			if(map->values[j] != UINT32_MAX)
+				index_map_get(&new_map, map->keys[j], map->values[j]);
+		}
+
+		index_map_clear(map);
+		*map = new_map;
+	}
+
+	return new_value;
+}
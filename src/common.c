@@ -64,3 +64,30 @@ char *ystrdup(char *str)
 	return ptr;
 }
 
+char *yread_file(const char *filename, size_t *size)
+{
+	FILE *in = fopen(filename, "rb");
+	if(!in)
+		return NULL;
+
+	size_t capacity = 4096;
+	char *buffer = ymalloc(capacity);
+	size_t cnt;
+
+	*size = 0;
+
+	while((cnt = fread(buffer + *size, 1, capacity - *size, in)) > 0)
+	{
+		*size += cnt;
+
+		if(*size == capacity)
+		{
+			capacity *= 2;
+			buffer = yrealloc(buffer, capacity);
+		}
+	}
+
+	fclose(in);
+
+	return buffer;
+}
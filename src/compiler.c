@@ -0,0 +1,79 @@
+
+#include "compiler.h"
+#include "parser.h"
+#include "semanter.h"
+#include "regalloc.h"
+#include "peephole.h"
+#include "specializer.h"
+
+bool compile(struct compilation *comp, const char *source, size_t size, FILE *errors)
+{
+	struct error_list errs;
+	error_list_init(&errs);
+
+	symbol_table_init(&comp->st);
+
+	struct parse_context ctx;
+	parse_context_init_buffer(&ctx, source, size, &comp->st, &errs);
+
+	// parse the source code and obtain the abstract syntax tree
+	struct ast *tree = parse(&ctx);
+
+	struct semantic_context sem_ctx;
+	semantic_context_init(&sem_ctx, &comp->st, &errs, tree);
+
+	// analyse the abstract syntax tree and obtain the instruction list
+	comp->instrs = semantic_context_analyse(&sem_ctx);
+	comp->lines = sem_ctx.lines;
+	comp->tmp_cnt = sem_ctx.tmp_cnt;
+
+	ast_clear(tree);
+
+	// check if a compile-time error has been occured
+	if(!error_list_empty(errs))
+	{
+		if(errors != NULL)
+			error_list_print(errors, errs);
+
+		error_list_clear(&errs);
+		instruction_list_clear(&comp->instrs);
+		line_table_clear(&comp->lines);
+		symbol_table_clear(&comp->st);
+
+		return false;
+	}
+
+	error_list_clear(&errs);
+
+	// allocate the temporaries to a reusable register file
+	size_t regs_cnt = allocate_temporaries(comp->instrs, comp->tmp_cnt);
+
+	// specialize the instructions for the kinds of their operands
+	specialize(comp->instrs);
+
+	// mark the sequences of operations executed by superinstructions
+	combine_superinstructions(comp->instrs);
+
+	// encode the instructions to the compact bytecode, whose operands are 32-bit indices
+	if(!bytecode_init(&comp->bc, comp->instrs, comp->st, sem_ctx.vars_cnt, regs_cnt))
+	{
+		if(errors != NULL)
+			fprintf(errors, "program too large for the bytecode\n");
+
+		instruction_list_clear(&comp->instrs);
+		line_table_clear(&comp->lines);
+		symbol_table_clear(&comp->st);
+
+		return false;
+	}
+
+	return true;
+}
+
+void compilation_clear(struct compilation *comp)
+{
+	bytecode_clear(&comp->bc);
+	line_table_clear(&comp->lines);
+	instruction_list_clear(&comp->instrs);
+	symbol_table_clear(&comp->st);
+}
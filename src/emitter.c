@@ -0,0 +1,234 @@
+
+#include "emitter.h"
+
+// the runtime of the translated programs, it behaves as the interpreter
+static const char *Runtime =
+	"#if defined(__unix__) || defined(__APPLE__)\n"
+	"#define _POSIX_C_SOURCE 200809L\n"
+	"#endif\n"
+	"\n"
+	"#include <stdio.h>\n"
+	"#include <stdlib.h>\n"
+	"#include <stdint.h>\n"
+	"#include <inttypes.h>\n"
+	"\n"
+	"#if defined(__unix__) || defined(__APPLE__)\n"
+	"#include <unistd.h>\n"
+	"#define YOG_INTERACTIVE isatty(0)\n"
+	"#elif defined(_WIN32)\n"
+	"#include <io.h>\n"
+	"#define YOG_INTERACTIVE _isatty(0)\n"
+	"#else\n"
+	"#define YOG_INTERACTIVE 1\n"
+	"#endif\n"
+	"\n"
+	"static inline void yog_read(const char *name, int64_t *value, int line)\n"
+	"{\n"
+	"\tstatic int interactive = -1;\n"
+	"\tif(interactive < 0)\n"
+	"\t\tinteractive = YOG_INTERACTIVE;\n"
+	"\n"
+	"\tif(interactive)\n"
+	"\t{\n"
+	"\t\tprintf(\"enter the value of \\\"%s\\\": \", name);\n"
+	"\t\tfflush(stdout);\n"
+	"\t}\n"
+	"\n"
+	"\tint result = scanf(\"%\" SCNd64, value);\n"
+	"\tif(result != 1)\n"
+	"\t{\n"
+	"\t\tfflush(stdout);\n"
+	"\t\tfprintf(stderr, \"%s at line %d\\n\", result == EOF ? \"end of input\" : \"invalid input\", line);\n"
+	"\t\texit(result == EOF ? 7 : 8);\n"
+	"\t}\n"
+	"}\n"
+	"\n"
+	"static inline void yog_write(int64_t value)\n"
+	"{\n"
+	"\tprintf(\"%\" PRId64 \"\\n\", value);\n"
+	"}\n"
+	"\n"
+	"static inline int64_t yog_div(int64_t left, int64_t right, int line)\n"
+	"{\n"
+	"\tif(right == 0)\n"
+	"\t{\n"
+	"\t\tfflush(stdout);\n"
+	"\t\tfprintf(stderr, \"division by zero at line %d\\n\", line);\n"
+	"\t\texit(6);\n"
+	"\t}\n"
+	"\n"
+	"\treturn left / right;\n"
+	"}\n"
+	"\n";
+
+// the C operators of the instructions, indexed by instruction type
+static const char *const Operators[] =
+{
+	[INSTRUCTION_ADD] = "+",
+	[INSTRUCTION_SUB] = "-",
+	[INSTRUCTION_MUL] = "*",
+	[INSTRUCTION_PLS] = "+",
+	[INSTRUCTION_NEG] = "-",
+	[INSTRUCTION_EQ] = "==",
+	[INSTRUCTION_NEQ] = "!=",
+	[INSTRUCTION_LT] = "<",
+	[INSTRUCTION_LTE] = "<=",
+	[INSTRUCTION_GT] = ">",
+	[INSTRUCTION_GTE] = ">=",
+	[INSTRUCTION_BEQ] = "==",
+	[INSTRUCTION_BNEQ] = "!=",
+	[INSTRUCTION_BLT] = "<",
+	[INSTRUCTION_BLTE] = "<=",
+	[INSTRUCTION_BGT] = ">",
+	[INSTRUCTION_BGTE] = ">="
+};
+
+void emit_slot(FILE *out, const struct bytecode *bc, uint32_t slot);
+void emit_operand(FILE *out, const struct bytecode *bc, enum operand_type kind, uint32_t index);
+
+void emit_c(FILE *out, const struct bytecode *bc, struct line_table lines, const char *filename)
+{
+	fprintf(out, "/* generated by yog from %s */\n\n", filename);
+	fputs(Runtime, out);
+
+	// mark the jump targets, which need a label
+	bool *targets = ycalloc(bc->size + 1, sizeof(bool));
+
+	for(size_t i = 0; i < bc->size; i++)
+	{
+		if(opcode_is_jump(bc->code[i].op))
+			targets[bc->code[i].dest] = true;
+	}
+
+	fprintf(out, "int main(void)\n{\n");
+
+	// the frame slots become locals, zero initialized as the frame of the interpreter
+	for(uint32_t slot = 0; slot < bc->vars_cnt + bc->tmp_cnt; slot++)
+	{
+		fprintf(out, "\tint64_t ");
+		emit_slot(out, bc, slot);
+		fprintf(out, " = 0;\n");
+	}
+
+	fprintf(out, "\n");
+
+	for(size_t i = 0; i <= bc->size; i++)
+	{
+		if(targets[i])
+			fprintf(out, "L%zu:\n", i);
+
+		if(i == bc->size)
+			break;
+
+		const struct bytecode_instruction *instr = &bc->code[i];
+		enum operand_type kind1 = BYTECODE_KIND_SRC1(instr->kinds);
+		enum operand_type kind2 = BYTECODE_KIND_SRC2(instr->kinds);
+
+		fprintf(out, "\t");
+
+		switch(instr->type)
+		{
+			case INSTRUCTION_ASSIGN:
+				emit_slot(out, bc, instr->dest);
+				fprintf(out, " = ");
+				emit_operand(out, bc, kind1, instr->src1);
+				break;
+
+			case INSTRUCTION_READ:
+				fprintf(out, "yog_read(\"%s\", &", bc->names[instr->dest]);
+				emit_slot(out, bc, instr->dest);
+				fprintf(out, ", %zu)", line_table_find(lines, i).row);
+				break;
+
+			case INSTRUCTION_WRITE:
+				fprintf(out, "yog_write(");
+				emit_operand(out, bc, kind1, instr->src1);
+				fprintf(out, ")");
+				break;
+
+			case INSTRUCTION_DIV:
+				emit_slot(out, bc, instr->dest);
+				fprintf(out, " = yog_div(");
+				emit_operand(out, bc, kind1, instr->src1);
+				fprintf(out, ", ");
+				emit_operand(out, bc, kind2, instr->src2);
+				fprintf(out, ", %zu)", line_table_find(lines, i).row);
+				break;
+
+			case INSTRUCTION_ADD:
+			case INSTRUCTION_SUB:
+			case INSTRUCTION_MUL:
+			case INSTRUCTION_EQ:
+			case INSTRUCTION_NEQ:
+			case INSTRUCTION_LT:
+			case INSTRUCTION_LTE:
+			case INSTRUCTION_GT:
+			case INSTRUCTION_GTE:
+				emit_slot(out, bc, instr->dest);
+				fprintf(out, " = ");
+				emit_operand(out, bc, kind1, instr->src1);
+				fprintf(out, " %s ", Operators[instr->type]);
+				emit_operand(out, bc, kind2, instr->src2);
+				break;
+
+			case INSTRUCTION_PLS:
+			case INSTRUCTION_NEG:
+				emit_slot(out, bc, instr->dest);
+				fprintf(out, " = %s", Operators[instr->type]);
+				emit_operand(out, bc, kind1, instr->src1);
+				break;
+
+			case INSTRUCTION_GOTO:
+				fprintf(out, "goto L%u", instr->dest);
+				break;
+
+			case INSTRUCTION_BRANCH:
+				fprintf(out, "if(");
+				emit_operand(out, bc, kind1, instr->src1);
+				fprintf(out, ") goto L%u", instr->dest);
+				break;
+
+			default: // case INSTRUCTION_BEQ ... INSTRUCTION_BGTE:
+				fprintf(out, "if(");
+				emit_operand(out, bc, kind1, instr->src1);
+				fprintf(out, " %s ", Operators[instr->type]);
+				emit_operand(out, bc, kind2, instr->src2);
+				fprintf(out, ") goto L%u", instr->dest);
+				break;
+		}
+
+		fprintf(out, ";\n");
+	}
+
+	fprintf(out, "\treturn 0;\n}\n");
+
+	yfree(targets);
+}
+
+// write the local of a frame slot, the variables keep their identifiers
+void emit_slot(FILE *out, const struct bytecode *bc, uint32_t slot)
+{
+	if(slot < bc->vars_cnt)
+		fprintf(out, "v_%s", bc->names[slot]);
+	else
+		fprintf(out, "t%zu", slot - bc->vars_cnt);
+}
+
+void emit_operand(FILE *out, const struct bytecode *bc, enum operand_type kind, uint32_t index)
+{
+	if(kind != OPERAND_LITERAL)
+	{
+		emit_slot(out, bc, index);
+		return;
+	}
+
+	int64_t lit = bc->constants[index];
+
+	// the minimum value has no literal
+	if(lit == INT64_MIN)
+		fprintf(out, "(-INT64_MAX - 1)");
+	else if(lit < 0)
+		fprintf(out, "(INT64_C(%ld))", lit);
+	else
+		fprintf(out, "INT64_C(%ld)", lit);
+}
@@ -1,7 +1,7 @@
 
 #include "error.h"
 
-void print_expected_tokens(token_type_t types);
+void print_expected_tokens(FILE *out, token_type_t types);
 
 struct error *error_make_invalid_token(struct location loc, const char *text)
 {
@@ -78,32 +78,37 @@ bool error_list_empty(struct error_list errs)
 }
 
 void error_list_show(struct error_list errs)
+{
+	error_list_print(stdout, errs);
+}
+
+void error_list_print(FILE *out, struct error_list errs)
 {
 	size_t index = 1;
 	struct error *tmp = errs.head;
 
 	while(tmp != NULL)
 	{
-		printf("(%zu) %zu, %zu - ", index, tmp->loc.row, tmp->loc.col);
+		fprintf(out, "(%zu) %zu, %zu - ", index, tmp->loc.row, tmp->loc.col);
 
 		switch(tmp->type)
 		{
 			case ERROR_INVALID_TOKEN:
-				printf("invalid token \"%s\"\n", tmp->info.lexical.text);
+				fprintf(out, "invalid token \"%s\"\n", tmp->info.lexical.text);
 				break;
 
 			case ERROR_UNEXPECTED_TOKEN:
-				printf("expected token ");
-				print_expected_tokens(tmp->info.syntactic.expected);
-				printf("but found token \"%s\"\n", token_type_str(tmp->info.syntactic.actual));
+				fprintf(out, "expected token ");
+				print_expected_tokens(out, tmp->info.syntactic.expected);
+				fprintf(out, "but found token \"%s\"\n", token_type_str(tmp->info.syntactic.actual));
 				break;
 
 			case ERROR_UNDECLARED_VAR:
-				printf("undeclared variable \"%s\"\n", tmp->info.semantic.sym->id);
+				fprintf(out, "undeclared variable \"%s\"\n", tmp->info.semantic.sym->id);
 				break;
 
 			case ERROR_MULTIPLE_DECL:
-				printf("multiple declaration of \"%s\", first defined at %lu, %lu\n",
+				fprintf(out, "multiple declaration of \"%s\", first defined at %lu, %lu\n",
 					tmp->info.semantic.sym->id, tmp->info.semantic.first.row, tmp->info.semantic.first.col);
 				break;
 		}
@@ -127,7 +132,7 @@ void error_list_add(struct error_list *errs, struct error *new_err)
 	}
 }
 
-void print_expected_tokens(token_type_t types)
+void print_expected_tokens(FILE *out, token_type_t types)
 {
 	token_type_t mask = 1;
 
@@ -136,7 +141,7 @@ void print_expected_tokens(token_type_t types)
 		token_type_t type = types & mask;
 
 		if(type != 0)
-			printf("\"%s\" ", token_type_str(type));
+			fprintf(out, "\"%s\" ", token_type_str(type));
 	
 		mask <<= 1;
 	}
@@ -0,0 +1,324 @@
+
+// the file mapping is not part of the strict C99 environment
+#if defined(__unix__) || defined(__APPLE__)
+#define YOG_MMAP
+#define _POSIX_C_SOURCE 200809L
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#include "input.h"
+
+bool map_file(struct input *in);
+bool refill(struct input *in);
+bool is_space(char c);
+enum input_result read_binary(struct input *in, int64_t *value);
+
+bool input_is_terminal(FILE *file)
+{
+#ifdef YOG_MMAP
+	return file != NULL && fileno(file) >= 0 && isatty(fileno(file));
+#else
+	(void)file;
+	return false;
+#endif
+}
+
+void input_init(struct input *in)
+{
+	in->file = NULL;
+	in->interactive = false;
+	in->binary = false;
+	in->mapped = false;
+	in->eof = false;
+	in->data = NULL;
+	in->pos = 0;
+	in->size = 0;
+	in->capacity = INPUT_BUFFER_SIZE;
+}
+
+void input_bind(struct input *in, FILE *file, bool interactive)
+{
+	// the binary values are never read interactively
+	interactive = interactive && !in->binary;
+
+	if(in->file == file && in->interactive == interactive)
+		return;
+
+	input_unbind(in);
+
+	in->file = file;
+	in->interactive = interactive;
+	in->eof = false;
+	in->pos = 0;
+	in->size = 0;
+
+	// a regular file is mapped and parsed in place, the other streams are buffered
+	if(!interactive && !map_file(in))
+		in->data = ymalloc(in->capacity);
+}
+
+void input_unbind(struct input *in)
+{
+	if(in->file == NULL)
+		return;
+
+	if(in->mapped)
+	{
+#ifdef YOG_MMAP
+		munmap(in->data, in->size);
+#endif
+		fseek(in->file, (long)in->pos, SEEK_SET);
+	}
+	else if(!in->interactive)
+	{
+		// the buffered bytes not parsed are given back, if the stream can be positioned
+		if(in->size > in->pos)
+			fseek(in->file, -(long)(in->size - in->pos), SEEK_CUR);
+
+		yfree(in->data);
+	}
+
+	in->file = NULL;
+	in->mapped = false;
+	in->data = NULL;
+	in->pos = 0;
+	in->size = 0;
+}
+
+enum input_result input_int(struct input *in, int64_t *value)
+{
+	if(in->binary)
+		return read_binary(in, value);
+
+	if(in->interactive)
+	{
+		int64_t read;
+		int matched = fscanf(in->file, "%ld", &read);
+
+		if(matched == EOF)
+			return INPUT_END;
+
+		if(matched != 1)
+			return INPUT_INVALID;
+
+		*value = read;
+		return INPUT_VALUE;
+	}
+
+	while(true)
+	{
+		while(in->pos < in->size && is_space(in->data[in->pos]))
+			in->pos++;
+
+		if(in->pos == in->size)
+		{
+			if(refill(in))
+				continue;
+
+			return in->eof ? INPUT_END : INPUT_PENDING;
+		}
+
+		size_t end = in->pos;
+		while(end < in->size && !is_space(in->data[end]))
+			end++;
+
+		// the value may continue in the next chunk of the stream, which moves it to the beginning of the buffer
+		if(end == in->size)
+		{
+			if(refill(in))
+				continue;
+
+			// the value is parsed once its end has arrived, unless it fills the buffer
+			if(!in->eof && in->size - in->pos < in->capacity)
+				return INPUT_PENDING;
+
+			end = in->size;
+		}
+
+		enum input_result result = input_parse(in->data + in->pos, in->data + end, value);
+
+		if(result == INPUT_VALUE)
+			in->pos = end;
+
+		return result;
+	}
+}
+
+int64_t input_tell(struct input *in)
+{
+	if(in->mapped)
+		return (int64_t)in->pos;
+
+	long offset = ftell(in->file);
+
+	if(offset < 0 || in->interactive)
+		return offset;
+
+	return offset - (int64_t)(in->size - in->pos);
+}
+
+bool input_seek(struct input *in, int64_t offset)
+{
+	if(in->mapped)
+	{
+		if(offset < 0 || (uint64_t)offset > in->size)
+			return false;
+
+		in->pos = (size_t)offset;
+		return true;
+	}
+
+	if(fseek(in->file, (long)offset, SEEK_SET) != 0)
+		return false;
+
+	in->pos = 0;
+	in->size = 0;
+	in->eof = false;
+
+	return true;
+}
+
+void input_clear(struct input *in)
+{
+	input_unbind(in);
+}
+
+// map the whole file of the stream, the parsing starts at the position of the stream
+bool map_file(struct input *in)
+{
+#ifdef YOG_MMAP
+	int fd = fileno(in->file);
+	long offset = ftell(in->file);
+	struct stat st;
+
+	if(fd < 0 || offset < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0
+		|| (uint64_t)st.st_size > SIZE_MAX || offset > st.st_size)
+		return false;
+
+	void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(data == MAP_FAILED)
+		return false;
+
+	in->data = data;
+	in->size = (size_t)st.st_size;
+	in->pos = (size_t)offset;
+	in->mapped = true;
+	in->eof = true;
+
+	return true;
+#else
+	(void)in;
+	return false;
+#endif
+}
+
+// move the bytes not parsed to the beginning of the buffer and read the next chunk after them
+bool refill(struct input *in)
+{
+	if(in->eof || in->mapped)
+		return false;
+
+	size_t left = in->size - in->pos;
+
+	// a value longer than the buffer is not a value
+	if(left == in->capacity)
+		return false;
+
+	memmove(in->data, in->data + in->pos, left);
+	in->pos = 0;
+	in->size = left;
+
+	size_t cnt;
+	bool pending = false;
+
+#ifdef YOG_MMAP
+	// a read returns the bytes available, so a pipe or a terminal is parsed as its values arrive
+	if(fileno(in->file) >= 0)
+	{
+		ssize_t result;
+
+		do
+			result = read(fileno(in->file), in->data + left, in->capacity - left);
+		while(result < 0 && errno == EINTR);
+
+		// a non-blocking stream without bytes yet is not at its end
+		pending = result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+		cnt = result > 0 ? (size_t)result : 0;
+	}
+	else
+#endif
+	{
+		cnt = fread(in->data + left, 1, in->capacity - left, in->file);
+	}
+
+	in->size += cnt;
+
+	if(cnt == 0 && !pending)
+		in->eof = true;
+
+	return cnt > 0;
+}
+
+// read the 8 bytes of a little-endian value, which the compilers turn into a load on little-endian targets
+enum input_result read_binary(struct input *in, int64_t *value)
+{
+	while(in->size - in->pos < 8)
+	{
+		if(refill(in))
+			continue;
+
+		if(!in->eof)
+			return INPUT_PENDING;
+
+		return in->pos == in->size ? INPUT_END : INPUT_INVALID;
+	}
+
+	const unsigned char *bytes = (const unsigned char *)in->data + in->pos;
+	uint64_t n = 0;
+
+	for(int i = 7; i >= 0; i--)
+		n = n << 8 | bytes[i];
+
+	*value = (int64_t)n;
+	in->pos += 8;
+
+	return INPUT_VALUE;
+}
+
+bool is_space(char c)
+{
+	return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+enum input_result input_parse(const char *begin, const char *end, int64_t *value)
+{
+	const char *c = begin;
+	bool negative = c < end && *c == '-';
+
+	if(c < end && (*c == '-' || *c == '+'))
+		c++;
+
+	if(c == end)
+		return INPUT_INVALID;
+
+	const uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+	uint64_t n = 0;
+
+	for(; c < end; c++)
+	{
+		unsigned digit = (unsigned)(*c - '0');
+
+		if(digit > 9 || n > (limit - digit) / 10)
+			return INPUT_INVALID;
+
+		n = n * 10 + digit;
+	}
+
+	// the magnitude of the minimum value is not representable as int64_t
+	*value = negative ? (int64_t)(0 - n) : (int64_t)n;
+
+	return INPUT_VALUE;
+}
@@ -1,6 +1,31 @@
 
 #include "instruction.h"
 
+size_t instruction_src_cnt(enum instruction_type type)
+{
+	switch(type)
+	{
+		case INSTRUCTION_READ:
+		case INSTRUCTION_GOTO:
+			return 0;
+
+		case INSTRUCTION_ASSIGN:
+		case INSTRUCTION_WRITE:
+		case INSTRUCTION_PLS:
+		case INSTRUCTION_NEG:
+		case INSTRUCTION_BRANCH:
+			return 1;
+
+		default:
+			return 2;
+	}
+}
+
+bool instruction_has_dest(enum instruction_type type)
+{
+	return type != INSTRUCTION_WRITE;
+}
+
 void instruction_list_init(struct instruction_list *instrs)
 {
 	instrs->data = NULL;
@@ -1,61 +1,387 @@
 
+// the monotonic clock is not part of the strict C99 environment
+#define _POSIX_C_SOURCE 200809L
+#include <time.h>
+
 #include "interpreter.h"
+#include "peephole.h"
+#include "jit.h"
+#include "offload.h"
+
+// the cycles of the profiled instructions are measured with the time stamp counter if available
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define YOG_RDTSC
+#include <x86intrin.h>
+#endif
+
+// use the computed goto extension for the threaded dispatch if available
+#if defined(__GNUC__) && !defined(YOG_NO_COMPUTED_GOTO)
+#define YOG_COMPUTED_GOTO
+#endif
+
+typedef void (* function_t) (struct interpreter *vm, struct bytecode_instruction instr);
+
+void execute_assign(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_read(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_write(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_add(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_sub(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_mul(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_div(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_pls(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_neg(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_eq(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_neq(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_lt(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_lte(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_gt(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_gte(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_goto(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_branch(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_beq(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_bneq(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_blt(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_blte(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_bgt(struct interpreter *vm, struct bytecode_instruction instr);
+void execute_bgte(struct interpreter *vm, struct bytecode_instruction instr);
 
-typedef void (* function_t) (struct interpreter *vm, struct instruction instr);
-
-void execute_assign(struct interpreter *vm, struct instruction instr);
-void execute_read(struct interpreter *vm, struct instruction instr);
-void execute_write(struct interpreter *vm, struct instruction instr);
-void execute_add(struct interpreter *vm, struct instruction instr);
-void execute_sub(struct interpreter *vm, struct instruction instr);
-void execute_mul(struct interpreter *vm, struct instruction instr);
-void execute_div(struct interpreter *vm, struct instruction instr);
-void execute_pls(struct interpreter *vm, struct instruction instr);
-void execute_neg(struct interpreter *vm, struct instruction instr);
-void execute_eq(struct interpreter *vm, struct instruction instr);
-void execute_neq(struct interpreter *vm, struct instruction instr);
-void execute_lt(struct interpreter *vm, struct instruction instr);
-void execute_lte(struct interpreter *vm, struct instruction instr);
-void execute_gt(struct interpreter *vm, struct instruction instr);
-void execute_gte(struct interpreter *vm, struct instruction instr);
-void execute_goto(struct interpreter *vm, struct instruction instr);
-void execute_branch(struct interpreter *vm, struct instruction instr);
-
-int64_t operand_get_value(struct interpreter *vm, struct operand op)
-{
-	switch(op.type)
-	{
-		case OPERAND_TEMPORARY:
-			return vm->temporary[op.index];
-		
+void execute_dispatch(struct interpreter *vm);
+void execute_threaded(struct interpreter *vm, const void *const **labels);
+void execute_limited(struct interpreter *vm);
+void execute_counting(struct interpreter *vm, uint64_t *counts, uint64_t *cycles);
+void tier_up(struct interpreter *vm, size_t pc, const void *osr);
+void dispatch_alone(struct interpreter *vm, size_t pc, const void *handler, const void *const *labels);
+bool limits_reached(struct interpreter *vm, enum interpreter_status *status);
+double clock_seconds(void);
+uint64_t read_cycles(void);
+void runtime_error(struct interpreter *vm, size_t pc, enum interpreter_status status);
+
+// the labels of the tiered and of the limited execution follow the labels of the superinstructions
+#define LABEL_HOT (OPCODE_HALT + SUPERINSTRUCTION_CNT)
+#define LABEL_OSR (LABEL_HOT + 1)
+#define LABEL_METER (LABEL_HOT + 2)
+#define LABEL_INTERRUPT (LABEL_HOT + 3)
+
+// the number of retired instructions between two readings of the clock
+#define CLOCK_PERIOD 65536
+
+int64_t operand_get_value(struct interpreter *vm, enum operand_type type, uint32_t index)
+{
+	switch(type)
+	{
 		case OPERAND_LITERAL:
-			return op.lit;
+			return vm->bc->constants[index];
 
-		case OPERAND_SYMBOL:
-			return op.sym->value;
+		case OPERAND_LABEL:
+			return index;
 
-		default: // case OPERAND_LABEL:
-			return op.index;
+		default: // case OPERAND_TEMPORARY: case OPERAND_SYMBOL:
+			return vm->frame[index];
 	}
 }
 
-void interpreter_init(struct interpreter *vm, struct instruction_list instrs, size_t tmp_cnt)
+void interpreter_read(struct interpreter *vm, uint32_t slot, size_t pc)
 {
-	vm->temporary = ymalloc(tmp_cnt * sizeof(int64_t));
-	vm->instrs = instrs;
+	if(vm->read_callback != NULL)
+	{
+		if(!vm->read_callback(vm->callback_data, vm->bc->names[slot], &vm->frame[slot]))
+			runtime_error(vm, pc, INTERPRETER_END_OF_INPUT);
+
+		vm->reads++;
+		return;
+	}
+
+	enum input_result result;
+
+	if(vm->offload != NULL)
+	{
+		result = offload_read(vm->offload, &vm->frame[slot]);
+	}
+	else
+	{
+		// the prompts would be mixed into the binary values
+		input_bind(&vm->input, vm->in, vm->interactive && !vm->output.binary);
+
+		if(vm->input.interactive)
+		{
+			output_str(&vm->output, "enter the value of \"");
+			output_str(&vm->output, vm->bc->names[slot]);
+			output_str(&vm->output, "\": ");
+		}
+
+		// the buffered values are written before a read which may block
+		if(vm->output.flush_on_read)
+			output_flush(&vm->output);
+
+		result = input_int(&vm->input, &vm->frame[slot]);
+	}
+
+	switch(result)
+	{
+		case INPUT_END:
+			runtime_error(vm, pc, INTERPRETER_END_OF_INPUT);
+			break;
+
+		case INPUT_INVALID:
+			runtime_error(vm, pc, INTERPRETER_INVALID_INPUT);
+			break;
+
+		// the read is executed again when the execution is resumed
+		case INPUT_PENDING:
+			runtime_error(vm, pc, INTERPRETER_NEEDS_INPUT);
+			break;
+
+		default: // case INPUT_VALUE:
+			vm->reads++;
+			break;
+	}
+}
+
+void interpreter_write(struct interpreter *vm, int64_t value)
+{
+	if(vm->write_callback != NULL)
+	{
+		vm->write_callback(vm->callback_data, value);
+		return;
+	}
+
+	if(vm->offload != NULL)
+	{
+		offload_write(vm->offload, value);
+		return;
+	}
+
+	output_int(&vm->output, value);
+}
+
+void interpreter_init(struct interpreter *vm, const struct bytecode *bc, enum interpreter_dispatch dispatch)
+{
+	vm->frame = ycalloc(bc->vars_cnt + bc->tmp_cnt, sizeof(int64_t));
+	vm->bc = bc;
+	vm->dispatch = dispatch;
+	vm->code = NULL;
+	vm->jit = NULL;
+	vm->tier_threshold = INTERPRETER_TIER_THRESHOLD;
+	vm->tier_log = NULL;
+	vm->counters = NULL;
+	vm->entries = NULL;
+	vm->loops = NULL;
+	vm->loops_cnt = 0;
+	vm->fuel = UINT64_MAX;
+	vm->deadline = 0;
+	vm->clock_retired = 0;
+	vm->retired = 0;
+	vm->status = INTERPRETER_HALTED;
+	vm->interrupt_handler = NULL;
+	vm->interrupt_data = NULL;
+	vm->interrupt_pending = 0;
+	vm->in = stdin;
+	vm->out = stdout;
+	vm->interactive = true;
+	vm->reads = 0;
+	vm->offload = NULL;
+	output_init(&vm->output);
+	input_init(&vm->input);
+	vm->read_callback = NULL;
+	vm->write_callback = NULL;
+	vm->callback_data = NULL;
 	vm->pc = 0;
+
+	// translate the whole bytecode to native code, the interpreter only resumes it
+	// to report a division by zero
+	if(dispatch == DISPATCH_JIT && jit_supported())
+	{
+		vm->jit = ymalloc(sizeof(struct jit_code));
+		jit_compile(vm->jit, bc, 0, bc->size);
+	}
+
+#ifdef YOG_COMPUTED_GOTO
+	if(dispatch != DISPATCH_CALL)
+	{
+		const void *const *labels;
+		execute_threaded(vm, &labels);
+
+		// translate the instructions to their handler addresses, the last one halts the interpreter
+		vm->code = ymalloc((bc->size + 1) * sizeof(const void *));
+
+		for(size_t i = 0; i < bc->size; i++)
+		{
+			if(bc->code[i].super != SUPERINSTRUCTION_NONE)
+				vm->code[i] = labels[OPCODE_HALT + bc->code[i].super];
+			else
+				vm->code[i] = labels[bc->code[i].op];
+		}
+
+		vm->code[bc->size] = labels[OPCODE_HALT];
+
+		// the tiered execution counts the executions of the loop back-edges,
+		// i.e. the jumps to a previous instruction, which are dispatched on their own
+		if(dispatch == DISPATCH_TIERED && jit_supported())
+		{
+			vm->counters = ycalloc(bc->size, sizeof(uint64_t));
+			vm->entries = ycalloc(bc->size, sizeof(struct jit_code *));
+			vm->loops = ymalloc(bc->size * sizeof(struct jit_code *));
+
+			for(size_t i = 0; i < bc->size; i++)
+			{
+				if(opcode_is_jump(bc->code[i].op) && bc->code[i].dest <= i)
+					dispatch_alone(vm, i, labels[LABEL_HOT], labels);
+			}
+		}
+	}
+#endif
 }
 
 void interpreter_clear(struct interpreter *vm)
 {
-	yfree(vm->temporary);
-	vm->temporary = NULL;
+	output_clear(&vm->output);
+	input_clear(&vm->input);
+	yfree(vm->frame);
+	vm->frame = NULL;
+	yfree(vm->code);
+	vm->code = NULL;
+
+	if(vm->jit != NULL)
+	{
+		jit_clear(vm->jit);
+		yfree(vm->jit);
+		vm->jit = NULL;
+	}
+
+	for(size_t i = 0; i < vm->loops_cnt; i++)
+	{
+		jit_clear(vm->loops[i]);
+		yfree(vm->loops[i]);
+	}
+
+	yfree(vm->counters);
+	vm->counters = NULL;
+	yfree(vm->entries);
+	vm->entries = NULL;
+	yfree(vm->loops);
+	vm->loops = NULL;
+	vm->loops_cnt = 0;
+
 	vm->pc = 0;
 }
 
-void interpreter_execute(struct interpreter *vm)
+void interpreter_reset(struct interpreter *vm)
+{
+	memset(vm->frame, 0, (vm->bc->vars_cnt + vm->bc->tmp_cnt) * sizeof(int64_t));
+
+	// the streams may have been replaced, they are bound again by the next execution
+	output_unbind(&vm->output);
+	input_unbind(&vm->input);
+
+	vm->retired = 0;
+	vm->clock_retired = CLOCK_PERIOD;
+	vm->reads = 0;
+	vm->status = INTERPRETER_HALTED;
+	vm->pc = 0;
+}
+
+void interpreter_limit(struct interpreter *vm, uint64_t fuel, double seconds)
+{
+	yassert(vm->jit == NULL && vm->counters == NULL, "the native code cannot be limited");
+
+	vm->fuel = fuel;
+	vm->deadline = seconds > 0 ? clock_seconds() + seconds : 0;
+	vm->clock_retired = vm->retired + CLOCK_PERIOD;
+
+#ifdef YOG_COMPUTED_GOTO
+	// meter the threaded code at the jumps only
+	if(vm->code != NULL)
+	{
+		const void *const *labels;
+		execute_threaded(vm, &labels);
+
+		for(size_t i = 0; i < vm->bc->size; i++)
+		{
+			if(opcode_is_jump(vm->bc->code[i].op))
+				dispatch_alone(vm, i, labels[LABEL_METER], labels);
+		}
+	}
+#endif
+}
+
+void interpreter_set_interrupt_handler(struct interpreter *vm, void (*handler)(struct interpreter *vm), void *data, bool every)
+{
+	yassert(vm->jit == NULL && vm->counters == NULL, "the native code cannot be interrupted");
+
+	vm->interrupt_handler = handler;
+	vm->interrupt_data = data;
+
+#ifdef YOG_COMPUTED_GOTO
+	// the threaded code checks for the interrupts before each instruction or at its back-edges only,
+	// the metered jumps already check for them
+	if(vm->code != NULL)
+	{
+		const void *const *labels;
+		execute_threaded(vm, &labels);
+
+		for(size_t i = 0; i < vm->bc->size; i++)
+		{
+			bool back_edge = opcode_is_jump(vm->bc->code[i].op) && vm->bc->code[i].dest <= i;
+
+			if((every || back_edge) && vm->code[i] != labels[LABEL_METER])
+				dispatch_alone(vm, i, labels[LABEL_INTERRUPT], labels);
+		}
+	}
+#endif
+}
+
+void interpreter_interrupt(struct interpreter *vm)
 {
-	static const function_t Function_Table[17] =
+	if(vm->interrupt_handler != NULL)
+		vm->interrupt_pending = 1;
+}
+
+enum interpreter_status interpreter_execute(struct interpreter *vm)
+{
+	// the output is buffered during the execution and written at its end
+	output_bind(&vm->output, vm->out, vm->in);
+
+	execute_dispatch(vm);
+	output_flush(&vm->output);
+
+	// the values buffered by the scanner are kept for the resumed execution
+	if(!interpreter_resumable(vm->status))
+		input_unbind(&vm->input);
+
+	return vm->status;
+}
+
+bool interpreter_resumable(enum interpreter_status status)
+{
+	return status == INTERPRETER_FUEL_EXHAUSTED || status == INTERPRETER_DEADLINE_EXCEEDED || status == INTERPRETER_NEEDS_INPUT;
+}
+
+// execute the bytecode with the dispatch of the interpreter
+void execute_dispatch(struct interpreter *vm)
+{
+	vm->status = INTERPRETER_HALTED;
+
+	// the runtime errors leave the dispatch loops from their handlers
+	if(setjmp(vm->fault) != 0)
+		return;
+
+	if(vm->jit != NULL)
+		vm->pc = jit_execute(vm->jit, vm, vm->pc);
+
+	// the threaded code is metered at its jumps, the other dispatches are replaced by a metered loop
+	if(vm->code == NULL && (vm->fuel != UINT64_MAX || vm->deadline > 0))
+	{
+		execute_limited(vm);
+		return;
+	}
+
+	if(vm->dispatch != DISPATCH_CALL)
+	{
+		execute_threaded(vm, NULL);
+		return;
+	}
+
+	static const function_t Function_Table[23] =
 	{
 		execute_assign,
 		execute_read,
@@ -73,141 +399,669 @@ void interpreter_execute(struct interpreter *vm)
 		execute_gt,
 		execute_gte,
 		execute_goto,
-		execute_branch
+		execute_branch,
+		execute_beq,
+		execute_bneq,
+		execute_blt,
+		execute_blte,
+		execute_bgt,
+		execute_bgte
 	};
 
-	while(vm->pc < vm->instrs.size)
+	while(vm->pc < vm->bc->size)
 	{
 		// get the instruction pointed by the program counter
-		struct instruction instr = vm->instrs.data[vm->pc];
+		size_t pc = vm->pc;
+		struct bytecode_instruction instr = vm->bc->code[pc];
 
 		// execute the instruction
 		Function_Table[instr.type](vm, instr);
+
+		// the interrupts are handled before the next instruction
+		if(vm->interrupt_pending)
+		{
+			vm->interrupt_pending = 0;
+			vm->interrupt_handler(vm);
+		}
+	}
+}
+
+// force the inlining of the steps, which makes their operation a constant
+#if defined(__GNUC__)
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+#else
+#define ALWAYS_INLINE static inline
+#endif
+
+// the operand loads of the specialized operations
+#define LOAD_V(index) frame[index]
+#define LOAD_L(index) constants[index]
+
+#define ASSIGN_STEP(name, k) \
+	case OPCODE_ASSIGN_##k: \
+		frame[instr->dest] = LOAD_##k(instr->src1); \
+		return pc + 1;
+
+#define WRITE_STEP(name, k) \
+	case OPCODE_WRITE_##k: \
+		interpreter_write(vm, LOAD_##k(instr->src1)); \
+		return pc + 1;
+
+#define BINARY_STEP(name, op, k1, k2) \
+	case OPCODE_##name##_##k1##k2: \
+		frame[instr->dest] = LOAD_##k1(instr->src1) op LOAD_##k2(instr->src2); \
+		return pc + 1;
+
+#define DIV_STEP(name, k1, k2) \
+	case OPCODE_DIV_##k1##k2: \
+		right = LOAD_##k2(instr->src2); \
+		if(right == 0) \
+			runtime_error(vm, pc, INTERPRETER_DIVISION_BY_ZERO); \
+		frame[instr->dest] = LOAD_##k1(instr->src1) / right; \
+		return pc + 1;
+
+#define UNARY_STEP(name, op, k) \
+	case OPCODE_##name##_##k: \
+		frame[instr->dest] = op LOAD_##k(instr->src1); \
+		return pc + 1;
+
+#define BRANCH_STEP(name, op, k1, k2) \
+	case OPCODE_##name##_##k1##k2: \
+		return LOAD_##k1(instr->src1) op LOAD_##k2(instr->src2) ? instr->dest : pc + 1;
+
+#define BINARY_STEPS(name, op) OPCODE_KINDS_2(BINARY_STEP, name, op)
+#define BRANCH_STEPS(name, op) OPCODE_KINDS_2(BRANCH_STEP, name, op)
+#define UNARY_STEPS(name, op) OPCODE_KINDS_1(UNARY_STEP, name, op)
+
+// execute a specialized operation and return the next program counter,
+// the handlers pass a constant operation so that the switch is folded away
+ALWAYS_INLINE size_t step(enum opcode op, const struct bytecode_instruction *instr, size_t pc,
+	struct interpreter *vm, int64_t *frame, const int64_t *constants)
+{
+	int64_t right;
+
+	switch(op)
+	{
+		OPCODE_KINDS_1(ASSIGN_STEP, ASSIGN)
+
+		case OPCODE_READ:
+			interpreter_read(vm, instr->dest, pc);
+			return pc + 1;
+
+		OPCODE_KINDS_1(WRITE_STEP, WRITE)
+
+		OPCODE_BINARY_OPERATIONS(BINARY_STEPS)
+		OPCODE_KINDS_2(DIV_STEP, DIV)
+		OPCODE_UNARY_OPERATIONS(UNARY_STEPS)
+
+		case OPCODE_GOTO:
+			return instr->dest;
+
+		case OPCODE_BRANCH:
+			return frame[instr->src1] ? instr->dest : pc + 1;
+
+		OPCODE_BRANCH_OPERATIONS(BRANCH_STEPS)
+
+		default: // case OPCODE_HALT:
+			return pc;
+	}
+}
+
+#ifdef YOG_COMPUTED_GOTO
+#define HANDLER(opcode) handle_##opcode:
+#define DISPATCH() goto *code[pc]
+#define DISPATCH_BEGIN DISPATCH();
+#define DISPATCH_END
+#else
+#define HANDLER(opcode) case opcode:
+#define DISPATCH() goto dispatch
+#define DISPATCH_BEGIN dispatch: if(pc >= size) goto halt; if(vm->interrupt_pending) goto interrupt; switch(instrs[pc].op) {
+#define DISPATCH_END case OPCODE_HALT: break; }
+#endif
+
+#define STEP(opcode) pc = step(opcode, &instrs[pc], pc, vm, frame, constants)
+
+#define HANDLER_0(name) HANDLER(OPCODE_##name) STEP(OPCODE_##name); DISPATCH();
+#define HANDLER_1(name, k) HANDLER(OPCODE_##name##_##k) STEP(OPCODE_##name##_##k); DISPATCH();
+#define HANDLER_2(name, k1, k2) HANDLER(OPCODE_##name##_##k1##k2) STEP(OPCODE_##name##_##k1##k2); DISPATCH();
+
+#define LABEL_0(name) [OPCODE_##name] = &&handle_OPCODE_##name,
+#define LABEL_1(name, k) [OPCODE_##name##_##k] = &&handle_OPCODE_##name##_##k,
+#define LABEL_2(name, k1, k2) [OPCODE_##name##_##k1##k2] = &&handle_OPCODE_##name##_##k1##k2,
+
+// the superinstructions execute the steps of their operations one after the other,
+// their labels follow the labels of the operations
+#define SUPER_HANDLER_2(a, b) \
+	handle_SUPERINSTRUCTION_##a##__##b: \
+		STEP(OPCODE_##a); STEP(OPCODE_##b); DISPATCH();
+
+#define SUPER_HANDLER_3(a, b, c) \
+	handle_SUPERINSTRUCTION_##a##__##b##__##c: \
+		STEP(OPCODE_##a); STEP(OPCODE_##b); STEP(OPCODE_##c); DISPATCH();
+
+#define SUPER_LABEL_2(a, b) \
+	[OPCODE_HALT + SUPERINSTRUCTION_##a##__##b] = &&handle_SUPERINSTRUCTION_##a##__##b,
+
+#define SUPER_LABEL_3(a, b, c) \
+	[OPCODE_HALT + SUPERINSTRUCTION_##a##__##b##__##c] = &&handle_SUPERINSTRUCTION_##a##__##b##__##c,
+
+// the threaded interpreter executes the specialized operations keeping the program counter
+// and the frame in locals, if labels is not NULL it only returns the handler addresses,
+// the superinstructions are dispatched only with the computed goto
+void execute_threaded(struct interpreter *vm, const void *const **labels)
+{
+#ifdef YOG_COMPUTED_GOTO
+	static const void *const Label_Table[LABEL_INTERRUPT + 1] =
+	{
+		OPCODE_LIST(LABEL_0, LABEL_1, LABEL_2)
+		[OPCODE_HALT] = &&halt,
+		SUPERINSTRUCTION_PAIRS(SUPER_LABEL_2)
+		SUPERINSTRUCTION_TRIPLES(SUPER_LABEL_3)
+		[LABEL_HOT] = &&hot,
+		[LABEL_OSR] = &&osr,
+		[LABEL_METER] = &&meter,
+		[LABEL_INTERRUPT] = &&interrupt
+	};
+
+	if(labels != NULL)
+	{
+		*labels = Label_Table;
+		return;
+	}
+
+	const void *const *code = vm->code;
+#else
+	(void)labels;
+
+	const size_t size = vm->bc->size;
+#endif
+
+	const struct bytecode_instruction *instrs = vm->bc->code;
+	const int64_t *constants = vm->bc->constants;
+	int64_t *frame = vm->frame;
+	size_t pc = vm->pc;
+
+	// the first instruction of the block executing since the last metered jump
+	size_t block = pc;
+
+	DISPATCH_BEGIN
+
+	OPCODE_LIST(HANDLER_0, HANDLER_1, HANDLER_2)
+
+#ifdef YOG_COMPUTED_GOTO
+	SUPERINSTRUCTION_PAIRS(SUPER_HANDLER_2)
+	SUPERINSTRUCTION_TRIPLES(SUPER_HANDLER_3)
+
+	// count the executions of a loop back-edge and compile the loop once it is hot
+hot:
+	if(++vm->counters[pc] < vm->tier_threshold)
+		goto *Label_Table[instrs[pc].op];
+
+	tier_up(vm, pc, Label_Table[LABEL_OSR]);
+	DISPATCH();
+
+	// transfer the frame to the native code of a compiled loop, which returns where it left the loop,
+	// it leaves the loop where it entered only before a division by zero, which the interpreter reports
+osr:
+	{
+		size_t exit = jit_execute(vm->entries[pc], vm, pc);
+
+		if(exit == pc)
+			goto *Label_Table[instrs[pc].op];
+
+		pc = exit;
+	}
+
+	DISPATCH();
+
+	// charge the instructions of the block ending with a jump and stop once a limit is reached,
+	// after the jump so that the execution can be resumed, the interrupts are handled before the jump
+meter:
+	if(vm->interrupt_pending)
+	{
+		vm->interrupt_pending = 0;
+		vm->pc = pc;
+		vm->interrupt_handler(vm);
+	}
+
+	{
+		size_t next = step(instrs[pc].op, &instrs[pc], pc, vm, frame, constants);
+
+		vm->retired += pc + 1 - block;
+		block = pc = next;
+
+		if(limits_reached(vm, &vm->status))
+		{
+			vm->pc = pc;
+			return;
+		}
+	}
+
+	DISPATCH();
+#endif
+
+	DISPATCH_END
+
+halt:
+	vm->retired += pc - block;
+	vm->pc = pc;
+	return;
+
+	// handle a pending interrupt before the instruction, any instruction or a back-edge of the threaded code
+interrupt:
+	if(vm->interrupt_pending)
+	{
+		vm->interrupt_pending = 0;
+		vm->pc = pc;
+		vm->interrupt_handler(vm);
+	}
+
+#ifdef YOG_COMPUTED_GOTO
+	goto *Label_Table[instrs[pc].op];
+#else
+	DISPATCH();
+#endif
+}
+
+// execute the bytecode charging the blocks at the jumps, when the threaded code is not available
+void execute_limited(struct interpreter *vm)
+{
+	const struct bytecode_instruction *instrs = vm->bc->code;
+	const int64_t *constants = vm->bc->constants;
+	int64_t *frame = vm->frame;
+	const size_t size = vm->bc->size;
+	size_t pc = vm->pc;
+	size_t block = pc;
+
+	while(pc < size)
+	{
+		enum opcode op = instrs[pc].op;
+		size_t next = step(op, &instrs[pc], pc, vm, frame, constants);
+
+		if(opcode_is_jump(op))
+		{
+			vm->retired += pc + 1 - block;
+			block = next;
+
+			if(limits_reached(vm, &vm->status))
+			{
+				vm->pc = next;
+				return;
+			}
+		}
+
+		// the interrupts are handled before the next instruction
+		if(vm->interrupt_pending)
+		{
+			vm->interrupt_pending = 0;
+			vm->pc = next;
+			vm->interrupt_handler(vm);
+		}
+
+		pc = next;
+	}
+
+	vm->retired += pc - block;
+	vm->pc = pc;
+}
+
+// check the limits of the execution, the clock is read once every CLOCK_PERIOD retired instructions
+bool limits_reached(struct interpreter *vm, enum interpreter_status *status)
+{
+	if(vm->retired >= vm->fuel)
+	{
+		*status = INTERPRETER_FUEL_EXHAUSTED;
+		return true;
+	}
+
+	if(vm->deadline > 0 && vm->retired >= vm->clock_retired)
+	{
+		vm->clock_retired = vm->retired + CLOCK_PERIOD;
+
+		if(clock_seconds() >= vm->deadline)
+		{
+			*status = INTERPRETER_DEADLINE_EXCEEDED;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+double clock_seconds(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// dispatch an instruction through a handler, splitting the superinstructions ending with it
+void dispatch_alone(struct interpreter *vm, size_t pc, const void *handler, const void *const *labels)
+{
+	vm->code[pc] = handler;
+
+	for(size_t j = pc >= 2 ? pc - 2 : 0; j < pc; j++)
+	{
+		if(j + superinstruction_length(vm->bc->code[j].super) > pc)
+			vm->code[j] = labels[vm->bc->code[j].op];
+	}
+
+}
+
+// compile the loop of a hot back-edge and enter its native code at the back-edge and at the loop start
+void tier_up(struct interpreter *vm, size_t pc, const void *osr)
+{
+	size_t start = vm->bc->code[pc].dest;
+
+	struct jit_code *loop = ymalloc(sizeof(struct jit_code));
+	jit_compile(loop, vm->bc, start, pc + 1);
+	vm->loops[vm->loops_cnt++] = loop;
+
+	vm->entries[start] = loop;
+	vm->entries[pc] = loop;
+	vm->code[start] = osr;
+	vm->code[pc] = osr;
+
+	if(vm->tier_log != NULL)
+	{
+		fprintf(vm->tier_log, "tier-up: loop [%zu, %zu] after %llu back-edges, %zu bytes of native code\n",
+			start, pc, (unsigned long long)vm->counters[pc], loop->size);
 	}
 }
 
-void execute_assign(struct interpreter *vm, struct instruction instr)
+void interpreter_execute_counting(struct interpreter *vm, uint64_t *counts, uint64_t *cycles)
+{
+	vm->status = INTERPRETER_HALTED;
+
+	output_bind(&vm->output, vm->out, vm->in);
+
+	// the counting loop keeps its program counter in a local, so it is called after the setjmp, which does not clobber it
+	if(setjmp(vm->fault) == 0)
+		execute_counting(vm, counts, cycles);
+
+	output_flush(&vm->output);
+
+	if(!interpreter_resumable(vm->status))
+		input_unbind(&vm->input);
+}
+
+// execute the bytecode counting the executions and the cycles of each instruction, charging the blocks at the jumps as execute_limited does
+void execute_counting(struct interpreter *vm, uint64_t *counts, uint64_t *cycles)
+{
+	const struct bytecode_instruction *instrs = vm->bc->code;
+	const int64_t *constants = vm->bc->constants;
+	int64_t *frame = vm->frame;
+	const size_t size = vm->bc->size;
+	size_t pc = vm->pc;
+	size_t block = pc;
+
+	if(cycles == NULL)
+	{
+		while(pc < size)
+		{
+			size_t current = pc;
+			enum opcode op = instrs[pc].op;
+
+			counts[pc]++;
+			pc = step(op, &instrs[pc], pc, vm, frame, constants);
+
+			if(opcode_is_jump(op))
+			{
+				vm->retired += current + 1 - block;
+				block = pc;
+
+				if(limits_reached(vm, &vm->status))
+				{
+					vm->pc = pc;
+					return;
+				}
+			}
+
+			// the interrupts are handled before the next instruction
+			if(vm->interrupt_pending)
+			{
+				vm->interrupt_pending = 0;
+				vm->pc = pc;
+				vm->interrupt_handler(vm);
+			}
+		}
+	}
+	else
+	{
+		uint64_t last = read_cycles();
+
+		while(pc < size)
+		{
+			size_t current = pc;
+			enum opcode op = instrs[pc].op;
+
+			counts[pc]++;
+			pc = step(op, &instrs[pc], pc, vm, frame, constants);
+
+			uint64_t now = read_cycles();
+			cycles[current] += now - last;
+			last = now;
+
+			if(opcode_is_jump(op))
+			{
+				vm->retired += current + 1 - block;
+				block = pc;
+
+				if(limits_reached(vm, &vm->status))
+				{
+					vm->pc = pc;
+					return;
+				}
+			}
+		}
+	}
+
+	vm->retired += pc - block;
+	vm->pc = pc;
+}
+
+// stop the execution at a runtime error, the native code leaves the divisions by zero to the interpreter
+void runtime_error(struct interpreter *vm, size_t pc, enum interpreter_status status)
+{
+	vm->status = status;
+	vm->pc = pc;
+	longjmp(vm->fault, 1);
+}
+
+// read the time stamp counter, or the monotonic clock in nanoseconds where not available
+uint64_t read_cycles(void)
 {
-	instr.dest.sym->value = operand_get_value(vm, instr.src1);
+#ifdef YOG_RDTSC
+	return __rdtsc();
+#else
+	return (uint64_t)(clock_seconds() * 1e9);
+#endif
+}
+
+void execute_assign(struct interpreter *vm, struct bytecode_instruction instr)
+{
+	vm->frame[instr.dest] = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
 	vm->pc++;
 }
 
-void execute_read(struct interpreter *vm, struct instruction instr)
+void execute_read(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	printf("enter the value of \"%s\": ", instr.dest.sym->id);
-	scanf("%ld", &instr.dest.sym->value);
+	interpreter_read(vm, instr.dest, vm->pc);
 	vm->pc++;
 }
 
-void execute_write(struct interpreter *vm, struct instruction instr)
+void execute_write(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	printf("%ld\n", operand_get_value(vm, instr.src1));
+	interpreter_write(vm, operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1));
 	vm->pc++;
 }
 
-void execute_add(struct interpreter *vm, struct instruction instr)
+void execute_add(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	int64_t left  = operand_get_value(vm, instr.src1);
-	int64_t right = operand_get_value(vm, instr.src2);
-	vm->temporary[instr.dest.index] = left + right;
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	vm->frame[instr.dest] = left + right;
 	vm->pc++;
 }
 
-void execute_sub(struct interpreter *vm, struct instruction instr)
+void execute_sub(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	int64_t left  = operand_get_value(vm, instr.src1);
-	int64_t right = operand_get_value(vm, instr.src2);
-	vm->temporary[instr.dest.index] = left - right;
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	vm->frame[instr.dest] = left - right;
 	vm->pc++;
 }
 
-void execute_mul(struct interpreter *vm, struct instruction instr)
+void execute_mul(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	int64_t left  = operand_get_value(vm, instr.src1);
-	int64_t right = operand_get_value(vm, instr.src2);
-	vm->temporary[instr.dest.index] = left * right;
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	vm->frame[instr.dest] = left * right;
 	vm->pc++;
 }
 
-void execute_div(struct interpreter *vm, struct instruction instr)
+void execute_div(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	int64_t left  = operand_get_value(vm, instr.src1);
-	int64_t right = operand_get_value(vm, instr.src2);
-	yassert(right != 0, "division by zero");
-	vm->temporary[instr.dest.index] = left / right;
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	if(right == 0)
+		runtime_error(vm, vm->pc, INTERPRETER_DIVISION_BY_ZERO);
+
+	vm->frame[instr.dest] = left / right;
 	vm->pc++;
 }
 
-void execute_pls(struct interpreter *vm, struct instruction instr)
+void execute_pls(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	vm->temporary[instr.dest.index] = +operand_get_value(vm, instr.src1);
+	vm->frame[instr.dest] = +operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
 	vm->pc++;
 }
 
-void execute_neg(struct interpreter *vm, struct instruction instr)
+void execute_neg(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	vm->temporary[instr.dest.index] = -operand_get_value(vm, instr.src1);
+	vm->frame[instr.dest] = -operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
 	vm->pc++;
 }
 
-void execute_eq(struct interpreter *vm, struct instruction instr)
+void execute_eq(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	int64_t left  = operand_get_value(vm, instr.src1);
-	int64_t right = operand_get_value(vm, instr.src2);
-	vm->temporary[instr.dest.index] = left == right;
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	vm->frame[instr.dest] = left == right;
 	vm->pc++;
 }
 
-void execute_neq(struct interpreter *vm, struct instruction instr)
+void execute_neq(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	int64_t left  = operand_get_value(vm, instr.src1);
-	int64_t right = operand_get_value(vm, instr.src2);
-	vm->temporary[instr.dest.index] = left != right;
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	vm->frame[instr.dest] = left != right;
 	vm->pc++;
 }
 
-void execute_lt(struct interpreter *vm, struct instruction instr)
+void execute_lt(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	int64_t left  = operand_get_value(vm, instr.src1);
-	int64_t right = operand_get_value(vm, instr.src2);
-	vm->temporary[instr.dest.index] = left < right;
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	vm->frame[instr.dest] = left < right;
 	vm->pc++;
 }
 
-void execute_lte(struct interpreter *vm, struct instruction instr)
+void execute_lte(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	int64_t left  = operand_get_value(vm, instr.src1);
-	int64_t right = operand_get_value(vm, instr.src2);
-	vm->temporary[instr.dest.index] = left <= right;
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	vm->frame[instr.dest] = left <= right;
 	vm->pc++;
 }
 
-void execute_gt(struct interpreter *vm, struct instruction instr)
+void execute_gt(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	int64_t left  = operand_get_value(vm, instr.src1);
-	int64_t right = operand_get_value(vm, instr.src2);
-	vm->temporary[instr.dest.index] = left > right;
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	vm->frame[instr.dest] = left > right;
 	vm->pc++;
 }
 
-void execute_gte(struct interpreter *vm, struct instruction instr)
+void execute_gte(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	int64_t left  = operand_get_value(vm, instr.src1);
-	int64_t right = operand_get_value(vm, instr.src2);
-	vm->temporary[instr.dest.index] = left >= right;
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	vm->frame[instr.dest] = left >= right;
 	vm->pc++;
 }
 
-void execute_goto(struct interpreter *vm, struct instruction instr)
+void execute_goto(struct interpreter *vm, struct bytecode_instruction instr)
+{
+	vm->pc = instr.dest;
+}
+
+void execute_branch(struct interpreter *vm, struct bytecode_instruction instr)
+{
+	if(vm->frame[instr.src1])
+		vm->pc = instr.dest;
+	else
+		vm->pc++;
+}
+
+
+void execute_beq(struct interpreter *vm, struct bytecode_instruction instr)
+{
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	if(left == right)
+		vm->pc = instr.dest;
+	else
+		vm->pc++;
+}
+
+void execute_bneq(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	vm->pc = instr.dest.index;
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	if(left != right)
+		vm->pc = instr.dest;
+	else
+		vm->pc++;
 }
 
-void execute_branch(struct interpreter *vm, struct instruction instr)
+void execute_blt(struct interpreter *vm, struct bytecode_instruction instr)
 {
-	if(vm->temporary[instr.src1.index])
-		vm->pc = instr.dest.index;
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	if(left < right)
+		vm->pc = instr.dest;
 	else
 		vm->pc++;
 }
 
+void execute_blte(struct interpreter *vm, struct bytecode_instruction instr)
+{
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	if(left <= right)
+		vm->pc = instr.dest;
+	else
+		vm->pc++;
+}
+
+void execute_bgt(struct interpreter *vm, struct bytecode_instruction instr)
+{
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	if(left > right)
+		vm->pc = instr.dest;
+	else
+		vm->pc++;
+}
+
+void execute_bgte(struct interpreter *vm, struct bytecode_instruction instr)
+{
+	int64_t left  = operand_get_value(vm, BYTECODE_KIND_SRC1(instr.kinds), instr.src1);
+	int64_t right = operand_get_value(vm, BYTECODE_KIND_SRC2(instr.kinds), instr.src2);
+	if(left >= right)
+		vm->pc = instr.dest;
+	else
+		vm->pc++;
+}
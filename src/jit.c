@@ -0,0 +1,355 @@
+
+// the anonymous mappings are not part of the strict C99 environment
+#if defined(__x86_64__) && !defined(_WIN32)
+#define YOG_JIT
+#define _DEFAULT_SOURCE
+#include <sys/mman.h>
+#endif
+
+#include "jit.h"
+
+// the signature of the native code, it returns the index of the instruction where it left the region
+typedef size_t (* native_t) (struct interpreter *vm, int64_t *frame, const void *entry);
+
+// the growable buffer where the native code is assembled
+struct assembler
+{
+	uint8_t *data;
+	size_t size;
+	size_t capacity;
+};
+
+// a jump whose 32-bit displacement is patched once the offsets are known
+struct patch
+{
+	size_t pos;
+	size_t target;
+};
+
+// the condition codes of the comparisons, indexed from EQ to GTE
+static const uint8_t Condition_Codes[6] = { 0x4, 0x5, 0xc, 0xe, 0xf, 0xd };
+
+void emit(struct assembler *as, const uint8_t *bytes, size_t cnt);
+void emit_u8(struct assembler *as, uint8_t byte);
+void emit_u32(struct assembler *as, uint32_t value);
+void emit_u64(struct assembler *as, uint64_t value);
+void emit_load(struct assembler *as, const struct bytecode *bc, uint8_t reg, enum operand_type kind, uint32_t index);
+void emit_store(struct assembler *as, uint32_t slot);
+void emit_call(struct assembler *as, const void *function);
+size_t emit_jump(struct assembler *as, uint8_t condition);
+
+bool jit_supported(void)
+{
+#ifdef YOG_JIT
+	return true;
+#else
+	return false;
+#endif
+}
+
+void jit_compile(struct jit_code *jit, const struct bytecode *bc, size_t start, size_t end)
+{
+	yassert(jit_supported(), "native code generation not supported");
+	yassert(start <= end && end <= bc->size, "invalid region");
+
+	struct assembler as = { NULL, 0, 0 };
+
+	struct patch *patches = ymalloc(2 * (end - start + 1) * sizeof(struct patch));
+	size_t patches_cnt = 0;
+
+	jit->offsets = ymalloc((end - start + 1) * sizeof(uint32_t));
+	jit->start = start;
+	jit->end = end;
+
+	// prologue: save the callee-saved registers, keep the interpreter in r12
+	// and the frame in rbx, then jump to the entry instruction
+	emit(&as, (const uint8_t[]){ 0x53, 0x41, 0x54, 0x55 }, 4);       // push rbx; push r12; push rbp
+	emit(&as, (const uint8_t[]){ 0x49, 0x89, 0xfc }, 3);             // mov r12, rdi
+	emit(&as, (const uint8_t[]){ 0x48, 0x89, 0xf3 }, 3);             // mov rbx, rsi
+	emit(&as, (const uint8_t[]){ 0xff, 0xe2 }, 2);                   // jmp rdx
+
+	for(size_t pc = start; pc < end; pc++)
+	{
+		const struct bytecode_instruction *instr = &bc->code[pc];
+		enum operand_type kind1 = BYTECODE_KIND_SRC1(instr->kinds);
+		enum operand_type kind2 = BYTECODE_KIND_SRC2(instr->kinds);
+
+		jit->offsets[pc - start] = (uint32_t)as.size;
+
+		switch(instr->type)
+		{
+			case INSTRUCTION_ASSIGN:
+			case INSTRUCTION_PLS:
+				emit_load(&as, bc, 0, kind1, instr->src1);
+				emit_store(&as, instr->dest);
+				break;
+
+			case INSTRUCTION_NEG:
+				emit_load(&as, bc, 0, kind1, instr->src1);
+				emit(&as, (const uint8_t[]){ 0x48, 0xf7, 0xd8 }, 3); // neg rax
+				emit_store(&as, instr->dest);
+				break;
+
+			case INSTRUCTION_READ:
+				emit(&as, (const uint8_t[]){ 0x4c, 0x89, 0xe7 }, 3); // mov rdi, r12
+				emit_u8(&as, 0xbe);                                  // mov esi, slot
+				emit_u32(&as, instr->dest);
+				emit_u8(&as, 0xba);                                  // mov edx, pc
+				emit_u32(&as, (uint32_t)pc);
+				emit_call(&as, (const void *)interpreter_read);
+				break;
+
+			case INSTRUCTION_WRITE:
+				emit_load(&as, bc, 0, kind1, instr->src1);
+				emit(&as, (const uint8_t[]){ 0x48, 0x89, 0xc6 }, 3); // mov rsi, rax
+				emit(&as, (const uint8_t[]){ 0x4c, 0x89, 0xe7 }, 3); // mov rdi, r12
+				emit_call(&as, (const void *)interpreter_write);
+				break;
+
+			case INSTRUCTION_ADD:
+			case INSTRUCTION_SUB:
+			case INSTRUCTION_MUL:
+				emit_load(&as, bc, 0, kind1, instr->src1);
+				emit_load(&as, bc, 1, kind2, instr->src2);
+
+				if(instr->type == INSTRUCTION_ADD)
+					emit(&as, (const uint8_t[]){ 0x48, 0x01, 0xc8 }, 3);       // add rax, rcx
+				else if(instr->type == INSTRUCTION_SUB)
+					emit(&as, (const uint8_t[]){ 0x48, 0x29, 0xc8 }, 3);       // sub rax, rcx
+				else
+					emit(&as, (const uint8_t[]){ 0x48, 0x0f, 0xaf, 0xc1 }, 4); // imul rax, rcx
+
+				emit_store(&as, instr->dest);
+				break;
+
+			case INSTRUCTION_DIV:
+				emit_load(&as, bc, 0, kind1, instr->src1);
+				emit_load(&as, bc, 1, kind2, instr->src2);
+
+				// leave the division by zero to the interpreter
+				emit(&as, (const uint8_t[]){ 0x48, 0x85, 0xc9 }, 3);       // test rcx, rcx
+				patches[patches_cnt].pos = emit_jump(&as, 0x4);            // jz exit
+				patches[patches_cnt++].target = end + 1 + pc;
+
+				emit(&as, (const uint8_t[]){ 0x48, 0x99 }, 2);             // cqo
+				emit(&as, (const uint8_t[]){ 0x48, 0xf7, 0xf9 }, 3);       // idiv rcx
+				emit_store(&as, instr->dest);
+				break;
+
+			case INSTRUCTION_EQ:
+			case INSTRUCTION_NEQ:
+			case INSTRUCTION_LT:
+			case INSTRUCTION_LTE:
+			case INSTRUCTION_GT:
+			case INSTRUCTION_GTE:
+				emit_load(&as, bc, 0, kind1, instr->src1);
+				emit_load(&as, bc, 1, kind2, instr->src2);
+				emit(&as, (const uint8_t[]){ 0x48, 0x39, 0xc8 }, 3);       // cmp rax, rcx
+				emit(&as, (const uint8_t[]){ 0x0f, 0x90 | Condition_Codes[instr->type - INSTRUCTION_EQ], 0xc0 }, 3); // setcc al
+				emit(&as, (const uint8_t[]){ 0x0f, 0xb6, 0xc0 }, 3);       // movzx eax, al
+				emit_store(&as, instr->dest);
+				break;
+
+			case INSTRUCTION_GOTO:
+				patches[patches_cnt].pos = emit_jump(&as, 0);
+				patches[patches_cnt++].target = instr->dest;
+				break;
+
+			case INSTRUCTION_BRANCH:
+				emit_load(&as, bc, 0, kind1, instr->src1);
+				emit(&as, (const uint8_t[]){ 0x48, 0x85, 0xc0 }, 3);       // test rax, rax
+				patches[patches_cnt].pos = emit_jump(&as, 0x5);            // jnz
+				patches[patches_cnt++].target = instr->dest;
+				break;
+
+			default: // case INSTRUCTION_BEQ ... INSTRUCTION_BGTE:
+				emit_load(&as, bc, 0, kind1, instr->src1);
+				emit_load(&as, bc, 1, kind2, instr->src2);
+				emit(&as, (const uint8_t[]){ 0x48, 0x39, 0xc8 }, 3);       // cmp rax, rcx
+				patches[patches_cnt].pos = emit_jump(&as, Condition_Codes[instr->type - INSTRUCTION_BEQ]);
+				patches[patches_cnt++].target = instr->dest;
+				break;
+		}
+	}
+
+	// the end of the region: return the index of the following instruction
+	jit->offsets[end - start] = (uint32_t)as.size;
+	emit_u8(&as, 0xb8);                                              // mov eax, end
+	emit_u32(&as, (uint32_t)end);
+
+	size_t epilogue = as.size;
+	emit(&as, (const uint8_t[]){ 0x5d, 0x41, 0x5c, 0x5b, 0xc3 }, 5); // pop rbp; pop r12; pop rbx; ret
+
+	// resolve the jumps, a jump outside of the region returns its target through an exit stub,
+	// the targets beyond end mark the exits before a division by zero
+	for(size_t i = 0; i < patches_cnt; i++)
+	{
+		size_t target = patches[i].target;
+		size_t dest;
+
+		if(target >= start && target <= end)
+		{
+			dest = jit->offsets[target - start];
+		}
+		else
+		{
+			dest = as.size;
+			emit_u8(&as, 0xb8);                                      // mov eax, target
+			emit_u32(&as, (uint32_t)(target > end ? target - end - 1 : target));
+			emit_u8(&as, 0xe9);                                      // jmp epilogue
+			emit_u32(&as, (uint32_t)(epilogue - (as.size + 4)));
+		}
+
+		uint32_t displacement = (uint32_t)(dest - (patches[i].pos + 4));
+		memcpy(&as.data[patches[i].pos], &displacement, 4);
+	}
+
+	yfree(patches);
+
+#ifdef YOG_JIT
+	// move the native code to an executable mapping
+	size_t page = 4096;
+	jit->capacity = (as.size + page - 1) / page * page;
+	jit->buffer = mmap(NULL, jit->capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	yassert(jit->buffer != MAP_FAILED, "executable memory allocation failed");
+
+	memcpy(jit->buffer, as.data, as.size);
+	yassert(mprotect(jit->buffer, jit->capacity, PROT_READ | PROT_EXEC) == 0, "executable memory protection failed");
+#endif
+
+	jit->size = as.size;
+
+	yfree(as.data);
+}
+
+void jit_clear(struct jit_code *jit)
+{
+#ifdef YOG_JIT
+	if(jit->buffer != NULL)
+		munmap(jit->buffer, jit->capacity);
+#endif
+
+	jit->buffer = NULL;
+	jit->size = 0;
+	jit->capacity = 0;
+	yfree(jit->offsets);
+	jit->offsets = NULL;
+}
+
+size_t jit_execute(const struct jit_code *jit, struct interpreter *vm, size_t pc)
+{
+	yassert(pc >= jit->start && pc <= jit->end, "entry outside of the region");
+
+	native_t native;
+	void *entry = jit->buffer;
+
+	// object pointers are converted to function pointers through memcpy, as POSIX allows
+	memcpy(&native, &entry, sizeof(native));
+
+	return native(vm, vm->frame, jit->buffer + jit->offsets[pc - jit->start]);
+}
+
+bool jit_dump(const struct jit_code *jit, const char *filename)
+{
+	FILE *out = fopen(filename, "wb");
+	if(!out)
+		return false;
+
+	bool written = fwrite(jit->buffer, 1, jit->size, out) == jit->size;
+	fclose(out);
+
+	return written;
+}
+
+void emit(struct assembler *as, const uint8_t *bytes, size_t cnt)
+{
+	// enlarge the buffer capacity if necessary
+	if(as->size + cnt > as->capacity)
+	{
+		as->capacity = 2 * as->capacity + cnt + 256;
+		as->data = yrealloc(as->data, as->capacity);
+	}
+
+	memcpy(&as->data[as->size], bytes, cnt);
+	as->size += cnt;
+}
+
+void emit_u8(struct assembler *as, uint8_t byte)
+{
+	emit(as, &byte, 1);
+}
+
+void emit_u32(struct assembler *as, uint32_t value)
+{
+	uint8_t bytes[4];
+
+	// little endian encoding
+	for(size_t i = 0; i < 4; i++)
+		bytes[i] = (uint8_t)(value >> (8 * i));
+
+	emit(as, bytes, 4);
+}
+
+void emit_u64(struct assembler *as, uint64_t value)
+{
+	emit_u32(as, (uint32_t)value);
+	emit_u32(as, (uint32_t)(value >> 32));
+}
+
+// load an operand to rax (reg 0) or rcx (reg 1)
+void emit_load(struct assembler *as, const struct bytecode *bc, uint8_t reg, enum operand_type kind, uint32_t index)
+{
+	if(kind == OPERAND_LITERAL)
+	{
+		int64_t lit = bc->constants[index];
+
+		if(lit >= INT32_MIN && lit <= INT32_MAX)
+		{
+			emit(as, (const uint8_t[]){ 0x48, 0xc7, 0xc0 | reg }, 3); // mov reg, simm32
+			emit_u32(as, (uint32_t)lit);
+		}
+		else
+		{
+			emit(as, (const uint8_t[]){ 0x48, 0xb8 | reg }, 2);       // mov reg, imm64
+			emit_u64(as, (uint64_t)lit);
+		}
+	}
+	else
+	{
+		yassert(index < (UINT32_MAX >> 3), "frame too large for the native code");
+
+		emit(as, (const uint8_t[]){ 0x48, 0x8b, 0x83 | reg << 3 }, 3); // mov reg, [rbx + disp32]
+		emit_u32(as, index * 8);
+	}
+}
+
+// store rax to a frame slot
+void emit_store(struct assembler *as, uint32_t slot)
+{
+	yassert(slot < (UINT32_MAX >> 3), "frame too large for the native code");
+
+	emit(as, (const uint8_t[]){ 0x48, 0x89, 0x83 }, 3);               // mov [rbx + disp32], rax
+	emit_u32(as, slot * 8);
+}
+
+// call a function through rax, the stack is aligned by the prologue
+void emit_call(struct assembler *as, const void *function)
+{
+	emit(as, (const uint8_t[]){ 0x48, 0xb8 }, 2);                     // mov rax, imm64
+	emit_u64(as, (uint64_t)(uintptr_t)function);
+	emit(as, (const uint8_t[]){ 0xff, 0xd0 }, 2);                     // call rax
+}
+
+// emit a jump (condition 0) or a conditional jump with a displacement to patch,
+// and return the position of the displacement
+size_t emit_jump(struct assembler *as, uint8_t condition)
+{
+	if(condition == 0)
+		emit_u8(as, 0xe9);                                            // jmp rel32
+	else
+		emit(as, (const uint8_t[]){ 0x0f, 0x80 | condition }, 2);     // jcc rel32
+
+	emit_u32(as, 0);
+
+	return as->size - 4;
+}
@@ -0,0 +1,514 @@
+
+#include "input.h"
+#include "lanes.h"
+#include "opcode.h"
+
+/*! @brief The size of the input buffer */
+#define LANES_BUFFER_SIZE 65536
+
+/*! @brief The initial capacity of the characters of a value */
+#define LANES_TOKEN_SIZE 32
+
+// the lanes of a slot are a vector of the compiler, lowered to the vector instructions of the target
+// (e.g. SSE2, or AVX2 with -mavx2), otherwise they are an array processed by loops
+#if defined(__GNUC__) && !defined(YOG_NO_VECTOR_EXTENSION)
+#define YOG_VECTOR_EXTENSION
+typedef int64_t lane_vector __attribute__((vector_size(LANES_CNT * sizeof(int64_t)), aligned(sizeof(int64_t))));
+#define LANE(vector, l) ((vector)[l])
+#else
+typedef struct { int64_t lane[LANES_CNT]; } lane_vector;
+#define LANE(vector, l) ((vector).lane[l])
+#endif
+
+bool read_record(struct lanes *vm, FILE *in, struct lane *lane);
+int read_char(struct lanes *vm, FILE *in);
+bool is_separator(int c);
+void lane_push(int64_t **values, size_t *size, size_t *capacity, int64_t value);
+void execute_group(struct lanes *vm);
+void execute_lane(struct lanes *vm, size_t l, size_t pc);
+void lane_fail(struct lane *lane, size_t pc, enum interpreter_status status);
+int report_lane(struct lane *lane, struct line_table lines, uint64_t record, FILE *err);
+
+void lanes_init(struct lanes *vm, const struct bytecode *bc)
+{
+	vm->bc = bc;
+	vm->frame = ycalloc((bc->vars_cnt + bc->tmp_cnt) * LANES_CNT, sizeof(int64_t));
+	vm->constants = ymalloc(bc->constants_cnt * LANES_CNT * sizeof(int64_t));
+
+	for(size_t i = 0; i < bc->constants_cnt; i++)
+	{
+		for(size_t l = 0; l < LANES_CNT; l++)
+			vm->constants[i * LANES_CNT + l] = bc->constants[i];
+	}
+
+	for(size_t l = 0; l < LANES_CNT; l++)
+	{
+		struct lane *lane = &vm->lane[l];
+
+		lane->inputs = NULL;
+		lane->inputs_cnt = 0;
+		lane->inputs_capacity = 0;
+		lane->next_input = 0;
+		lane->invalid = false;
+		lane->outputs = NULL;
+		lane->outputs_cnt = 0;
+		lane->outputs_capacity = 0;
+		lane->status = INTERPRETER_HALTED;
+		lane->pc = 0;
+	}
+
+	vm->active = 0;
+	vm->buffer = ymalloc(LANES_BUFFER_SIZE);
+	vm->buffer_pos = 0;
+	vm->buffer_len = 0;
+	vm->token = ymalloc(LANES_TOKEN_SIZE);
+	vm->token_capacity = LANES_TOKEN_SIZE;
+	vm->records = 0;
+	vm->groups = 0;
+	vm->diverged = 0;
+}
+
+void lanes_clear(struct lanes *vm)
+{
+	for(size_t l = 0; l < LANES_CNT; l++)
+	{
+		yfree(vm->lane[l].inputs);
+		yfree(vm->lane[l].outputs);
+	}
+
+	yfree(vm->token);
+	yfree(vm->buffer);
+	yfree(vm->constants);
+	yfree(vm->frame);
+}
+
+int lanes_execute(struct lanes *vm, struct line_table lines, FILE *in, FILE *out, FILE *err)
+{
+	int status = 0;
+
+	vm->buffer_pos = 0;
+	vm->buffer_len = 0;
+
+	while(true)
+	{
+		// fill the lanes with the next records
+		vm->active = 0;
+
+		while(vm->active < LANES_CNT && read_record(vm, in, &vm->lane[vm->active]))
+			vm->active++;
+
+		if(vm->active == 0)
+			break;
+
+		// the idle lanes repeat the first record, so that they do not fail on their own
+		for(size_t l = vm->active; l < LANES_CNT; l++)
+		{
+			struct lane *lane = &vm->lane[l];
+			lane->inputs_cnt = 0;
+			lane->invalid = vm->lane[0].invalid;
+
+			for(size_t i = 0; i < vm->lane[0].inputs_cnt; i++)
+				lane_push(&lane->inputs, &lane->inputs_cnt, &lane->inputs_capacity, vm->lane[0].inputs[i]);
+		}
+
+		execute_group(vm);
+
+		for(size_t l = 0; l < vm->active; l++)
+		{
+			struct lane *lane = &vm->lane[l];
+
+			for(size_t i = 0; i < lane->outputs_cnt; i++)
+				fprintf(out, i == 0 ? "%ld" : " %ld", lane->outputs[i]);
+
+			fprintf(out, "\n");
+
+			// the other records are not affected by a runtime error
+			if(lane->status != INTERPRETER_HALTED)
+			{
+				fflush(out);
+				int failure = report_lane(lane, lines, vm->records + l + 1, err);
+
+				if(status == 0)
+					status = failure;
+			}
+		}
+
+		vm->records += vm->active;
+		vm->groups++;
+	}
+
+	return status;
+}
+
+// read a line of whitespace separated values, false at the end of the input
+bool read_record(struct lanes *vm, FILE *in, struct lane *lane)
+{
+	lane->inputs_cnt = 0;
+	lane->invalid = false;
+
+	int c = read_char(vm, in);
+	if(c == EOF)
+		return false;
+
+	while(c != EOF && c != '\n')
+	{
+		if(is_separator(c))
+		{
+			c = read_char(vm, in);
+			continue;
+		}
+
+		size_t len = 0;
+
+		while(c != EOF && c != '\n' && !is_separator(c))
+		{
+			if(len == vm->token_capacity)
+			{
+				vm->token_capacity *= 2;
+				vm->token = yrealloc(vm->token, vm->token_capacity);
+			}
+
+			vm->token[len++] = (char)c;
+			c = read_char(vm, in);
+		}
+
+		// the values after a malformed one are never read, as the read of the malformed value fails
+		int64_t value;
+
+		if(lane->invalid || input_parse(vm->token, vm->token + len, &value) != INPUT_VALUE)
+			lane->invalid = true;
+		else
+			lane_push(&lane->inputs, &lane->inputs_cnt, &lane->inputs_capacity, value);
+	}
+
+	return true;
+}
+
+// the white space separating the values of a record, which ends at a new line
+bool is_separator(int c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+int read_char(struct lanes *vm, FILE *in)
+{
+	if(vm->buffer_pos == vm->buffer_len)
+	{
+		vm->buffer_pos = 0;
+		vm->buffer_len = fread(vm->buffer, 1, LANES_BUFFER_SIZE, in);
+
+		if(vm->buffer_len == 0)
+			return EOF;
+	}
+
+	return (unsigned char)vm->buffer[vm->buffer_pos++];
+}
+
+void lane_push(int64_t **values, size_t *size, size_t *capacity, int64_t value)
+{
+	if(*size == *capacity)
+	{
+		*capacity = *capacity == 0 ? 8 : 2 * *capacity;
+		*values = yrealloc(*values, *capacity * sizeof(int64_t));
+	}
+
+	(*values)[(*size)++] = value;
+}
+
+// the operands of the current instruction
+#define OPERAND(kind, index) ((kind) == OPERAND_LITERAL ? &constants[index] : &frame[index])
+#define DEST (&frame[instr->dest])
+#define SRC1 OPERAND(BYTECODE_KIND_SRC1(instr->kinds), instr->src1)
+#define SRC2 OPERAND(BYTECODE_KIND_SRC2(instr->kinds), instr->src2)
+
+#ifdef YOG_VECTOR_EXTENSION
+// the comparisons of vectors set the true lanes to -1
+#define VECTOR_BINARY(name, op) \
+	case INSTRUCTION_##name: \
+		*DEST = (lane_vector)(*SRC1 op *SRC2); \
+		if(INSTRUCTION_##name >= INSTRUCTION_EQ) \
+			*DEST = -*DEST; \
+		break;
+
+#define VECTOR_UNARY(name, op) \
+	case INSTRUCTION_##name: \
+		*DEST = op *SRC1; \
+		break;
+
+#define VECTOR_BRANCH(name, op) \
+	case INSTRUCTION_##name: \
+		mask = (lane_vector)(*SRC1 op *SRC2); \
+		break;
+#else
+#define VECTOR_BINARY(name, op) \
+	case INSTRUCTION_##name: \
+		for(size_t l = 0; l < LANES_CNT; l++) \
+			LANE(*DEST, l) = LANE(*SRC1, l) op LANE(*SRC2, l); \
+		break;
+
+#define VECTOR_UNARY(name, op) \
+	case INSTRUCTION_##name: \
+		for(size_t l = 0; l < LANES_CNT; l++) \
+			LANE(*DEST, l) = op LANE(*SRC1, l); \
+		break;
+
+#define VECTOR_BRANCH(name, op) \
+	case INSTRUCTION_##name: \
+		for(size_t l = 0; l < LANES_CNT; l++) \
+			LANE(mask, l) = LANE(*SRC1, l) op LANE(*SRC2, l); \
+		break;
+#endif
+
+// execute the bytecode over all the lanes while they take the same branches
+void execute_group(struct lanes *vm)
+{
+	const struct bytecode_instruction *code = vm->bc->code;
+	size_t size = vm->bc->size;
+	lane_vector *frame = (lane_vector *)vm->frame;
+	const lane_vector *constants = (const lane_vector *)vm->constants;
+
+	memset(vm->frame, 0, (vm->bc->vars_cnt + vm->bc->tmp_cnt) * LANES_CNT * sizeof(int64_t));
+
+	for(size_t l = 0; l < LANES_CNT; l++)
+	{
+		vm->lane[l].next_input = 0;
+		vm->lane[l].outputs_cnt = 0;
+		vm->lane[l].status = INTERPRETER_HALTED;
+	}
+
+	size_t pc = 0;
+
+	while(pc < size)
+	{
+		const struct bytecode_instruction *instr = &code[pc];
+		lane_vector mask = {0};
+
+		switch(instr->type)
+		{
+			case INSTRUCTION_ASSIGN:
+				*DEST = *SRC1;
+				pc++;
+				continue;
+
+			// the lanes without a value to read are masked off
+			case INSTRUCTION_READ:
+				for(size_t l = 0; l < LANES_CNT; l++)
+				{
+					struct lane *lane = &vm->lane[l];
+
+					if(lane->next_input < lane->inputs_cnt)
+						LANE(*DEST, l) = lane->inputs[lane->next_input++];
+					else
+						lane_fail(lane, pc, lane->invalid ? INTERPRETER_INVALID_INPUT : INTERPRETER_END_OF_INPUT);
+				}
+
+				pc++;
+				continue;
+
+			case INSTRUCTION_WRITE:
+				for(size_t l = 0; l < vm->active; l++)
+				{
+					struct lane *lane = &vm->lane[l];
+
+					if(lane->status == INTERPRETER_HALTED)
+						lane_push(&lane->outputs, &lane->outputs_cnt, &lane->outputs_capacity, LANE(*SRC1, l));
+				}
+
+				pc++;
+				continue;
+
+			// there is no vector division, the lanes dividing by zero are masked off and divide by one
+			case INSTRUCTION_DIV:
+				for(size_t l = 0; l < LANES_CNT; l++)
+				{
+					int64_t right = LANE(*SRC2, l);
+
+					if(right == 0)
+					{
+						lane_fail(&vm->lane[l], pc, INTERPRETER_DIVISION_BY_ZERO);
+						right = 1;
+					}
+
+					LANE(*DEST, l) = LANE(*SRC1, l) / right;
+				}
+
+				pc++;
+				continue;
+
+			OPCODE_BINARY_OPERATIONS(VECTOR_BINARY)
+			OPCODE_UNARY_OPERATIONS(VECTOR_UNARY)
+
+			case INSTRUCTION_GOTO:
+				pc = instr->dest;
+				continue;
+
+			case INSTRUCTION_BRANCH:
+				for(size_t l = 0; l < LANES_CNT; l++)
+					LANE(mask, l) = LANE(*SRC1, l) != 0;
+				break;
+
+			OPCODE_BRANCH_OPERATIONS(VECTOR_BRANCH)
+		}
+
+		if(instr->type < INSTRUCTION_BRANCH)
+		{
+			pc++;
+			continue;
+		}
+
+		// the lanes take the branch together or complete the execution alone, the masked off lanes do not vote
+		size_t taken = 0;
+		size_t live = 0;
+
+		for(size_t l = 0; l < LANES_CNT; l++)
+		{
+			if(vm->lane[l].status == INTERPRETER_HALTED)
+			{
+				live++;
+				taken += LANE(mask, l) != 0;
+			}
+		}
+
+		if(live == 0)
+			return;
+
+		if(taken == 0)
+		{
+			pc++;
+		}
+		else if(taken == live)
+		{
+			pc = instr->dest;
+		}
+		else
+		{
+			vm->diverged++;
+
+			for(size_t l = 0; l < vm->active; l++)
+			{
+				if(vm->lane[l].status == INTERPRETER_HALTED)
+					execute_lane(vm, l, pc);
+			}
+
+			return;
+		}
+	}
+}
+
+#undef DEST
+#undef SRC1
+#undef SRC2
+
+#define LANE_OPERAND(kind, index) ((kind) == OPERAND_LITERAL ? bc->constants[index] : frame[(index) * LANES_CNT + l])
+#define SRC1 LANE_OPERAND(BYTECODE_KIND_SRC1(instr->kinds), instr->src1)
+#define SRC2 LANE_OPERAND(BYTECODE_KIND_SRC2(instr->kinds), instr->src2)
+
+#define LANE_BINARY(name, op) \
+	case INSTRUCTION_##name: \
+		frame[instr->dest * LANES_CNT + l] = SRC1 op SRC2; \
+		pc++; \
+		break;
+
+#define LANE_UNARY(name, op) \
+	case INSTRUCTION_##name: \
+		frame[instr->dest * LANES_CNT + l] = op SRC1; \
+		pc++; \
+		break;
+
+#define LANE_BRANCH(name, op) \
+	case INSTRUCTION_##name: \
+		pc = SRC1 op SRC2 ? instr->dest : pc + 1; \
+		break;
+
+// execute the bytecode from an instruction over a single lane
+void execute_lane(struct lanes *vm, size_t l, size_t pc)
+{
+	const struct bytecode *bc = vm->bc;
+	int64_t *frame = vm->frame;
+	struct lane *lane = &vm->lane[l];
+
+	while(pc < bc->size)
+	{
+		const struct bytecode_instruction *instr = &bc->code[pc];
+
+		switch(instr->type)
+		{
+			case INSTRUCTION_ASSIGN:
+				frame[instr->dest * LANES_CNT + l] = SRC1;
+				pc++;
+				break;
+
+			case INSTRUCTION_READ:
+				if(lane->next_input == lane->inputs_cnt)
+				{
+					lane_fail(lane, pc, lane->invalid ? INTERPRETER_INVALID_INPUT : INTERPRETER_END_OF_INPUT);
+					return;
+				}
+
+				frame[instr->dest * LANES_CNT + l] = lane->inputs[lane->next_input++];
+				pc++;
+				break;
+
+			case INSTRUCTION_WRITE:
+				lane_push(&lane->outputs, &lane->outputs_cnt, &lane->outputs_capacity, SRC1);
+				pc++;
+				break;
+
+			case INSTRUCTION_DIV:
+				if(SRC2 == 0)
+				{
+					lane_fail(lane, pc, INTERPRETER_DIVISION_BY_ZERO);
+					return;
+				}
+
+				frame[instr->dest * LANES_CNT + l] = SRC1 / SRC2;
+				pc++;
+				break;
+
+			OPCODE_BINARY_OPERATIONS(LANE_BINARY)
+			OPCODE_UNARY_OPERATIONS(LANE_UNARY)
+
+			case INSTRUCTION_GOTO:
+				pc = instr->dest;
+				break;
+
+			case INSTRUCTION_BRANCH:
+				pc = SRC1 ? instr->dest : pc + 1;
+				break;
+
+			OPCODE_BRANCH_OPERATIONS(LANE_BRANCH)
+		}
+	}
+}
+
+// mask off a lane at its first runtime error
+void lane_fail(struct lane *lane, size_t pc, enum interpreter_status status)
+{
+	if(lane->status == INTERPRETER_HALTED)
+	{
+		lane->status = status;
+		lane->pc = pc;
+	}
+}
+
+// report the runtime error of a failed record, returning the exit status of the interpreter for it
+int report_lane(struct lane *lane, struct line_table lines, uint64_t record, FILE *err)
+{
+	const char *error = "division by zero";
+	int status = 6;
+
+	if(lane->status == INTERPRETER_END_OF_INPUT)
+	{
+		error = "end of input";
+		status = 7;
+	}
+	else if(lane->status == INTERPRETER_INVALID_INPUT)
+	{
+		error = "invalid input";
+		status = 8;
+	}
+
+	fprintf(err, "record %llu: %s at line %zu\n", (unsigned long long)record, error, line_table_find(lines, lane->pc).row);
+
+	return status;
+}
@@ -0,0 +1,163 @@
+
+#include "libyog.h"
+#include "compiler.h"
+#include "interpreter.h"
+
+struct yog_program
+{
+	/*! @brief The bytecode of the program */
+	struct bytecode bc;
+
+	/*! @brief The source locations of the instructions */
+	struct line_table lines;
+};
+
+struct yog_context
+{
+	/*! @brief A pointer to the executed program */
+	const struct yog_program *program;
+
+	/*! @brief The interpreter, reused by all the runs */
+	struct interpreter vm;
+
+	/*! @brief The number of instructions a run may retire, UINT64_MAX if unlimited */
+	uint64_t fuel;
+
+	/*! @brief The wall-clock time in seconds a run may take, zero if unlimited */
+	double seconds;
+};
+
+enum yog_status yog_compile(const char *source, size_t size, FILE *errors, struct yog_program **program)
+{
+	*program = NULL;
+
+	struct compilation comp;
+	if(!compile(&comp, source, size, errors))
+		return YOG_COMPILE_ERROR;
+
+	// the bytecode and the line table do not refer to the symbol table nor to the instruction list
+	*program = ymalloc(sizeof(struct yog_program));
+	(*program)->bc = comp.bc;
+	(*program)->lines = comp.lines;
+
+	instruction_list_clear(&comp.instrs);
+	symbol_table_clear(&comp.st);
+
+	return YOG_OK;
+}
+
+void yog_program_free(struct yog_program *program)
+{
+	if(program == NULL)
+		return;
+
+	bytecode_clear(&program->bc);
+	line_table_clear(&program->lines);
+	yfree(program);
+}
+
+struct yog_context *yog_context_new(const struct yog_program *program)
+{
+	struct yog_context *ctx = ymalloc(sizeof(struct yog_context));
+
+	ctx->program = program;
+	ctx->fuel = UINT64_MAX;
+	ctx->seconds = 0;
+
+	interpreter_init(&ctx->vm, &program->bc, DISPATCH_THREADED);
+	ctx->vm.interactive = false;
+
+	return ctx;
+}
+
+void yog_context_free(struct yog_context *ctx)
+{
+	if(ctx == NULL)
+		return;
+
+	interpreter_clear(&ctx->vm);
+	yfree(ctx);
+}
+
+void yog_context_set_callbacks(struct yog_context *ctx, yog_read_callback read, yog_write_callback write, void *data)
+{
+	ctx->vm.read_callback = read;
+	ctx->vm.write_callback = write;
+	ctx->vm.callback_data = data;
+}
+
+void yog_context_set_limits(struct yog_context *ctx, uint64_t fuel, double seconds)
+{
+	ctx->fuel = fuel;
+	ctx->seconds = seconds;
+}
+
+enum yog_status yog_run(struct yog_context *ctx)
+{
+	interpreter_reset(&ctx->vm);
+
+	// the deadline starts with the run
+	if(ctx->fuel != UINT64_MAX || ctx->seconds > 0 || ctx->vm.fuel != UINT64_MAX || ctx->vm.deadline > 0)
+		interpreter_limit(&ctx->vm, ctx->fuel, ctx->seconds);
+
+	switch(interpreter_execute(&ctx->vm))
+	{
+		case INTERPRETER_FUEL_EXHAUSTED:
+			return YOG_FUEL_EXHAUSTED;
+
+		case INTERPRETER_DEADLINE_EXCEEDED:
+			return YOG_DEADLINE_EXCEEDED;
+
+		case INTERPRETER_DIVISION_BY_ZERO:
+			return YOG_DIVISION_BY_ZERO;
+
+		// a run is not resumed, so an input without a value yet ends it
+		case INTERPRETER_END_OF_INPUT:
+		case INTERPRETER_NEEDS_INPUT:
+			return YOG_END_OF_INPUT;
+
+		case INTERPRETER_INVALID_INPUT:
+			return YOG_INVALID_INPUT;
+
+		default: // case INTERPRETER_HALTED:
+			return YOG_OK;
+	}
+}
+
+size_t yog_context_line(const struct yog_context *ctx)
+{
+	if(ctx->vm.status == INTERPRETER_HALTED)
+		return 0;
+
+	return line_table_find(ctx->program->lines, ctx->vm.pc).row;
+}
+
+const char *yog_status_str(enum yog_status status)
+{
+	switch(status)
+	{
+		case YOG_OK:
+			return "ok";
+
+		case YOG_COMPILE_ERROR:
+			return "compile error";
+
+		case YOG_DIVISION_BY_ZERO:
+			return "division by zero";
+
+		case YOG_FUEL_EXHAUSTED:
+			return "fuel exhausted";
+
+		case YOG_DEADLINE_EXCEEDED:
+			return "deadline exceeded";
+
+		case YOG_END_OF_INPUT:
+			return "end of input";
+
+		case YOG_INVALID_INPUT:
+			return "invalid input";
+
+		default:
+			return "unknown status";
+	}
+}
@@ -0,0 +1,68 @@
+#include "linetable.h"
+
+void line_table_init(struct line_table *lt)
+{
+	lt->entries = NULL;
+	lt->size = 0;
+	lt->capacity = 0;
+}
+
+void line_table_clear(struct line_table *lt)
+{
+	yfree(lt->entries);
+	line_table_init(lt);
+}
+
+void line_table_add(struct line_table *lt, size_t pc, struct location loc)
+{
+	if(lt->size > 0)
+	{
+		struct line_entry *last = &lt->entries[lt->size - 1];
+
+		// the location does not change
+		if(last->loc.row == loc.row && last->loc.col == loc.col)
+			return;
+
+		// the previous location has not emitted any instruction
+		if(last->pc == pc)
+		{
+			last->loc = loc;
+			return;
+		}
+	}
+
+	// enlarge the table capacity if necessary
+	if(lt->size == lt->capacity)
+	{
+		lt->capacity = 2 * lt->capacity + 16;
+		lt->entries = yrealloc(lt->entries, lt->capacity * sizeof(struct line_entry));
+	}
+
+	lt->entries[lt->size].pc = pc;
+	lt->entries[lt->size].loc = loc;
+	lt->size++;
+}
+
+struct location line_table_find(struct line_table lt, size_t pc)
+{
+	struct location loc = { 0, 0 };
+
+	// binary search of the last entry not after the instruction
+	size_t low = 0;
+	size_t high = lt.size;
+
+	while(low < high)
+	{
+		size_t mid = low + (high - low) / 2;
+
+		if(lt.entries[mid].pc <= pc)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	if(low > 0)
+		loc = lt.entries[low - 1].loc;
+
+	return loc;
+}
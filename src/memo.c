@@ -0,0 +1,561 @@
+
+// the process identifiers are not part of the strict C99 environment
+#if defined(__unix__) || defined(__APPLE__)
+#define YOG_MEMO_PID
+#define _POSIX_C_SOURCE 200809L
+#include <unistd.h>
+#endif
+
+#include "memo.h"
+#include "yogc.h"
+
+/*! @brief The header of a memo file, followed by the outcomes from the least to the most recently used */
+struct memo_header
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t entries_cnt;
+};
+
+/*! @brief The header of an outcome in a memo file, followed by its input values and by its written values */
+struct memo_record
+{
+	uint64_t program;
+	uint64_t fuel;
+	uint64_t end;
+	uint64_t cnt;
+	uint64_t status;
+	uint64_t pc;
+	uint64_t retired;
+	uint64_t output_cnt;
+};
+
+/*! @brief A stored outcome */
+struct memo_entry
+{
+	/*! @brief The key of the execution, which owns its input values */
+	struct memo_key key;
+
+	/*! @brief The outcome of the execution, which owns its written values */
+	struct memo_result result;
+
+	/*! @brief The next outcome of the bucket */
+	struct memo_entry *next;
+
+	/*! @brief The more recently used outcome, NULL if none */
+	struct memo_entry *newer;
+
+	/*! @brief The less recently used outcome, NULL if none */
+	struct memo_entry *older;
+};
+
+/*! @brief The input values of an execution and its written values */
+struct memo_recording
+{
+	/*! @brief A pointer to the interpreter, which writes the values to its output as well */
+	struct interpreter *vm;
+
+	/*! @brief The input values */
+	const int64_t *values;
+
+	/*! @brief The number of input values */
+	size_t cnt;
+
+	/*! @brief The index of the next input value */
+	size_t next;
+
+	/*! @brief The written values */
+	int64_t *output;
+
+	/*! @brief The number of written values */
+	size_t output_cnt;
+
+	/*! @brief The capacity of the written values */
+	size_t output_capacity;
+};
+
+// the initial number of buckets of the hash table
+#define MEMO_BUCKETS_CNT 64
+
+bool replay_read(void *data, const char *name, int64_t *value);
+void record_write(void *data, int64_t value);
+int64_t *read_values(struct interpreter *vm, size_t *cnt, enum input_result *end);
+bool matching_key(const struct memo_key *stored, const struct memo_key *key);
+size_t entry_size(const struct memo_key *key, const struct memo_result *result);
+void free_entry(struct memo_entry *entry);
+void link_entry(struct memo *m, struct memo_entry *entry);
+void unlink_entry(struct memo *m, struct memo_entry *entry);
+void evict_entries(struct memo *m);
+void grow_buckets(struct memo *m);
+
+void memo_init(struct memo *m, size_t capacity)
+{
+	m->capacity = capacity;
+	m->size = 0;
+	m->hits = 0;
+	m->misses = 0;
+	m->evictions = 0;
+	m->modified = false;
+	m->buckets = ycalloc(MEMO_BUCKETS_CNT, sizeof(struct memo_entry *));
+	m->buckets_cnt = MEMO_BUCKETS_CNT;
+	m->entries_cnt = 0;
+	m->first = NULL;
+	m->last = NULL;
+}
+
+struct memo_key memo_key(uint64_t program, uint64_t fuel, const int64_t *values, size_t cnt, enum input_result end)
+{
+	const uint64_t prefix[4] = { program, fuel, cnt, end };
+
+	// a FNV-1a hash of the bytes, a collision is told apart by the comparison of the fields
+	struct memo_key key = { 14695981039346656037ULL, program, fuel, end, values, cnt };
+
+	const unsigned char *parts[2] = { (const unsigned char *)prefix, (const unsigned char *)values };
+	const size_t sizes[2] = { sizeof(prefix), cnt * sizeof(int64_t) };
+
+	for(size_t p = 0; p < 2; p++)
+	{
+		for(size_t i = 0; i < sizes[p]; i++)
+		{
+			key.hash ^= parts[p][i];
+			key.hash *= 1099511628211ULL;
+		}
+	}
+
+	return key;
+}
+
+const struct memo_result *memo_find(struct memo *m, struct memo_key key)
+{
+	for(struct memo_entry *entry = m->buckets[key.hash & (m->buckets_cnt - 1)]; entry != NULL; entry = entry->next)
+	{
+		if(matching_key(&entry->key, &key))
+		{
+			unlink_entry(m, entry);
+			link_entry(m, entry);
+
+			m->hits++;
+			return &entry->result;
+		}
+	}
+
+	m->misses++;
+	return NULL;
+}
+
+void memo_store(struct memo *m, struct memo_key key, const struct memo_result *result)
+{
+	if(entry_size(&key, result) > m->capacity)
+		return;
+
+	struct memo_entry **bucket = &m->buckets[key.hash & (m->buckets_cnt - 1)];
+
+	// an outcome stored again replaces the previous one
+	for(struct memo_entry **entry = bucket; *entry != NULL; entry = &(*entry)->next)
+	{
+		if(matching_key(&(*entry)->key, &key))
+		{
+			struct memo_entry *replaced = *entry;
+			*entry = replaced->next;
+
+			unlink_entry(m, replaced);
+			m->size -= entry_size(&replaced->key, &replaced->result);
+			m->entries_cnt--;
+
+			free_entry(replaced);
+			break;
+		}
+	}
+
+	struct memo_entry *entry = ymalloc(sizeof(struct memo_entry));
+	entry->key = key;
+	entry->key.values = ymalloc((key.cnt > 0 ? key.cnt : 1) * sizeof(int64_t));
+	entry->result = *result;
+	entry->result.output = ymalloc((result->output_cnt > 0 ? result->output_cnt : 1) * sizeof(int64_t));
+
+	if(key.cnt > 0)
+		memcpy((int64_t *)entry->key.values, key.values, key.cnt * sizeof(int64_t));
+
+	if(result->output_cnt > 0)
+		memcpy(entry->result.output, result->output, result->output_cnt * sizeof(int64_t));
+
+	entry->next = *bucket;
+	*bucket = entry;
+	link_entry(m, entry);
+
+	m->size += entry_size(&key, result);
+	m->entries_cnt++;
+	m->modified = true;
+
+	evict_entries(m);
+
+	if(m->entries_cnt > m->buckets_cnt)
+		grow_buckets(m);
+}
+
+bool memo_reads(const struct bytecode *bc)
+{
+	for(size_t i = 0; i < bc->size; i++)
+	{
+		if(bc->code[i].type == INSTRUCTION_READ)
+			return true;
+	}
+
+	return false;
+}
+
+enum interpreter_status memo_execute(struct memo *m, struct interpreter *vm, uint64_t program)
+{
+	struct memo_recording rec;
+	enum input_result end;
+
+	rec.vm = vm;
+	rec.values = read_values(vm, &rec.cnt, &end);
+	rec.next = 0;
+
+	struct memo_key key = memo_key(program, vm->fuel, rec.values, rec.cnt, end);
+	const struct memo_result *found = memo_find(m, key);
+
+	if(found != NULL)
+	{
+		// the stored values are written as the execution would write them
+		output_bind(&vm->output, vm->out, vm->in);
+
+		for(size_t i = 0; i < found->output_cnt; i++)
+			output_int(&vm->output, found->output[i]);
+
+		output_flush(&vm->output);
+
+		vm->status = found->status;
+		vm->pc = found->pc;
+		vm->retired = found->retired;
+
+		yfree((int64_t *)rec.values);
+		return vm->status;
+	}
+
+	rec.output_capacity = 64;
+	rec.output_cnt = 0;
+	rec.output = ymalloc(rec.output_capacity * sizeof(int64_t));
+
+	vm->read_callback = replay_read;
+	vm->write_callback = record_write;
+	vm->callback_data = &rec;
+
+	interpreter_execute(vm);
+
+	vm->read_callback = NULL;
+	vm->write_callback = NULL;
+	vm->callback_data = NULL;
+
+	// the values run out where the input ends, or where its invalid value would have been read
+	if(vm->status == INTERPRETER_END_OF_INPUT && end == INPUT_INVALID)
+		vm->status = INTERPRETER_INVALID_INPUT;
+	else if(vm->status == INTERPRETER_END_OF_INPUT && end == INPUT_PENDING)
+		vm->status = INTERPRETER_NEEDS_INPUT;
+
+	// an input which has not ended does not key an outcome
+	if(end != INPUT_PENDING)
+	{
+		struct memo_result result;
+		result.status = vm->status;
+		result.pc = vm->pc;
+		result.retired = vm->retired;
+		result.output = rec.output;
+		result.output_cnt = rec.output_cnt;
+
+		memo_store(m, key, &result);
+	}
+
+	yfree(rec.output);
+	yfree((int64_t *)rec.values);
+
+	return vm->status;
+}
+
+bool memo_cache_path(char *path, uint64_t program)
+{
+	if(!yogc_cache_path(path, program))
+		return false;
+
+	// the memo file is next to the precompiled bytecode, the extension of the bytecode has 4 characters as well
+	strcpy(path + strlen(path) - 4, "memo");
+
+	return true;
+}
+
+bool memo_load(struct memo *m, const char *filename)
+{
+	FILE *in = fopen(filename, "rb");
+	if(!in)
+		return false;
+
+	struct memo_header header;
+
+	bool valid = fread(&header, sizeof(header), 1, in) == 1
+		&& memcmp(header.magic, "YOGM", 4) == 0
+		&& header.version == MEMO_VERSION;
+
+	for(uint64_t i = 0; valid && i < header.entries_cnt; i++)
+	{
+		struct memo_record record;
+
+		valid = fread(&record, sizeof(record), 1, in) == 1 && record.output_cnt <= m->capacity / sizeof(int64_t)
+			&& record.cnt <= m->capacity / sizeof(int64_t) && (record.end == INPUT_END || record.end == INPUT_INVALID);
+		if(!valid)
+			break;
+
+		int64_t *values = ymalloc((record.cnt > 0 ? record.cnt : 1) * sizeof(int64_t));
+		struct memo_result result;
+		result.status = (enum interpreter_status)record.status;
+		result.pc = record.pc;
+		result.retired = record.retired;
+		result.output_cnt = record.output_cnt;
+		result.output = ymalloc((record.output_cnt > 0 ? record.output_cnt : 1) * sizeof(int64_t));
+
+		valid = fread(values, sizeof(int64_t), record.cnt, in) == record.cnt
+			&& fread(result.output, sizeof(int64_t), result.output_cnt, in) == result.output_cnt;
+
+		// the outcomes are stored from the least recently used, so they keep their order, and their hashes are computed again
+		if(valid)
+		{
+			struct memo_key key = memo_key(record.program, record.fuel, values, record.cnt, (enum input_result)record.end);
+			memo_store(m, key, &result);
+		}
+
+		yfree(result.output);
+		yfree(values);
+	}
+
+	fclose(in);
+	m->modified = false;
+
+	return valid;
+}
+
+bool memo_save(struct memo *m, const char *filename)
+{
+	struct memo_header header;
+	memset(&header, 0, sizeof(header));
+
+	memcpy(header.magic, "YOGM", 4);
+	header.version = MEMO_VERSION;
+	header.entries_cnt = m->entries_cnt;
+
+	// write a temporary file and rename it, so a concurrent execution loads either the previous memo or this one
+	char tmp[YOGC_PATH_SIZE + 32];
+#ifdef YOG_MEMO_PID
+	snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", filename, (long)getpid());
+#else
+	snprintf(tmp, sizeof(tmp), "%s.tmp", filename);
+#endif
+
+	FILE *out = fopen(tmp, "wb");
+	if(!out)
+		return false;
+
+	bool written = fwrite(&header, sizeof(header), 1, out) == 1;
+
+	for(struct memo_entry *entry = m->last; written && entry != NULL; entry = entry->newer)
+	{
+		struct memo_record record;
+		memset(&record, 0, sizeof(record));
+
+		record.program = entry->key.program;
+		record.fuel = entry->key.fuel;
+		record.end = entry->key.end;
+		record.cnt = entry->key.cnt;
+		record.status = entry->result.status;
+		record.pc = entry->result.pc;
+		record.retired = entry->result.retired;
+		record.output_cnt = entry->result.output_cnt;
+
+		written = fwrite(&record, sizeof(record), 1, out) == 1
+			&& fwrite(entry->key.values, sizeof(int64_t), entry->key.cnt, out) == entry->key.cnt
+			&& fwrite(entry->result.output, sizeof(int64_t), entry->result.output_cnt, out) == entry->result.output_cnt;
+	}
+
+	written = fclose(out) == 0 && written;
+
+#ifndef YOG_MEMO_PID
+	remove(filename);
+#endif
+
+	if(!written || rename(tmp, filename) != 0)
+	{
+		remove(tmp);
+		return false;
+	}
+
+	m->modified = false;
+
+	return true;
+}
+
+void memo_clear(struct memo *m)
+{
+	while(m->first != NULL)
+	{
+		struct memo_entry *entry = m->first;
+		m->first = entry->older;
+
+		free_entry(entry);
+	}
+
+	yfree(m->buckets);
+	m->buckets = NULL;
+	m->buckets_cnt = 0;
+	m->entries_cnt = 0;
+	m->last = NULL;
+	m->size = 0;
+}
+
+// the read callback of an execution over the values of its input
+bool replay_read(void *data, const char *name, int64_t *value)
+{
+	struct memo_recording *rec = data;
+	(void)name;
+
+	if(rec->next == rec->cnt)
+		return false;
+
+	*value = rec->values[rec->next++];
+	return true;
+}
+
+// the write callback of an execution, which records the values it writes
+void record_write(void *data, int64_t value)
+{
+	struct memo_recording *rec = data;
+
+	if(rec->output_cnt == rec->output_capacity)
+	{
+		rec->output_capacity *= 2;
+		rec->output = yrealloc(rec->output, rec->output_capacity * sizeof(int64_t));
+	}
+
+	rec->output[rec->output_cnt++] = value;
+	output_int(&rec->vm->output, value);
+}
+
+// read the values of the input of an interpreter to its end, without prompting
+int64_t *read_values(struct interpreter *vm, size_t *cnt, enum input_result *end)
+{
+	size_t capacity = 64;
+	int64_t *values = ymalloc(capacity * sizeof(int64_t));
+	int64_t value;
+
+	*cnt = 0;
+
+	// a program which never reads is keyed without its input, so the memo does not wait for its end
+	if(!memo_reads(vm->bc))
+	{
+		*end = INPUT_END;
+		return values;
+	}
+
+	input_bind(&vm->input, vm->in, false);
+
+	while((*end = input_int(&vm->input, &value)) == INPUT_VALUE)
+	{
+		if(*cnt == capacity)
+		{
+			capacity *= 2;
+			values = yrealloc(values, capacity * sizeof(int64_t));
+		}
+
+		values[(*cnt)++] = value;
+	}
+
+	input_unbind(&vm->input);
+
+	return values;
+}
+
+// check if a stored key is the key of the same execution, comparing its input values on a match of the hash
+bool matching_key(const struct memo_key *stored, const struct memo_key *key)
+{
+	return stored->hash == key->hash && stored->program == key->program && stored->fuel == key->fuel
+		&& stored->end == key->end && stored->cnt == key->cnt
+		&& (key->cnt == 0 || memcmp(stored->values, key->values, key->cnt * sizeof(int64_t)) == 0);
+}
+
+// the bytes of a stored outcome with its input
+size_t entry_size(const struct memo_key *key, const struct memo_result *result)
+{
+	return sizeof(struct memo_entry) + (key->cnt + result->output_cnt) * sizeof(int64_t);
+}
+
+void free_entry(struct memo_entry *entry)
+{
+	yfree((int64_t *)entry->key.values);
+	yfree(entry->result.output);
+	yfree(entry);
+}
+
+// link an outcome as the most recently used
+void link_entry(struct memo *m, struct memo_entry *entry)
+{
+	entry->newer = NULL;
+	entry->older = m->first;
+
+	if(m->first != NULL)
+		m->first->newer = entry;
+	else
+		m->last = entry;
+
+	m->first = entry;
+}
+
+void unlink_entry(struct memo *m, struct memo_entry *entry)
+{
+	if(entry->newer != NULL)
+		entry->newer->older = entry->older;
+	else
+		m->first = entry->older;
+
+	if(entry->older != NULL)
+		entry->older->newer = entry->newer;
+	else
+		m->last = entry->newer;
+}
+
+// evict the least recently used outcomes while the memo is full
+void evict_entries(struct memo *m)
+{
+	while(m->size > m->capacity && m->last != NULL)
+	{
+		struct memo_entry *evicted = m->last;
+		unlink_entry(m, evicted);
+
+		struct memo_entry **entry = &m->buckets[evicted->key.hash & (m->buckets_cnt - 1)];
+		while(*entry != evicted)
+			entry = &(*entry)->next;
+
+		*entry = evicted->next;
+
+		m->size -= entry_size(&evicted->key, &evicted->result);
+		m->entries_cnt--;
+		m->evictions++;
+
+		free_entry(evicted);
+	}
+}
+
+// double the buckets of the hash table
+void grow_buckets(struct memo *m)
+{
+	size_t buckets_cnt = m->buckets_cnt * 2;
+	struct memo_entry **buckets = ycalloc(buckets_cnt, sizeof(struct memo_entry *));
+
+	for(struct memo_entry *entry = m->first; entry != NULL; entry = entry->older)
+	{
+		struct memo_entry **bucket = &buckets[entry->key.hash & (buckets_cnt - 1)];
+		entry->next = *bucket;
+		*bucket = entry;
+	}
+
+	yfree(m->buckets);
+	m->buckets = buckets;
+	m->buckets_cnt = buckets_cnt;
+}
@@ -0,0 +1,340 @@
+
+// the threads are not part of the strict C99 environment, the atomic indices use the builtins of the GNU compilers
+#if (defined(__unix__) || defined(__APPLE__)) && defined(__GNUC__)
+#define YOG_OFFLOAD_THREADS
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+#include "offload.h"
+
+#ifdef YOG_OFFLOAD_THREADS
+// the indices written by the producer and by the consumer are kept on their own cache lines
+#define CACHE_LINE 64
+
+/*! @brief A single-producer single-consumer ring of values */
+struct offload_ring
+{
+	/*! @brief The values, indexed by the indices modulo the size of the ring */
+	int64_t values[OFFLOAD_RING_SIZE];
+
+	char head_pad[CACHE_LINE];
+
+	/*! @brief The index of the next value to produce, written by the producer only */
+	size_t head;
+
+	/*! @brief The last index of the next value to consume seen by the producer */
+	size_t cached_tail;
+
+	char tail_pad[CACHE_LINE];
+
+	/*! @brief The index of the next value to consume, written by the consumer only */
+	size_t tail;
+
+	/*! @brief The last index of the next value to produce seen by the consumer */
+	size_t cached_head;
+
+	char closed_pad[CACHE_LINE];
+
+	/*! @brief Set by the producer after its last value */
+	int closed;
+};
+
+struct offload_state
+{
+	/*! @brief The values parsed by the reader thread */
+	struct offload_ring input_ring;
+
+	/*! @brief The values formatted by the writer thread */
+	struct offload_ring output_ring;
+
+	/*! @brief The input parsed by the reader thread */
+	struct input input;
+
+	/*! @brief The output written by the writer thread */
+	struct output output;
+
+	/*! @brief How the input ended, set before the input ring is closed */
+	enum input_result input_end;
+
+	/*! @brief Set to stop the reader thread waiting for room in its ring */
+	int stop;
+
+	/*! @brief The thread of the input */
+	pthread_t reader;
+
+	/*! @brief The thread of the output */
+	pthread_t writer;
+};
+
+void *reader_main(void *data);
+void *writer_main(void *data);
+void ring_init(struct offload_ring *ring);
+bool ring_push(struct offload_ring *ring, int64_t value, const int *stop, uint64_t *stalls);
+void backoff(unsigned *spins);
+#endif
+
+bool offload_supported(void)
+{
+#ifdef YOG_OFFLOAD_THREADS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void offload_start(struct offload *off, struct interpreter *vm)
+{
+	off->vm = vm;
+	off->state = NULL;
+	off->read_stalls = 0;
+	off->write_stalls = 0;
+
+#ifdef YOG_OFFLOAD_THREADS
+	struct offload_state *state = ymalloc(sizeof(struct offload_state));
+	ring_init(&state->input_ring);
+	ring_init(&state->output_ring);
+	state->input_end = INPUT_END;
+	state->stop = 0;
+
+	// the streams are bound here, so the threads only parse and format the values
+	input_init(&state->input);
+	state->input.binary = vm->input.binary;
+	input_bind(&state->input, vm->in, false);
+
+	output_init(&state->output);
+	state->output.binary = vm->output.binary;
+	output_configure(&state->output, vm->output.capacity, vm->output.line_buffered);
+	output_bind(&state->output, vm->out, NULL);
+
+	// the writer starts first, so that it is stopped before it writes anything if the reader cannot start,
+	// and without the threads the interpreter reads and writes its streams itself
+	bool writer = pthread_create(&state->writer, NULL, writer_main, state) == 0;
+
+	if(!writer || pthread_create(&state->reader, NULL, reader_main, state) != 0)
+	{
+		if(writer)
+		{
+			__atomic_store_n(&state->output_ring.closed, 1, __ATOMIC_RELEASE);
+			pthread_join(state->writer, NULL);
+		}
+
+		input_clear(&state->input);
+		output_clear(&state->output);
+		yfree(state);
+		return;
+	}
+
+	off->state = state;
+	vm->offload = off;
+#endif
+}
+
+enum input_result offload_read(struct offload *off, int64_t *value)
+{
+#ifdef YOG_OFFLOAD_THREADS
+	struct offload_ring *ring = &off->state->input_ring;
+	size_t tail = ring->tail;
+
+	// the index of the producer is loaded again only once the values seen before are consumed
+	if(tail == ring->cached_head)
+	{
+		unsigned spins = 0;
+
+		while(tail == (ring->cached_head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)))
+		{
+			// the last values are produced before the ring is closed
+			if(__atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE))
+			{
+				ring->cached_head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+				if(tail == ring->cached_head)
+					return off->state->input_end;
+
+				break;
+			}
+
+			if(spins == 0)
+				off->read_stalls++;
+
+			backoff(&spins);
+		}
+	}
+
+	*value = ring->values[tail % OFFLOAD_RING_SIZE];
+	__atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+	return INPUT_VALUE;
+#else
+	(void)off;
+	(void)value;
+	return INPUT_END;
+#endif
+}
+
+void offload_write(struct offload *off, int64_t value)
+{
+#ifdef YOG_OFFLOAD_THREADS
+	ring_push(&off->state->output_ring, value, NULL, &off->write_stalls);
+#else
+	(void)off;
+	(void)value;
+#endif
+}
+
+void offload_stop(struct offload *off)
+{
+#ifdef YOG_OFFLOAD_THREADS
+	struct offload_state *state = off->state;
+
+	if(state == NULL)
+		return;
+
+	// the reader may wait for room in its ring or for its input, which is a cancellation point
+	__atomic_store_n(&state->stop, 1, __ATOMIC_RELEASE);
+	pthread_cancel(state->reader);
+	pthread_join(state->reader, NULL);
+
+	// the writer writes the values left in its ring before it ends
+	__atomic_store_n(&state->output_ring.closed, 1, __ATOMIC_RELEASE);
+	pthread_join(state->writer, NULL);
+
+	input_clear(&state->input);
+	output_clear(&state->output);
+
+	yfree(state);
+	off->state = NULL;
+	off->vm->offload = NULL;
+#else
+	(void)off;
+#endif
+}
+
+#ifdef YOG_OFFLOAD_THREADS
+// parse the values of the input into the input ring until the input ends or the offload stops
+void *reader_main(void *data)
+{
+	struct offload_state *state = data;
+	enum input_result result;
+	int64_t value;
+	unsigned spins = 0;
+
+	// a non-blocking input without a value yet is polled
+	while((result = input_int(&state->input, &value)) == INPUT_VALUE || result == INPUT_PENDING)
+	{
+		if(result == INPUT_PENDING)
+		{
+			if(__atomic_load_n(&state->stop, __ATOMIC_ACQUIRE))
+				return NULL;
+
+			backoff(&spins);
+			continue;
+		}
+
+		spins = 0;
+
+		if(!ring_push(&state->input_ring, value, &state->stop, NULL))
+			return NULL;
+	}
+
+	state->input_end = result;
+	__atomic_store_n(&state->input_ring.closed, 1, __ATOMIC_RELEASE);
+
+	return NULL;
+}
+
+// format the values of the output ring in batches, writing the output whenever the ring runs empty
+void *writer_main(void *data)
+{
+	struct offload_state *state = data;
+	struct offload_ring *ring = &state->output_ring;
+	unsigned spins = 0;
+
+	while(true)
+	{
+		size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		size_t tail = ring->tail;
+
+		if(tail == head)
+		{
+			// the values produced before the ring is closed are written before the writer ends
+			if(__atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE) && tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE))
+				break;
+
+			if(spins == 0)
+				output_flush(&state->output);
+
+			backoff(&spins);
+			continue;
+		}
+
+		for(; tail != head; tail++)
+			output_int(&state->output, ring->values[tail % OFFLOAD_RING_SIZE]);
+
+		__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+		spins = 0;
+	}
+
+	output_flush(&state->output);
+
+	return NULL;
+}
+
+void ring_init(struct offload_ring *ring)
+{
+	ring->head = 0;
+	ring->cached_tail = 0;
+	ring->tail = 0;
+	ring->cached_head = 0;
+	ring->closed = 0;
+}
+
+// produce a value, waiting while the ring is full, false if stopped while waiting
+bool ring_push(struct offload_ring *ring, int64_t value, const int *stop, uint64_t *stalls)
+{
+	size_t head = ring->head;
+
+	// the index of the consumer is loaded again only once the room seen before is filled
+	if(head - ring->cached_tail == OFFLOAD_RING_SIZE)
+	{
+		unsigned spins = 0;
+
+		while(head - (ring->cached_tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) == OFFLOAD_RING_SIZE)
+		{
+			if(stop != NULL && __atomic_load_n(stop, __ATOMIC_ACQUIRE))
+				return false;
+
+			if(spins == 0 && stalls != NULL)
+				(*stalls)++;
+
+			backoff(&spins);
+		}
+	}
+
+	ring->values[head % OFFLOAD_RING_SIZE] = value;
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+// spin shortly, then yield the processor, then sleep, so a long wait does not hold a processor
+void backoff(unsigned *spins)
+{
+	if(*spins < 64)
+	{
+		(*spins)++;
+	}
+	else if(*spins < 128)
+	{
+		(*spins)++;
+		sched_yield();
+	}
+	else
+	{
+		struct timespec pause = { 0, 50000 };
+		nanosleep(&pause, NULL);
+	}
+}
+#endif
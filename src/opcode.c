@@ -0,0 +1,23 @@
+
+#include "opcode.h"
+
+#define OPCODE_STR_0(name) #name,
+#define OPCODE_STR_1(name, k) #name "_" #k,
+#define OPCODE_STR_2(name, k1, k2) #name "_" #k1 #k2,
+
+const char *opcode_str(enum opcode op)
+{
+	static const char *const Opcode_Strings[OPCODE_HALT + 1] =
+	{
+		OPCODE_LIST(OPCODE_STR_0, OPCODE_STR_1, OPCODE_STR_2)
+		"HALT"
+	};
+
+	return Opcode_Strings[op];
+}
+
+bool opcode_is_jump(enum opcode op)
+{
+	// the jumps are the last operations of the list
+	return op == OPCODE_GOTO || op >= OPCODE_BRANCH;
+}
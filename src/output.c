@@ -0,0 +1,238 @@
+
+// the file descriptors are not part of the strict C99 environment
+#if defined(__unix__) || defined(__APPLE__)
+#define YOG_FILE_DESCRIPTORS
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#include "output.h"
+
+// the decimal digits of the numbers from 00 to 99, which format two digits at a time
+static const char Digit_Pairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+bool is_terminal(FILE *file);
+void write_chunk(struct output *out, const char *data, size_t size);
+
+void output_init(struct output *out)
+{
+	out->file = NULL;
+	out->fd = -1;
+	out->input = NULL;
+	out->flush_on_read = false;
+	out->flush_lines = false;
+	out->line_buffered = false;
+	out->binary = false;
+	out->buffer = NULL;
+	out->size = 0;
+	out->capacity = OUTPUT_BUFFER_SIZE;
+}
+
+void output_configure(struct output *out, size_t capacity, bool line_buffered)
+{
+	output_flush(out);
+
+	out->capacity = capacity > OUTPUT_BUFFER_MIN ? capacity : OUTPUT_BUFFER_MIN;
+	out->line_buffered = line_buffered;
+	out->flush_lines = line_buffered || is_terminal(out->file);
+
+	if(out->buffer != NULL)
+		out->buffer = yrealloc(out->buffer, out->capacity);
+}
+
+void output_bind(struct output *out, FILE *file, FILE *input)
+{
+	if(out->file == file && out->input == input)
+		return;
+
+	output_flush(out);
+
+	if(out->buffer == NULL)
+		out->buffer = ymalloc(out->capacity);
+
+	// the values written to the stream before are written first
+	fflush(file);
+
+	out->file = file;
+	out->fd = -1;
+	out->input = input;
+	out->flush_lines = out->line_buffered || is_terminal(file);
+	out->flush_on_read = input != NULL && is_terminal(input);
+
+#ifdef YOG_FILE_DESCRIPTORS
+	out->fd = fileno(file);
+#endif
+}
+
+void output_unbind(struct output *out)
+{
+	output_flush(out);
+
+	out->file = NULL;
+	out->fd = -1;
+	out->input = NULL;
+}
+
+void output_int(struct output *out, int64_t value)
+{
+	// a value takes at most 20 characters and the new line
+	if(out->capacity - out->size < 21)
+		output_flush(out);
+
+	if(out->binary)
+	{
+		// the bytes are stored in little-endian order, which the compilers turn into a store on little-endian targets
+		unsigned char *bytes = (unsigned char *)out->buffer + out->size;
+		uint64_t n = (uint64_t)value;
+
+		for(int i = 0; i < 8; i++)
+			bytes[i] = (unsigned char)(n >> 8 * i);
+
+		out->size += 8;
+
+		if(out->flush_lines)
+			output_flush(out);
+
+		return;
+	}
+
+	char digits[20];
+	size_t len = output_format(digits + sizeof(digits), value);
+
+	memcpy(out->buffer + out->size, digits + sizeof(digits) - len, len);
+	out->buffer[out->size + len] = '\n';
+	out->size += len + 1;
+
+	if(out->flush_lines)
+		output_flush(out);
+}
+
+void output_str(struct output *out, const char *str)
+{
+	size_t len = strlen(str);
+
+	if(out->capacity - out->size < len)
+	{
+		output_flush(out);
+
+		// a string longer than the buffer is written at once
+		if(len > out->capacity)
+		{
+			write_chunk(out, str, len);
+			return;
+		}
+	}
+
+	memcpy(out->buffer + out->size, str, len);
+	out->size += len;
+}
+
+void output_flush(struct output *out)
+{
+	if(out->size == 0)
+		return;
+
+	write_chunk(out, out->buffer, out->size);
+	out->size = 0;
+}
+
+int64_t output_tell(struct output *out)
+{
+	output_flush(out);
+
+#ifdef YOG_FILE_DESCRIPTORS
+	if(out->fd >= 0)
+		return lseek(out->fd, 0, SEEK_CUR);
+#endif
+
+	return ftell(out->file);
+}
+
+void output_clear(struct output *out)
+{
+	output_unbind(out);
+
+	yfree(out->buffer);
+	out->buffer = NULL;
+}
+
+size_t output_format(char *end, int64_t value)
+{
+	// the magnitude of the minimum value is not representable as int64_t
+	uint64_t n = value < 0 ? -(uint64_t)value : (uint64_t)value;
+	char *c = end;
+
+	while(n >= 100)
+	{
+		unsigned pair = (unsigned)(n % 100);
+		n /= 100;
+
+		c -= 2;
+		memcpy(c, Digit_Pairs + 2 * pair, 2);
+	}
+
+	if(n >= 10)
+	{
+		c -= 2;
+		memcpy(c, Digit_Pairs + 2 * n, 2);
+	}
+	else
+	{
+		*--c = (char)('0' + n);
+	}
+
+	if(value < 0)
+		*--c = '-';
+
+	return (size_t)(end - c);
+}
+
+bool is_terminal(FILE *file)
+{
+#ifdef YOG_FILE_DESCRIPTORS
+	return file != NULL && fileno(file) >= 0 && isatty(fileno(file));
+#else
+	(void)file;
+	return false;
+#endif
+}
+
+// write a chunk to the file descriptor, retrying the partial and the interrupted writes
+void write_chunk(struct output *out, const char *data, size_t size)
+{
+#ifdef YOG_FILE_DESCRIPTORS
+	if(out->fd >= 0)
+	{
+		while(size > 0)
+		{
+			ssize_t written = write(out->fd, data, size);
+
+			if(written < 0 && errno == EINTR)
+				continue;
+
+			// the chunk is dropped on a write error, as the standard streams do
+			if(written <= 0)
+				return;
+
+			data += written;
+			size -= written;
+		}
+
+		return;
+	}
+#endif
+
+	fwrite(data, 1, size, out->file);
+	fflush(out->file);
+}
@@ -30,6 +30,13 @@ void parse_context_init(struct parse_context *ctx, FILE *source, struct symbol_t
 	ctx->errs = errs;
 }
 
+void parse_context_init_buffer(struct parse_context *ctx, const char *buffer, size_t size, struct symbol_table *st, struct error_list *errs)
+{
+	lex_context_init_buffer(&ctx->lex_ctx, buffer, size, st, errs);
+
+	ctx->errs = errs;
+}
+
 struct ast *parse(struct parse_context *ctx)
 {
 	// get the first token
@@ -0,0 +1,91 @@
+
+#include "peephole.h"
+
+#define SUPERINSTRUCTION_ROW_2(a, b) { OPCODE_##a, OPCODE_##b },
+#define SUPERINSTRUCTION_ROW_3(a, b, c) { OPCODE_##a, OPCODE_##b, OPCODE_##c },
+
+// the operations of the superinstructions terminated by a halt row
+static const enum opcode Pairs[][2] =
+{
+	SUPERINSTRUCTION_PAIRS(SUPERINSTRUCTION_ROW_2)
+	{ OPCODE_HALT, OPCODE_HALT }
+};
+
+static const enum opcode Triples[][3] =
+{
+	SUPERINSTRUCTION_TRIPLES(SUPERINSTRUCTION_ROW_3)
+	{ OPCODE_HALT, OPCODE_HALT, OPCODE_HALT }
+};
+
+// the triples follow the pairs in the superinstruction enumeration
+#define PAIRS_CNT (sizeof(Pairs) / sizeof(Pairs[0]) - 1)
+
+void combine_superinstructions(struct instruction_list instrs)
+{
+	for(size_t i = 0; i < instrs.size; i++)
+	{
+		struct instruction *instr = &instrs.data[i];
+		instr->super = SUPERINSTRUCTION_NONE;
+
+		// only the last operation of a sequence may be a jump
+		if(opcode_is_jump(instr[0].op))
+			continue;
+
+		// prefer the longest sequence
+		if(i + 2 < instrs.size && !opcode_is_jump(instr[1].op))
+		{
+			for(size_t j = 0; Triples[j][0] != OPCODE_HALT && instr->super == SUPERINSTRUCTION_NONE; j++)
+			{
+				if(instr[0].op == Triples[j][0] && instr[1].op == Triples[j][1] && instr[2].op == Triples[j][2])
+					instr->super = SUPERINSTRUCTION_NONE + 1 + PAIRS_CNT + j;
+			}
+		}
+
+		if(i + 1 < instrs.size)
+		{
+			for(size_t j = 0; Pairs[j][0] != OPCODE_HALT && instr->super == SUPERINSTRUCTION_NONE; j++)
+			{
+				if(instr[0].op == Pairs[j][0] && instr[1].op == Pairs[j][1])
+					instr->super = SUPERINSTRUCTION_NONE + 1 + j;
+			}
+		}
+	}
+}
+
+size_t superinstruction_length(enum superinstruction super)
+{
+	if(super == SUPERINSTRUCTION_NONE)
+		return 1;
+
+	return super <= PAIRS_CNT ? 2 : 3;
+}
+
+enum opcode superinstruction_operation(enum superinstruction super, size_t k)
+{
+	if(super <= PAIRS_CNT)
+		return Pairs[super - 1][k];
+
+	return Triples[super - 1 - PAIRS_CNT][k];
+}
+
+void write_sequence_profile(FILE *out, struct instruction_list instrs, const uint64_t *counts)
+{
+	for(size_t i = 0; i < instrs.size; i++)
+	{
+		// only the sequences falling through are executed as a whole
+		if(counts[i] == 0 || opcode_is_jump(instrs.data[i].op))
+			continue;
+
+		if(i + 1 < instrs.size)
+		{
+			fprintf(out, "%llu %s %s\n", (unsigned long long)counts[i],
+				opcode_str(instrs.data[i].op), opcode_str(instrs.data[i+1].op));
+		}
+
+		if(i + 2 < instrs.size && !opcode_is_jump(instrs.data[i+1].op))
+		{
+			fprintf(out, "%llu %s %s %s\n", (unsigned long long)counts[i],
+				opcode_str(instrs.data[i].op), opcode_str(instrs.data[i+1].op), opcode_str(instrs.data[i+2].op));
+		}
+	}
+}
@@ -0,0 +1,261 @@
+#include "profiler.h"
+
+// the profile of a source line or of a loop
+struct profile_entry
+{
+	size_t first_row;
+	size_t last_row;
+	uint64_t cost;
+	uint64_t executions;
+};
+
+// a folded stack and its cost
+struct folded_stack
+{
+	char *frames;
+	uint64_t cost;
+};
+
+int compare_entries(const void *a, const void *b);
+int compare_stacks(const void *a, const void *b);
+char **read_source_lines(const char *filename, size_t rows_cnt);
+void write_entries(FILE *out, struct profile_entry *entries, size_t entries_cnt, uint64_t total, bool executions, char **source);
+
+void profile_report(FILE *out, const struct bytecode *bc, struct line_table lines,
+	const uint64_t *costs, const char *unit, const uint64_t *counts, const char *filename)
+{
+	size_t rows_cnt = 1;
+	uint64_t total = 0;
+
+	for(size_t i = 0; i < lines.size; i++)
+	{
+		if(lines.entries[i].loc.row >= rows_cnt)
+			rows_cnt = lines.entries[i].loc.row + 1;
+	}
+
+	// attribute the cost of the instructions to their source lines, row 0 collects the unknown ones
+	struct profile_entry *rows = ycalloc(rows_cnt, sizeof(struct profile_entry));
+	struct location *locs = ymalloc(bc->size * sizeof(struct location));
+
+	for(size_t i = 0; i < rows_cnt; i++)
+		rows[i].first_row = rows[i].last_row = i;
+
+	for(size_t pc = 0; pc < bc->size; pc++)
+	{
+		locs[pc] = line_table_find(lines, pc);
+		rows[locs[pc].row].cost += costs[pc];
+		rows[locs[pc].row].executions += counts != NULL ? counts[pc] : 0;
+		total += costs[pc];
+	}
+
+	// the loops are closed by their back-edges, whose executions are the iterations
+	struct profile_entry *loops = ymalloc(bc->size * sizeof(struct profile_entry));
+	size_t loops_cnt = 0;
+
+	for(size_t pc = 0; pc < bc->size; pc++)
+	{
+		if(!opcode_is_jump(bc->code[pc].op) || bc->code[pc].dest > pc)
+			continue;
+
+		struct profile_entry *loop = &loops[loops_cnt++];
+		loop->first_row = SIZE_MAX;
+		loop->last_row = 0;
+		loop->cost = 0;
+		loop->executions = counts != NULL ? counts[pc] : 0;
+
+		for(size_t i = bc->code[pc].dest; i <= pc; i++)
+		{
+			loop->cost += costs[i];
+
+			if(locs[i].row != 0 && locs[i].row < loop->first_row)
+				loop->first_row = locs[i].row;
+
+			if(locs[i].row > loop->last_row)
+				loop->last_row = locs[i].row;
+		}
+
+		if(loop->first_row == SIZE_MAX)
+			loop->first_row = 0;
+	}
+
+	char **source = read_source_lines(filename, rows_cnt);
+
+	qsort(rows, rows_cnt, sizeof(struct profile_entry), compare_entries);
+	qsort(loops, loops_cnt, sizeof(struct profile_entry), compare_entries);
+
+	fprintf(out, "hottest lines (cost in %s, %llu in total):\n", unit, (unsigned long long)total);
+	fprintf(out, "%12s %20s %7s %20s\n", "line", "cost", "share", counts != NULL ? "instructions" : "");
+	write_entries(out, rows, rows_cnt, total, counts != NULL, source);
+
+	fprintf(out, "hottest loops:\n");
+	fprintf(out, "%12s %20s %7s %20s\n", "lines", "cost", "share", counts != NULL ? "back-edges" : "");
+	write_entries(out, loops, loops_cnt, total, counts != NULL, source);
+
+	if(source != NULL)
+	{
+		for(size_t i = 0; i < rows_cnt; i++)
+			yfree(source[i]);
+
+		yfree(source);
+	}
+
+	yfree(loops);
+	yfree(locs);
+	yfree(rows);
+}
+
+void profile_write_folded(FILE *out, const struct bytecode *bc, struct line_table lines, const uint64_t *costs, const char *name)
+{
+	struct folded_stack *stacks = ymalloc(bc->size * sizeof(struct folded_stack));
+	size_t stacks_cnt = 0;
+
+	for(size_t pc = 0; pc < bc->size; pc++)
+	{
+		if(costs[pc] == 0)
+			continue;
+
+		size_t len = strlen(name);
+		size_t capacity = len + 64;
+		char *frames = ymalloc(capacity);
+		strcpy(frames, name);
+
+		// the loops enclosing the instruction, from the outermost one, i.e. from the longest one
+		size_t outer = 0;
+
+		while(true)
+		{
+			size_t back_edge = SIZE_MAX;
+
+			for(size_t i = pc; i < bc->size; i++)
+			{
+				const struct bytecode_instruction *instr = &bc->code[i];
+
+				if(opcode_is_jump(instr->op) && instr->dest <= pc && i - instr->dest < outer - 1)
+				{
+					if(back_edge == SIZE_MAX || i - instr->dest > back_edge - bc->code[back_edge].dest)
+						back_edge = i;
+				}
+			}
+
+			if(back_edge == SIZE_MAX)
+				break;
+
+			outer = back_edge - bc->code[back_edge].dest + 1;
+
+			if(len + 32 > capacity)
+			{
+				capacity = 2 * capacity;
+				frames = yrealloc(frames, capacity);
+			}
+
+			len += sprintf(frames + len, ";loop:%zu", line_table_find(lines, back_edge).row);
+		}
+
+		if(len + 32 > capacity)
+			frames = yrealloc(frames, len + 32);
+
+		sprintf(frames + len, ";line:%zu", line_table_find(lines, pc).row);
+
+		stacks[stacks_cnt].frames = frames;
+		stacks[stacks_cnt].cost = costs[pc];
+		stacks_cnt++;
+	}
+
+	// merge the instructions with the same stack
+	qsort(stacks, stacks_cnt, sizeof(struct folded_stack), compare_stacks);
+
+	for(size_t i = 0; i < stacks_cnt; i++)
+	{
+		uint64_t cost = stacks[i].cost;
+
+		while(i + 1 < stacks_cnt && strcmp(stacks[i].frames, stacks[i + 1].frames) == 0)
+		{
+			yfree(stacks[i].frames);
+			cost += stacks[++i].cost;
+		}
+
+		fprintf(out, "%s %llu\n", stacks[i].frames, (unsigned long long)cost);
+		yfree(stacks[i].frames);
+	}
+
+	yfree(stacks);
+}
+
+// sort by decreasing cost, then by increasing row
+int compare_entries(const void *a, const void *b)
+{
+	const struct profile_entry *x = a;
+	const struct profile_entry *y = b;
+
+	if(x->cost != y->cost)
+		return x->cost < y->cost ? 1 : -1;
+
+	return (x->first_row > y->first_row) - (x->first_row < y->first_row);
+}
+
+int compare_stacks(const void *a, const void *b)
+{
+	return strcmp(((const struct folded_stack *)a)->frames, ((const struct folded_stack *)b)->frames);
+}
+
+// read the first lines of the source file without their newlines, NULL if it cannot be read
+char **read_source_lines(const char *filename, size_t rows_cnt)
+{
+	FILE *file = fopen(filename, "r");
+	if(!file)
+		return NULL;
+
+	// the rows start from 1
+	char **source = ycalloc(rows_cnt, sizeof(char *));
+	char line[256];
+	size_t row = 1;
+
+	while(row < rows_cnt && fgets(line, sizeof(line), file) != NULL)
+	{
+		size_t len = strlen(line);
+
+		// skip the rest of a long line
+		if(len > 0 && line[len - 1] != '\n' && !feof(file))
+		{
+			int c;
+			while((c = fgetc(file)) != EOF && c != '\n');
+		}
+
+		line[strcspn(line, "\r\n")] = '\0';
+
+		// remove the indentation
+		source[row++] = ystrdup(line + strspn(line, " \t"));
+	}
+
+	fclose(file);
+
+	return source;
+}
+
+void write_entries(FILE *out, struct profile_entry *entries, size_t entries_cnt, uint64_t total, bool executions, char **source)
+{
+	for(size_t i = 0; i < entries_cnt && i < PROFILE_REPORT_SIZE && entries[i].cost > 0; i++)
+	{
+		struct profile_entry *entry = &entries[i];
+		char rows[32];
+
+		if(entry->first_row == 0)
+			snprintf(rows, sizeof(rows), "?");
+		else if(entry->first_row == entry->last_row)
+			snprintf(rows, sizeof(rows), "%zu", entry->first_row);
+		else
+			snprintf(rows, sizeof(rows), "%zu-%zu", entry->first_row, entry->last_row);
+
+		fprintf(out, "%12s %20llu %6.2f%%", rows, (unsigned long long)entry->cost, 100.0 * entry->cost / (total > 0 ? total : 1));
+
+		if(executions)
+			fprintf(out, " %20llu", (unsigned long long)entry->executions);
+		else
+			fprintf(out, " %20s", "");
+
+		if(source != NULL && entry->first_row != 0 && source[entry->first_row] != NULL)
+			fprintf(out, "  %.60s", source[entry->first_row]);
+
+		fprintf(out, "\n");
+	}
+}
@@ -0,0 +1,108 @@
+
+#include "regalloc.h"
+
+#define UNUSED SIZE_MAX
+
+size_t allocate_temporaries(struct instruction_list instrs, size_t tmp_cnt)
+{
+	// the indices of the instructions defining and last using each temporary
+	size_t *def = ymalloc(tmp_cnt * sizeof(size_t));
+	size_t *last = ymalloc(tmp_cnt * sizeof(size_t));
+
+	// the number of jump targets before each instruction
+	size_t *targets = ycalloc(instrs.size + 2, sizeof(size_t));
+
+	for(size_t i = 0; i < tmp_cnt; i++)
+	{
+		def[i] = UNUSED;
+		last[i] = UNUSED;
+	}
+
+	for(size_t i = 0; i < instrs.size; i++)
+	{
+		struct instruction instr = instrs.data[i];
+		size_t src_cnt = instruction_src_cnt(instr.type);
+
+		if(src_cnt >= 1 && instr.src1.type == OPERAND_TEMPORARY)
+			last[instr.src1.index] = i;
+
+		if(src_cnt >= 2 && instr.src2.type == OPERAND_TEMPORARY)
+			last[instr.src2.index] = i;
+
+		if(instr.dest.type == OPERAND_TEMPORARY && instruction_has_dest(instr.type))
+		{
+			def[instr.dest.index] = i;
+			last[instr.dest.index] = i;
+		}
+		else if(instr.dest.type == OPERAND_LABEL && instruction_has_dest(instr.type))
+		{
+			targets[instr.dest.index + 1]++;
+		}
+	}
+
+	for(size_t i = 1; i < instrs.size + 2; i++)
+		targets[i] += targets[i-1];
+
+	// the register of each temporary and the stack of the free registers
+	size_t *reg = ymalloc(tmp_cnt * sizeof(size_t));
+	size_t *free_regs = ymalloc(tmp_cnt * sizeof(size_t));
+	size_t free_cnt = 0;
+	size_t regs_cnt = 0;
+
+	for(size_t i = 0; i < instrs.size; i++)
+	{
+		struct instruction *instr = &instrs.data[i];
+		size_t src_cnt = instruction_src_cnt(instr->type);
+		struct operand *srcs[2] = { &instr->src1, &instr->src2 };
+
+		// rename the sources and release the registers of the temporaries used for the last time
+		for(size_t j = 0; j < src_cnt; j++)
+		{
+			if(srcs[j]->type != OPERAND_TEMPORARY)
+				continue;
+
+			size_t tmp = srcs[j]->index;
+			srcs[j]->index = reg[tmp];
+
+			if(last[tmp] == i)
+			{
+				free_regs[free_cnt++] = reg[tmp];
+				last[tmp] = UNUSED;
+			}
+		}
+
+		if(instr->dest.type != OPERAND_TEMPORARY || !instruction_has_dest(instr->type))
+			continue;
+
+		size_t tmp = instr->dest.index;
+
+		// a live range entered by a jump can not share its register
+		bool pinned = targets[last[tmp] + 1] - targets[def[tmp] + 1] > 0;
+
+		if(free_cnt > 0 && !pinned)
+			reg[tmp] = free_regs[--free_cnt];
+		else
+			reg[tmp] = regs_cnt++;
+
+		instr->dest.index = reg[tmp];
+
+		if(pinned)
+		{
+			last[tmp] = UNUSED;
+		}
+		else if(last[tmp] == i)
+		{
+			// the temporary is never used
+			free_regs[free_cnt++] = reg[tmp];
+			last[tmp] = UNUSED;
+		}
+	}
+
+	yfree(def);
+	yfree(last);
+	yfree(targets);
+	yfree(reg);
+	yfree(free_regs);
+
+	return regs_cnt;
+}
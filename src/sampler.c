@@ -0,0 +1,97 @@
+
+// the profiling timer is not part of the strict C99 environment
+#if defined(__unix__) || defined(__APPLE__)
+#define YOG_SAMPLER
+#define _DEFAULT_SOURCE
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+#include "sampler.h"
+
+// the interpreter interrupted by the timer signal
+static struct interpreter *volatile Sampled = NULL;
+
+void record_sample(struct interpreter *vm);
+
+#ifdef YOG_SAMPLER
+void sample_signal(int signo);
+#endif
+
+bool sampler_supported(void)
+{
+#ifdef YOG_SAMPLER
+	return true;
+#else
+	return false;
+#endif
+}
+
+void sampler_start(struct sampler *sampler, struct interpreter *vm, unsigned hz)
+{
+	yassert(Sampled == NULL, "only one sampler can be active");
+	yassert(hz > 0, "the sampling frequency must be positive");
+
+	sampler->size = vm->bc->size;
+	sampler->samples = ycalloc(sampler->size + 1, sizeof(uint64_t));
+	sampler->hz = hz;
+
+	interpreter_set_interrupt_handler(vm, record_sample, sampler, true);
+	Sampled = vm;
+
+#ifdef YOG_SAMPLER
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = sample_signal;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGPROF, &action, NULL);
+
+	// the timer counts the CPU time of the process, so the waits for input are not sampled
+	long period = hz < 1000000 ? 1000000 / hz : 1;
+
+	struct itimerval timer;
+	timer.it_interval.tv_sec = period / 1000000;
+	timer.it_interval.tv_usec = period % 1000000;
+	timer.it_value = timer.it_interval;
+	setitimer(ITIMER_PROF, &timer, NULL);
+#endif
+}
+
+void sampler_stop(struct sampler *sampler)
+{
+	(void)sampler;
+
+#ifdef YOG_SAMPLER
+	struct itimerval timer;
+	memset(&timer, 0, sizeof(timer));
+	setitimer(ITIMER_PROF, &timer, NULL);
+	signal(SIGPROF, SIG_IGN);
+#endif
+
+	Sampled = NULL;
+}
+
+void sampler_clear(struct sampler *sampler)
+{
+	yfree(sampler->samples);
+	sampler->samples = NULL;
+	sampler->size = 0;
+}
+
+// the interrupt handler, the program counter is the next instruction to execute
+void record_sample(struct interpreter *vm)
+{
+	struct sampler *sampler = vm->interrupt_data;
+	sampler->samples[vm->pc < sampler->size ? vm->pc : sampler->size]++;
+}
+
+#ifdef YOG_SAMPLER
+void sample_signal(int signo)
+{
+	(void)signo;
+
+	if(Sampled != NULL)
+		interpreter_interrupt(Sampled);
+}
+#endif
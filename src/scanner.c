@@ -47,6 +47,7 @@ enum char_class
 	CHAR_UNKNOW
 };
 
+int next_char(struct lex_context *ctx);
 void report_lexical_error(struct lex_context *ctx, struct location loc, char *text);
 void update_cursor(struct location *loc, char c);
 enum char_class identify_char(char c);
@@ -58,6 +59,9 @@ struct token make_token_paren(char *text, struct location loc);
 void lex_context_init(struct lex_context *ctx, FILE *source, struct symbol_table *st, struct error_list *errs)
 {
 	ctx->source = source;
+	ctx->buffer = NULL;
+	ctx->buffer_size = 0;
+	ctx->buffer_pos = 0;
 	ctx->lookahead = '\0';
 	ctx->loc.row = 1;
 	ctx->loc.col = 1;
@@ -65,6 +69,14 @@ void lex_context_init(struct lex_context *ctx, FILE *source, struct symbol_table
 	ctx->errs = errs;
 }
 
+void lex_context_init_buffer(struct lex_context *ctx, const char *buffer, size_t size, struct symbol_table *st, struct error_list *errs)
+{
+	lex_context_init(ctx, NULL, st, errs);
+
+	ctx->buffer = buffer;
+	ctx->buffer_size = size;
+}
+
 struct token lex(struct lex_context *ctx)
 {
 	char text[TEXT_SIZE] = { '\0' };
@@ -76,7 +88,7 @@ struct token lex(struct lex_context *ctx)
 	// get the first character
 	if(ctx->lookahead == '\0')
 	{
-		character = fgetc(ctx->source);
+		character = next_char(ctx);
 	}
 	else
 	{
@@ -134,7 +146,7 @@ struct token lex(struct lex_context *ctx)
 
 		update_cursor(&ctx->loc, character);
 
-		character = fgetc(ctx->source);
+		character = next_char(ctx);
 	}
 
 	// construct the result token
@@ -217,6 +229,17 @@ struct token lex(struct lex_context *ctx)
 	return result;
 }
 
+int next_char(struct lex_context *ctx)
+{
+	if(ctx->source != NULL)
+		return fgetc(ctx->source);
+
+	if(ctx->buffer_pos == ctx->buffer_size)
+		return EOF;
+
+	return (unsigned char)ctx->buffer[ctx->buffer_pos++];
+}
+
 void report_lexical_error(struct lex_context *ctx, struct location loc, char *text)
 {
 	error_list_add(ctx->errs, error_make_invalid_token(loc, text));
@@ -0,0 +1,629 @@
+
+// the readiness events and the threads are not part of the strict C99 environment
+#if defined(__linux__) && defined(__GNUC__)
+#define YOG_SCHEDULER_EPOLL
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+#include "scheduler.h"
+
+// the milliseconds an idle worker waits for the readiness events before it looks for sessions to steal again
+#define IDLE_TIMEOUT 100
+
+/*! @brief A session, i.e. an execution of the program over its own streams */
+struct scheduler_session
+{
+	/*! @brief The interpreter of the session, which keeps its program counter and its frame while it waits */
+	struct interpreter vm;
+
+	/*! @brief The data of the completion callback */
+	void *data;
+
+	/*! @brief The number of instructions the session may retire, UINT64_MAX if unlimited */
+	uint64_t fuel;
+
+	/*! @brief The flags of the input before it was made non-blocking, restored when the session is completed */
+	int input_flags;
+
+	/*! @brief Set once the input is registered for the readiness events */
+	bool registered;
+
+	/*! @brief Set while the session waits for its input, which publishes its state to the worker resuming it */
+	int waiting;
+
+	/*! @brief The next session of the run queue */
+	struct scheduler_session *next;
+
+	/*! @brief The previous session among the sessions not completed */
+	struct scheduler_session *prev_active;
+
+	/*! @brief The next session among the sessions not completed */
+	struct scheduler_session *next_active;
+};
+
+/*! @brief How an execution of a session stopped */
+enum session_outcome
+{
+	SESSION_WAITS,
+	SESSION_YIELDS,
+	SESSION_ENDS
+};
+
+#ifdef YOG_SCHEDULER_EPOLL
+/*! @brief A worker of the pool, which executes the sessions of its run queue */
+struct scheduler_worker
+{
+	/*! @brief The thread of the worker */
+	pthread_t thread;
+
+	/*! @brief The lock of the run queue */
+	pthread_mutex_t lock;
+
+	/*! @brief The first ready session, NULL if none */
+	struct scheduler_session *head;
+
+	/*! @brief The last ready session, NULL if none */
+	struct scheduler_session *tail;
+
+	/*! @brief The index of the worker */
+	size_t index;
+
+	/*! @brief The number of sessions suspended by the worker */
+	uint64_t suspensions;
+
+	/*! @brief The number of sessions stolen by the worker */
+	uint64_t steals;
+
+	/*! @brief A pointer to the scheduler */
+	struct scheduler *s;
+};
+
+struct scheduler_state
+{
+	/*! @brief The workers */
+	struct scheduler_worker *workers;
+
+	/*! @brief The readiness events of the inputs of the waiting sessions, shared by the workers */
+	int epoll;
+
+	/*! @brief The event which wakes an idle worker when a session is added or the scheduler stops */
+	int wakeup;
+
+	/*! @brief The lock of the sessions not completed */
+	pthread_mutex_t lock;
+
+	/*! @brief Signaled when all the sessions are completed */
+	pthread_cond_t idle;
+
+	/*! @brief The sessions not completed, NULL if none */
+	struct scheduler_session *active;
+
+	/*! @brief The number of sessions not completed */
+	size_t active_cnt;
+
+	/*! @brief The worker of the next added session */
+	size_t next_worker;
+
+	/*! @brief Set when the workers stop */
+	int stopping;
+};
+
+void *run_worker(void *arg);
+struct scheduler_session *take_session(struct scheduler_worker *worker);
+void queue_session(struct scheduler_worker *worker, struct scheduler_session *session);
+void collect_ready(struct scheduler_worker *worker, int timeout);
+bool session_wait(struct scheduler_state *state, struct scheduler_session *session);
+void wake_worker(struct scheduler_state *state);
+#endif
+
+struct scheduler_session *session_create(struct scheduler *s, const struct bytecode *bc, uint64_t fuel, bool binary_input,
+	bool binary_output, FILE *in, FILE *out, void *data);
+enum session_outcome session_run(struct scheduler *s, struct scheduler_session *session);
+void session_complete(struct scheduler *s, struct scheduler_session *session);
+uint64_t quantum_fuel(const struct scheduler *s, const struct scheduler_session *session);
+FILE *open_input(const char *filename, bool binary);
+void complete_job(void *data, struct interpreter *vm);
+
+bool scheduler_supported(void)
+{
+#ifdef YOG_SCHEDULER_EPOLL
+	return true;
+#else
+	return false;
+#endif
+}
+
+void scheduler_init(struct scheduler *s, const struct bytecode *bc, enum interpreter_dispatch dispatch, size_t workers_cnt)
+{
+	s->bc = bc;
+	s->dispatch = dispatch;
+	s->fuel = UINT64_MAX;
+	s->quantum = UINT64_MAX;
+	s->workers_cnt = workers_cnt > 0 ? workers_cnt : 1;
+	s->binary_input = false;
+	s->binary_output = false;
+	s->completed = NULL;
+	s->suspensions = 0;
+	s->steals = 0;
+	s->state = NULL;
+}
+
+void scheduler_start(struct scheduler *s)
+{
+#ifdef YOG_SCHEDULER_EPOLL
+	struct scheduler_state *state = ymalloc(sizeof(struct scheduler_state));
+
+	state->workers = ymalloc(s->workers_cnt * sizeof(struct scheduler_worker));
+	state->epoll = epoll_create1(EPOLL_CLOEXEC);
+	state->wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	state->active = NULL;
+	state->active_cnt = 0;
+	state->next_worker = 0;
+	state->stopping = 0;
+	pthread_mutex_init(&state->lock, NULL);
+	pthread_cond_init(&state->idle, NULL);
+
+	yassert(state->epoll >= 0 && state->wakeup >= 0, "failed to create the readiness events");
+
+	// the wakeup is edge-triggered, so each event wakes a single idle worker
+	struct epoll_event event;
+	event.events = EPOLLIN | EPOLLET;
+	event.data.ptr = NULL;
+	epoll_ctl(state->epoll, EPOLL_CTL_ADD, state->wakeup, &event);
+
+	s->state = state;
+
+	for(size_t w = 0; w < s->workers_cnt; w++)
+	{
+		struct scheduler_worker *worker = &state->workers[w];
+
+		worker->head = NULL;
+		worker->tail = NULL;
+		worker->index = w;
+		worker->suspensions = 0;
+		worker->steals = 0;
+		worker->s = s;
+		pthread_mutex_init(&worker->lock, NULL);
+	}
+
+	for(size_t w = 0; w < s->workers_cnt; w++)
+		pthread_create(&state->workers[w].thread, NULL, run_worker, &state->workers[w]);
+#else
+	(void)s;
+#endif
+}
+
+void scheduler_add(struct scheduler *s, FILE *in, FILE *out, void *data)
+{
+	scheduler_submit(s, s->bc, s->fuel, s->binary_input, s->binary_output, in, out, data);
+}
+
+void scheduler_submit(struct scheduler *s, const struct bytecode *bc, uint64_t fuel, bool binary_input, bool binary_output,
+	FILE *in, FILE *out, void *data)
+{
+	struct scheduler_session *session = session_create(s, bc, fuel, binary_input, binary_output, in, out, data);
+
+#ifdef YOG_SCHEDULER_EPOLL
+	struct scheduler_state *state = s->state;
+
+	// a read without a value suspends the session instead of blocking the worker
+	if(fileno(in) >= 0 && (session->input_flags = fcntl(fileno(in), F_GETFL)) >= 0)
+		fcntl(fileno(in), F_SETFL, session->input_flags | O_NONBLOCK);
+
+	pthread_mutex_lock(&state->lock);
+
+	session->next_active = state->active;
+	if(state->active != NULL)
+		state->active->prev_active = session;
+	state->active = session;
+	state->active_cnt++;
+
+	struct scheduler_worker *worker = &state->workers[state->next_worker++ % s->workers_cnt];
+
+	pthread_mutex_unlock(&state->lock);
+
+	queue_session(worker, session);
+	wake_worker(state);
+#else
+	// the session is executed to its end, its input blocks
+	while(session_run(s, session) != SESSION_ENDS)
+		continue;
+
+	session_complete(s, session);
+#endif
+}
+
+void scheduler_wait(struct scheduler *s)
+{
+#ifdef YOG_SCHEDULER_EPOLL
+	struct scheduler_state *state = s->state;
+
+	pthread_mutex_lock(&state->lock);
+
+	while(state->active_cnt > 0)
+		pthread_cond_wait(&state->idle, &state->lock);
+
+	pthread_mutex_unlock(&state->lock);
+#else
+	(void)s;
+#endif
+}
+
+void scheduler_stop(struct scheduler *s)
+{
+#ifdef YOG_SCHEDULER_EPOLL
+	struct scheduler_state *state = s->state;
+
+	__atomic_store_n(&state->stopping, 1, __ATOMIC_RELEASE);
+	wake_worker(state);
+
+	for(size_t w = 0; w < s->workers_cnt; w++)
+	{
+		pthread_join(state->workers[w].thread, NULL);
+		pthread_mutex_destroy(&state->workers[w].lock);
+
+		s->suspensions += state->workers[w].suspensions;
+		s->steals += state->workers[w].steals;
+	}
+
+	// the sessions which have not ended are completed where they stopped, those not waiting for their input as failed
+	while(state->active != NULL)
+	{
+		if(state->active->vm.status != INTERPRETER_NEEDS_INPUT)
+			state->active->vm.status = INTERPRETER_DEADLINE_EXCEEDED;
+
+		session_complete(s, state->active);
+	}
+
+	close(state->wakeup);
+	close(state->epoll);
+	pthread_cond_destroy(&state->idle);
+	pthread_mutex_destroy(&state->lock);
+	yfree(state->workers);
+	yfree(state);
+	s->state = NULL;
+#else
+	(void)s;
+#endif
+}
+
+int scheduler_execute(struct scheduler *s, const char **filenames, size_t cnt, FILE *out, FILE *err)
+{
+	struct batch_job *jobs = ycalloc(cnt, sizeof(struct batch_job));
+	void (*completed)(void *data, struct interpreter *vm) = s->completed;
+
+	s->completed = complete_job;
+	scheduler_start(s);
+
+	for(size_t i = 0; i < cnt; i++)
+	{
+		jobs[i].filename = filenames[i];
+		jobs[i].status = INTERPRETER_HALTED;
+
+		FILE *in = open_input(filenames[i], s->binary_input);
+		if(!in)
+		{
+			jobs[i].failed = true;
+			continue;
+		}
+
+#ifdef YOG_SCHEDULER_EPOLL
+		// the outputs are written in order once all the sessions have completed
+		scheduler_add(s, in, open_memstream(&jobs[i].output, &jobs[i].output_len), &jobs[i]);
+#else
+		scheduler_add(s, in, out, &jobs[i]);
+#endif
+	}
+
+	scheduler_wait(s);
+	scheduler_stop(s);
+	s->completed = completed;
+
+	int status = 0;
+
+	for(size_t i = 0; i < cnt; i++)
+	{
+		int job_status = batch_report(&jobs[i], out, err);
+		if(status == 0)
+			status = job_status;
+
+		free(jobs[i].output); // allocated by the output stream
+	}
+
+	yfree(jobs);
+
+	return status;
+}
+
+struct scheduler_session *session_create(struct scheduler *s, const struct bytecode *bc, uint64_t fuel, bool binary_input,
+	bool binary_output, FILE *in, FILE *out, void *data)
+{
+	struct scheduler_session *session = ymalloc(sizeof(struct scheduler_session));
+	struct interpreter *vm = &session->vm;
+
+	session->fuel = fuel;
+	session->input_flags = -1;
+
+	interpreter_init(vm, bc, s->dispatch);
+	vm->in = in;
+	vm->out = out;
+	vm->interactive = false;
+	vm->input.binary = binary_input;
+	vm->input.capacity = SCHEDULER_BUFFER_SIZE;
+	vm->output.binary = binary_output;
+	output_configure(&vm->output, SCHEDULER_BUFFER_SIZE, false);
+
+	if(fuel != UINT64_MAX || s->quantum != UINT64_MAX)
+		interpreter_limit(vm, quantum_fuel(s, session), 0);
+
+	session->data = data;
+	session->registered = false;
+	session->waiting = 0;
+	session->next = NULL;
+	session->prev_active = NULL;
+	session->next_active = NULL;
+
+	return session;
+}
+
+// execute a session until it ends, waits for its input or has executed its quantum
+enum session_outcome session_run(struct scheduler *s, struct scheduler_session *session)
+{
+	struct interpreter *vm = &session->vm;
+
+	if(session->fuel != UINT64_MAX || s->quantum != UINT64_MAX)
+		vm->fuel = quantum_fuel(s, session);
+
+	// the resumed execution continues from the instruction where it stopped
+	enum interpreter_status status = interpreter_execute(vm);
+
+	if(status == INTERPRETER_NEEDS_INPUT)
+		return SESSION_WAITS;
+
+	if(status == INTERPRETER_FUEL_EXHAUSTED && vm->retired < session->fuel)
+		return SESSION_YIELDS;
+
+	return SESSION_ENDS;
+}
+
+// pass a session which cannot be resumed to the completion callback and free it
+void session_complete(struct scheduler *s, struct scheduler_session *session)
+{
+#ifdef YOG_SCHEDULER_EPOLL
+	struct scheduler_state *state = s->state;
+
+	if(session->registered)
+		epoll_ctl(state->epoll, EPOLL_CTL_DEL, fileno(session->vm.in), NULL);
+
+	// the input may be shared with another process, e.g. the standard input of a client of the server
+	if(session->input_flags >= 0)
+		fcntl(fileno(session->vm.in), F_SETFL, session->input_flags);
+#endif
+
+	// the streams are released before the callback may close them
+	input_unbind(&session->vm.input);
+	output_unbind(&session->vm.output);
+
+	if(s->completed != NULL)
+		s->completed(session->data, &session->vm);
+
+#ifdef YOG_SCHEDULER_EPOLL
+	pthread_mutex_lock(&state->lock);
+
+	if(session->prev_active != NULL)
+		session->prev_active->next_active = session->next_active;
+	else
+		state->active = session->next_active;
+
+	if(session->next_active != NULL)
+		session->next_active->prev_active = session->prev_active;
+
+	if(--state->active_cnt == 0)
+		pthread_cond_broadcast(&state->idle);
+
+	pthread_mutex_unlock(&state->lock);
+#endif
+
+	interpreter_clear(&session->vm);
+	yfree(session);
+}
+
+// the fuel of a session up to the end of its next quantum
+uint64_t quantum_fuel(const struct scheduler *s, const struct scheduler_session *session)
+{
+	if(s->quantum == UINT64_MAX || session->fuel - session->vm.retired <= s->quantum)
+		return session->fuel;
+
+	return session->vm.retired + s->quantum;
+}
+
+// open an input without waiting for the writer of a FIFO
+FILE *open_input(const char *filename, bool binary)
+{
+#ifdef YOG_SCHEDULER_EPOLL
+	int fd = open(filename, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+	if(fd < 0)
+		return NULL;
+
+	FILE *in = fdopen(fd, binary ? "rb" : "r");
+	if(!in)
+		close(fd);
+
+	return in;
+#else
+	return fopen(filename, binary ? "rb" : "r");
+#endif
+}
+
+// record the outcome of the session of a job and close its streams
+void complete_job(void *data, struct interpreter *vm)
+{
+	struct batch_job *job = data;
+
+	job->status = vm->status;
+	job->pc = vm->pc;
+	job->retired = vm->retired;
+
+	fclose(vm->in);
+
+#ifdef YOG_SCHEDULER_EPOLL
+	fclose(vm->out);
+#endif
+}
+
+#ifdef YOG_SCHEDULER_EPOLL
+void *run_worker(void *arg)
+{
+	struct scheduler_worker *worker = arg;
+	struct scheduler *s = worker->s;
+	struct scheduler_state *state = s->state;
+
+	while(!__atomic_load_n(&state->stopping, __ATOMIC_ACQUIRE))
+	{
+		struct scheduler_session *session = take_session(worker);
+
+		if(session == NULL)
+		{
+			collect_ready(worker, IDLE_TIMEOUT);
+			continue;
+		}
+
+		switch(session_run(s, session))
+		{
+			case SESSION_WAITS:
+				worker->suspensions++;
+
+				// the session may be resumed by another worker as soon as it is registered
+				if(!session_wait(state, session))
+					queue_session(worker, session);
+				break;
+
+			case SESSION_YIELDS:
+				queue_session(worker, session);
+				break;
+
+			default: // case SESSION_ENDS:
+				session_complete(s, session);
+				break;
+		}
+
+		// the sessions whose input has arrived are queued behind the ready ones
+		collect_ready(worker, 0);
+	}
+
+	// the wakeup is passed on to the next idle worker
+	wake_worker(state);
+
+	return NULL;
+}
+
+// take the first ready session, or steal the first ready session of another worker
+struct scheduler_session *take_session(struct scheduler_worker *worker)
+{
+	struct scheduler_state *state = worker->s->state;
+	size_t workers_cnt = worker->s->workers_cnt;
+
+	for(size_t k = 0; k < workers_cnt; k++)
+	{
+		struct scheduler_worker *victim = &state->workers[(worker->index + k) % workers_cnt];
+
+		pthread_mutex_lock(&victim->lock);
+
+		struct scheduler_session *session = victim->head;
+
+		if(session != NULL)
+		{
+			victim->head = session->next;
+			if(victim->head == NULL)
+				victim->tail = NULL;
+		}
+
+		pthread_mutex_unlock(&victim->lock);
+
+		if(session != NULL)
+		{
+			if(k > 0)
+				worker->steals++;
+
+			session->next = NULL;
+			return session;
+		}
+	}
+
+	return NULL;
+}
+
+void queue_session(struct scheduler_worker *worker, struct scheduler_session *session)
+{
+	session->next = NULL;
+
+	pthread_mutex_lock(&worker->lock);
+
+	if(worker->tail != NULL)
+		worker->tail->next = session;
+	else
+		worker->head = session;
+
+	worker->tail = session;
+
+	pthread_mutex_unlock(&worker->lock);
+}
+
+// queue the sessions whose input is ready, waiting for them at most timeout milliseconds
+void collect_ready(struct scheduler_worker *worker, int timeout)
+{
+	struct scheduler_state *state = worker->s->state;
+	struct epoll_event events[SCHEDULER_EVENTS_CNT];
+
+	int cnt = epoll_wait(state->epoll, events, SCHEDULER_EVENTS_CNT, timeout);
+
+	for(int i = 0; i < cnt; i++)
+	{
+		if(events[i].data.ptr == NULL)
+		{
+			uint64_t value;
+			ssize_t result = read(state->wakeup, &value, sizeof(value));
+			(void)result;
+
+			continue;
+		}
+
+		// the kernel orders the registration before the event, the flag makes the order explicit to the race detectors
+		struct scheduler_session *session = events[i].data.ptr;
+		__atomic_load_n(&session->waiting, __ATOMIC_ACQUIRE);
+		session->waiting = 0;
+
+		queue_session(worker, session);
+	}
+}
+
+// register the input of a session for a single readiness event, false if it cannot be registered
+bool session_wait(struct scheduler_state *state, struct scheduler_session *session)
+{
+	struct epoll_event event;
+	event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+	event.data.ptr = session;
+
+	int op = session->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+	session->registered = true;
+	__atomic_store_n(&session->waiting, 1, __ATOMIC_RELEASE);
+
+	if(epoll_ctl(state->epoll, op, fileno(session->vm.in), &event) == 0)
+		return true;
+
+	session->registered = op == EPOLL_CTL_MOD;
+	return false;
+}
+
+void wake_worker(struct scheduler_state *state)
+{
+	uint64_t one = 1;
+	ssize_t result = write(state->wakeup, &one, sizeof(one));
+	(void)result;
+}
+#endif
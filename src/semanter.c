@@ -17,7 +17,7 @@ void analyse_repeat(struct semantic_context *ctx, struct ast *repeat);
 struct operand analyse_expression(struct semantic_context *ctx, struct ast *expression);
 struct operand analyse_term(struct semantic_context *ctx, struct ast *term);
 struct operand analyse_factor(struct semantic_context *ctx, struct ast *factor);
-struct operand analyse_condition(struct semantic_context *ctx, struct ast *condition);
+size_t analyse_condition(struct semantic_context *ctx, struct ast *condition, size_t target);
 
 void semantic_context_init(struct semantic_context *ctx, struct symbol_table *st, struct error_list *errs, struct ast *tree)
 {
@@ -26,7 +26,9 @@ void semantic_context_init(struct semantic_context *ctx, struct symbol_table *st
 	ctx->tree = tree;
 
 	instruction_list_init(&ctx->instrs);
+	line_table_init(&ctx->lines);
 
+	ctx->vars_cnt = 0;
 	ctx->tmp_cnt = 0;
 }
 
@@ -75,6 +77,7 @@ void analyse_variables(struct semantic_context *ctx, struct ast *variables)
 				{
 					id_tok.sym->type = SYMBOL_INTEGER;
 					id_tok.sym->loc = id_tok.loc;
+					id_tok.sym->slot = ctx->vars_cnt++;
 				}
 			}
 		}
@@ -87,6 +90,8 @@ void analyse_statements(struct semantic_context *ctx, struct ast *statements)
 	{
 		struct ast *stmt = statements->children[i];
 
+		line_table_add(&ctx->lines, ctx->instrs.size, ast_location(stmt));
+
 		switch(stmt->nt)
 		{
 			case AST_NT_ASSIGN:
@@ -168,60 +173,45 @@ void analyse_output(struct semantic_context *ctx, struct ast *output)
 
 void analyse_branch(struct semantic_context *ctx, struct ast *branch)
 {
-	struct instruction branch_instr;
-	branch_instr.type = INSTRUCTION_BRANCH;
-	branch_instr.src1 = analyse_condition(ctx, branch->children[2]);
-	branch_instr.dest.type = OPERAND_LABEL;
-	instruction_list_add(&ctx->instrs, branch_instr);
-
-	struct instruction *branch_instr_ptr = &ctx->instrs.data[ctx->instrs.size - 1];
+	// jump to the then statements if the condition holds, the else statements follow
+	size_t branch_index = analyse_condition(ctx, branch->children[2], 0);
 
 	analyse_statements(ctx, branch->children[7]);
 
+	line_table_add(&ctx->lines, ctx->instrs.size, ast_location(branch));
+
 	struct instruction goto_instr;
 	goto_instr.type = INSTRUCTION_GOTO;
 	goto_instr.dest.type = OPERAND_LABEL;
 	instruction_list_add(&ctx->instrs, goto_instr);
 
-	struct instruction *goto_instr_ptr = &ctx->instrs.data[ctx->instrs.size - 1];
+	size_t goto_index = ctx->instrs.size - 1;
 
-	branch_instr_ptr->dest.index = ctx->instrs.size;
+	ctx->instrs.data[branch_index].dest.index = ctx->instrs.size;
 
 	analyse_statements(ctx, branch->children[5]);
 
-	goto_instr_ptr->dest.index = ctx->instrs.size;
+	ctx->instrs.data[goto_index].dest.index = ctx->instrs.size;
 }
 
 void analyse_loop(struct semantic_context *ctx, struct ast *loop)
 {
-	size_t start_label = ctx->instrs.size;
-
-	struct instruction branch_instr;
-	branch_instr.type = INSTRUCTION_BRANCH;
-	branch_instr.src1 = analyse_condition(ctx, loop->children[2]);
-	branch_instr.dest.type = OPERAND_LABEL;
-	instruction_list_add(&ctx->instrs, branch_instr);
-
-	struct instruction *branch_instr_ptr = &ctx->instrs.data[ctx->instrs.size - 1];
-
-	struct instruction exit_instr;
-	exit_instr.type = INSTRUCTION_GOTO;
-	exit_instr.dest.type = OPERAND_LABEL;
-	instruction_list_add(&ctx->instrs, exit_instr);
-
-	struct instruction *exit_instr_ptr = &ctx->instrs.data[ctx->instrs.size - 1];
-
-	branch_instr_ptr->dest.index = ctx->instrs.size;
-
-	analyse_statements(ctx, loop->children[5]);
-
+	// the condition is placed after the body, so that each iteration executes a single branch
 	struct instruction goto_instr;
 	goto_instr.type = INSTRUCTION_GOTO;
 	goto_instr.dest.type = OPERAND_LABEL;
-	goto_instr.dest.index = start_label;
 	instruction_list_add(&ctx->instrs, goto_instr);
 
-	exit_instr_ptr->dest.index = ctx->instrs.size;
+	size_t goto_index = ctx->instrs.size - 1;
+	size_t body_label = ctx->instrs.size;
+
+	analyse_statements(ctx, loop->children[5]);
+
+	ctx->instrs.data[goto_index].dest.index = ctx->instrs.size;
+
+	line_table_add(&ctx->lines, ctx->instrs.size, ast_location(loop->children[2]));
+
+	analyse_condition(ctx, loop->children[2], body_label);
 }
 
 void analyse_repeat(struct semantic_context *ctx, struct ast *repeat)
@@ -230,13 +220,9 @@ void analyse_repeat(struct semantic_context *ctx, struct ast *repeat)
 
 	analyse_statements(ctx, repeat->children[1]);
 
-	struct instruction branch_instr;
-	branch_instr.type = INSTRUCTION_BRANCH;
-	branch_instr.src1 = analyse_condition(ctx, repeat->children[4]);
-	branch_instr.dest.type = OPERAND_LABEL;
-	branch_instr.dest.index = start_label;
+	line_table_add(&ctx->lines, ctx->instrs.size, ast_location(repeat->children[4]));
 
-	instruction_list_add(&ctx->instrs, branch_instr);
+	analyse_condition(ctx, repeat->children[4], start_label);
 }
 
 struct operand analyse_expression(struct semantic_context *ctx, struct ast *expression)
@@ -350,38 +336,39 @@ struct operand analyse_factor(struct semantic_context *ctx, struct ast *factor)
 	return opd;
 }
 
-struct operand analyse_condition(struct semantic_context *ctx, struct ast *condition)
+size_t analyse_condition(struct semantic_context *ctx, struct ast *condition, size_t target)
 {
+	// the condition is fused with the branch that it feeds
 	struct instruction instr;
 	instr.src1 = analyse_expression(ctx, condition->children[0]);
 	instr.src2 = analyse_expression(ctx, condition->children[2]);
-	instr.dest.type = OPERAND_TEMPORARY;
-	instr.dest.index = next_temporary(ctx);
+	instr.dest.type = OPERAND_LABEL;
+	instr.dest.index = target;
 
 	switch(condition->children[1]->tok.type)
 	{
 		case TOKEN_EQ:
-			instr.type = INSTRUCTION_EQ;
+			instr.type = INSTRUCTION_BEQ;
 			break;
 
 		case TOKEN_NEQ:
-			instr.type = INSTRUCTION_NEQ;
+			instr.type = INSTRUCTION_BNEQ;
 			break;
 
 		case TOKEN_LT:
-			instr.type = INSTRUCTION_LT;
+			instr.type = INSTRUCTION_BLT;
 			break;
 
 		case TOKEN_LTE:
-			instr.type = INSTRUCTION_LTE;
+			instr.type = INSTRUCTION_BLTE;
 			break;
 
 		case TOKEN_GT:
-			instr.type = INSTRUCTION_GT;
+			instr.type = INSTRUCTION_BGT;
 			break;
 
 		case TOKEN_GTE:
-			instr.type = INSTRUCTION_GTE;
+			instr.type = INSTRUCTION_BGTE;
 			break;
 
 		default:
@@ -391,6 +378,5 @@ struct operand analyse_condition(struct semantic_context *ctx, struct ast *condi
 
 	instruction_list_add(&ctx->instrs, instr);
 
-	return instr.dest;
+	return ctx->instrs.size - 1;
 }
-
@@ -0,0 +1,845 @@
+
+// the sockets, the signals and the threads are not part of the strict C99 environment
+#if defined(__unix__) || defined(__APPLE__)
+#define YOG_SERVER_SOCKETS
+#define _POSIX_C_SOURCE 200809L
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#endif
+
+#include "server.h"
+#include "compiler.h"
+#include "yogc.h"
+
+/*! @brief The header of a request, followed by the source code of the program, sent with the standard input and output of the client */
+struct server_request_header
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t fuel;
+	uint64_t flags;
+	uint64_t source_len;
+};
+
+/*! @brief The header of a reply, followed by the message of the runtime error */
+struct server_reply_header
+{
+	char magic[4];
+	uint32_t status;
+	uint64_t message_len;
+};
+
+// the flags of the formats of the input and of the output
+#define FLAG_BINARY_INPUT 1
+#define FLAG_BINARY_OUTPUT 2
+
+/*! @brief A compiled program of the cache */
+struct server_program
+{
+	/*! @brief The hash of the source code */
+	uint64_t hash;
+
+	/*! @brief The source code, compared on a match of the hash */
+	char *source;
+
+	/*! @brief The number of characters of the source code */
+	size_t source_len;
+
+	/*! @brief The bytecode of the program */
+	struct bytecode bc;
+
+	/*! @brief The source locations of the instructions */
+	struct line_table lines;
+
+	/*! @brief The number of requests executing the program, which is not evicted while any */
+	size_t refs;
+
+	/*! @brief The time of the last request of the program, in requests */
+	uint64_t used;
+
+	/*! @brief The next program of the cache */
+	struct server_program *next;
+};
+
+#ifdef YOG_SERVER_SOCKETS
+struct server_state
+{
+	/*! @brief The listening socket */
+	int listener;
+
+	/*! @brief The scheduler of the requests */
+	struct scheduler scheduler;
+
+	/*! @brief The lock of the cache, whose programs are released by the workers */
+	pthread_mutex_t lock;
+
+	/*! @brief The compiled programs, NULL if none */
+	struct server_program *programs;
+
+	/*! @brief The number of compiled programs */
+	size_t programs_cnt;
+
+	/*! @brief The number of requests of the cached programs, the time of the cache */
+	uint64_t clock;
+
+	/*! @brief The number of connections whose request is received by their own thread, under the lock */
+	size_t receivers_cnt;
+
+	/*! @brief Signaled when the last receiving thread ends */
+	pthread_cond_t received;
+};
+
+/*! @brief A connection whose request is received and compiled by its own thread, off the accepting thread */
+struct server_receiver
+{
+	/*! @brief The socket of the client */
+	int conn;
+
+	/*! @brief A pointer to the server */
+	struct server *srv;
+
+	/*! @brief A pointer to the state of the server */
+	struct server_state *state;
+};
+
+/*! @brief A request executed by the scheduler */
+struct server_connection
+{
+	/*! @brief The socket of the client, which the reply is sent to */
+	int conn;
+
+	/*! @brief The program of the request */
+	struct server_program *program;
+
+	/*! @brief A pointer to the state of the server */
+	struct server_state *state;
+};
+
+// set by SIGINT and SIGTERM
+static volatile sig_atomic_t Stopping = 0;
+
+void accept_connection(struct server *srv, struct server_state *state, int conn);
+void *receive_connection(void *arg);
+void serve_connection(struct server *srv, struct server_state *state, int conn);
+bool receive_request(int conn, struct server_request_header *header, int fds[2]);
+bool receive_all(int conn, void *data, size_t size);
+bool send_all(int conn, const void *data, size_t size);
+void send_reply(int conn, int status, const char *message);
+struct server_program *acquire_program(struct server *srv, struct server_state *state, char *source, size_t size, FILE *errors);
+void release_program(struct server_state *state, struct server_program *program);
+void evict_programs(struct server_state *state);
+void free_program(struct server_program *program);
+void complete_request(void *data, struct interpreter *vm);
+int describe_outcome(char *message, const struct interpreter *vm, struct line_table lines);
+void remove_stale_socket(const char *path);
+void stop_signal(int signo);
+#endif
+
+bool server_supported(void)
+{
+#ifdef YOG_SERVER_SOCKETS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void server_init(struct server *srv, const char *path, enum interpreter_dispatch dispatch, size_t workers_cnt)
+{
+	srv->path = path;
+	srv->dispatch = dispatch;
+	srv->workers_cnt = workers_cnt > 0 ? workers_cnt : 1;
+	srv->fuel = SERVER_FUEL;
+	srv->quantum = SERVER_QUANTUM;
+	srv->requests = 0;
+	srv->compilations = 0;
+	srv->suspensions = 0;
+	srv->state = NULL;
+}
+
+int server_serve(struct server *srv, FILE *err)
+{
+#ifdef YOG_SERVER_SOCKETS
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+
+	if(strlen(srv->path) >= sizeof(addr.sun_path))
+	{
+		fprintf(err, "the socket path %s is too long\n", srv->path);
+		return 2;
+	}
+
+	strcpy(addr.sun_path, srv->path);
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(listener < 0)
+	{
+		fprintf(err, "failed to create the socket %s\n", srv->path);
+		return 2;
+	}
+
+	remove_stale_socket(srv->path);
+
+	// only the user of the server may connect to it, the requests read and write the files of their clients
+	mode_t mask = umask(077);
+	bool bound = bind(listener, (struct sockaddr *)&addr, sizeof(addr)) == 0 && listen(listener, SOMAXCONN) == 0;
+	umask(mask);
+
+	if(!bound)
+	{
+		fprintf(err, "failed to bind the socket %s\n", srv->path);
+		close(listener);
+		return 2;
+	}
+
+	// the listener is polled, so a client which goes away before it is accepted does not block the server
+	fcntl(listener, F_SETFD, FD_CLOEXEC);
+	fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+
+	struct server_state *state = ymalloc(sizeof(struct server_state));
+	state->listener = listener;
+	state->programs = NULL;
+	state->programs_cnt = 0;
+	state->clock = 0;
+	state->receivers_cnt = 0;
+	pthread_mutex_init(&state->lock, NULL);
+	pthread_cond_init(&state->received, NULL);
+	srv->state = state;
+
+	// the signals are delivered to the main thread only, while it waits for a connection
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = stop_signal;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+
+	// a client which goes away makes the writes to its socket or to its output fail instead of stopping the server
+	signal(SIGPIPE, SIG_IGN);
+
+	sigset_t blocked, unblocked;
+	sigemptyset(&blocked);
+	sigaddset(&blocked, SIGINT);
+	sigaddset(&blocked, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &blocked, &unblocked);
+
+	Stopping = 0;
+
+	scheduler_init(&state->scheduler, NULL, srv->dispatch, srv->workers_cnt);
+	state->scheduler.quantum = srv->quantum;
+	state->scheduler.completed = complete_request;
+	scheduler_start(&state->scheduler);
+
+	while(!Stopping)
+	{
+		fd_set ready;
+		FD_ZERO(&ready);
+		FD_SET(listener, &ready);
+
+		// the signals are unblocked only while waiting, so a signal is never missed
+		if(pselect(listener + 1, &ready, NULL, NULL, NULL, &unblocked) <= 0)
+			continue;
+
+		int conn = accept(listener, NULL, NULL);
+		if(conn >= 0)
+			accept_connection(srv, state, conn);
+	}
+
+	close(listener);
+	unlink(srv->path);
+
+	// the requests being received are submitted before the scheduler stops, each within the timeout of its client
+	pthread_mutex_lock(&state->lock);
+
+	while(state->receivers_cnt > 0)
+		pthread_cond_wait(&state->received, &state->lock);
+
+	pthread_mutex_unlock(&state->lock);
+
+	// the requests waiting for their input end as if their input had ended, the others as if their deadline had passed
+	scheduler_stop(&state->scheduler);
+	srv->suspensions = state->scheduler.suspensions;
+
+	pthread_sigmask(SIG_SETMASK, &unblocked, NULL);
+	signal(SIGINT, SIG_DFL);
+	signal(SIGTERM, SIG_DFL);
+	signal(SIGPIPE, SIG_DFL);
+
+	while(state->programs != NULL)
+	{
+		struct server_program *program = state->programs;
+		state->programs = program->next;
+		free_program(program);
+	}
+
+	pthread_cond_destroy(&state->received);
+	pthread_mutex_destroy(&state->lock);
+	yfree(state);
+	srv->state = NULL;
+
+	return 0;
+#else
+	fprintf(err, "the server is not supported on this platform\n");
+	return 2;
+#endif
+}
+
+int server_request(const char *path, const char *filename, uint64_t fuel, bool binary_input, bool binary_output, FILE *err)
+{
+#ifdef YOG_SERVER_SOCKETS
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+
+	if(strlen(path) >= sizeof(addr.sun_path))
+	{
+		fprintf(err, "the socket path %s is too long\n", path);
+		return 2;
+	}
+
+	strcpy(addr.sun_path, path);
+
+	size_t size;
+	char *source = yread_file(filename, &size);
+	if(!source)
+	{
+		fprintf(err, "failed to open %s\n", filename);
+		return 2;
+	}
+
+	int conn = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(conn < 0 || connect(conn, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+	{
+		fprintf(err, "failed to connect to %s\n", path);
+
+		if(conn >= 0)
+			close(conn);
+
+		yfree(source);
+		return 2;
+	}
+
+	struct server_request_header header;
+	memset(&header, 0, sizeof(header));
+
+	memcpy(header.magic, "YOGQ", 4);
+	header.version = SERVER_VERSION;
+	header.fuel = fuel;
+	header.source_len = size;
+	header.flags = (binary_input ? FLAG_BINARY_INPUT : 0) | (binary_output ? FLAG_BINARY_OUTPUT : 0);
+
+	// the standard input and output are passed with the header, the server reads and writes them directly
+	int fds[2] = { STDIN_FILENO, STDOUT_FILENO };
+
+	union
+	{
+		struct cmsghdr align;
+		char buffer[CMSG_SPACE(sizeof(fds))];
+	} control;
+
+	memset(&control, 0, sizeof(control));
+
+	struct iovec iov;
+	iov.iov_base = &header;
+	iov.iov_len = sizeof(header);
+
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buffer;
+	msg.msg_controllen = sizeof(control.buffer);
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+	// a server which goes away makes the writes fail instead of stopping the client
+	bool sent = sendmsg(conn, &msg, MSG_NOSIGNAL) == (ssize_t)sizeof(header) && send_all(conn, source, size);
+	yfree(source);
+
+	// the reply is sent once the values written by the execution have been written
+	struct server_reply_header reply;
+
+	if(!sent || !receive_all(conn, &reply, sizeof(reply)) || memcmp(reply.magic, "YOGR", 4) != 0
+		|| reply.message_len >= SERVER_MESSAGE_SIZE)
+	{
+		fprintf(err, "the server %s has not executed %s\n", path, filename);
+		close(conn);
+		return 2;
+	}
+
+	char message[SERVER_MESSAGE_SIZE];
+
+	if(receive_all(conn, message, reply.message_len))
+		fwrite(message, 1, reply.message_len, err);
+
+	close(conn);
+
+	return (int)reply.status;
+#else
+	(void)path;
+	(void)filename;
+	(void)fuel;
+	(void)binary_input;
+	(void)binary_output;
+	fprintf(err, "the server is not supported on this platform\n");
+	return 2;
+#endif
+}
+
+#ifdef YOG_SERVER_SOCKETS
+// serve a connection on its own thread, so a slow client or a long compilation does not delay the others
+void accept_connection(struct server *srv, struct server_state *state, int conn)
+{
+	struct server_receiver *receiver = ymalloc(sizeof(struct server_receiver));
+	receiver->conn = conn;
+	receiver->srv = srv;
+	receiver->state = state;
+
+	pthread_mutex_lock(&state->lock);
+	bool available = state->receivers_cnt < SERVER_RECEIVERS_CNT;
+	if(available)
+		state->receivers_cnt++;
+	pthread_mutex_unlock(&state->lock);
+
+	// the thread inherits the blocked signals, which are delivered to the accepting thread only
+	pthread_t thread;
+	if(available && pthread_create(&thread, NULL, receive_connection, receiver) == 0)
+	{
+		pthread_detach(thread);
+		return;
+	}
+
+	// the connection is served inline while too many are received or if the thread cannot start
+	if(available)
+	{
+		pthread_mutex_lock(&state->lock);
+		state->receivers_cnt--;
+		pthread_mutex_unlock(&state->lock);
+	}
+
+	yfree(receiver);
+	serve_connection(srv, state, conn);
+}
+
+void *receive_connection(void *arg)
+{
+	struct server_receiver *receiver = arg;
+	struct server_state *state = receiver->state;
+
+	serve_connection(receiver->srv, state, receiver->conn);
+	yfree(receiver);
+
+	pthread_mutex_lock(&state->lock);
+
+	if(--state->receivers_cnt == 0)
+		pthread_cond_broadcast(&state->received);
+
+	pthread_mutex_unlock(&state->lock);
+
+	return NULL;
+}
+
+// read a request and submit it to the scheduler, or reply at once if it cannot be executed
+void serve_connection(struct server *srv, struct server_state *state, int conn)
+{
+	// a client which does not send its request is dropped after the timeout instead of holding the server
+	struct timeval timeout = { SERVER_REQUEST_TIMEOUT, 0 };
+	setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+	fcntl(conn, F_SETFL, fcntl(conn, F_GETFL) & ~O_NONBLOCK);
+	fcntl(conn, F_SETFD, FD_CLOEXEC);
+
+	struct server_request_header header;
+	int fds[2];
+
+	if(!receive_request(conn, &header, fds))
+	{
+		close(conn);
+		return;
+	}
+
+	char *source = NULL;
+
+	if(memcmp(header.magic, "YOGQ", 4) != 0 || header.version != SERVER_VERSION || header.source_len > SERVER_SOURCE_SIZE
+		|| !receive_all(conn, source = ymalloc(header.source_len + 1), header.source_len))
+	{
+		send_reply(conn, 2, "invalid request\n");
+		close(conn);
+		close(fds[0]);
+		close(fds[1]);
+		yfree(source);
+		return;
+	}
+
+	pthread_mutex_lock(&state->lock);
+	srv->requests++;
+	pthread_mutex_unlock(&state->lock);
+
+	bool binary_input = (header.flags & FLAG_BINARY_INPUT) != 0;
+	bool binary_output = (header.flags & FLAG_BINARY_OUTPUT) != 0;
+	FILE *in = fdopen(fds[0], binary_input ? "rb" : "r");
+	FILE *out = fdopen(fds[1], binary_output ? "wb" : "w");
+
+	if(!in || !out)
+	{
+		send_reply(conn, 2, "failed to open the standard streams\n");
+		close(conn);
+
+		if(in)
+			fclose(in);
+		else
+			close(fds[0]);
+
+		if(out)
+			fclose(out);
+		else
+			close(fds[1]);
+
+		yfree(source);
+		return;
+	}
+
+	// the compilation errors are written to the output of the client, as yog writes them
+	struct server_program *program = acquire_program(srv, state, source, header.source_len, out);
+
+	if(program == NULL)
+	{
+		fclose(in);
+		fclose(out);
+		send_reply(conn, 0, "");
+		close(conn);
+		return;
+	}
+
+	struct server_connection *connection = ymalloc(sizeof(struct server_connection));
+	connection->conn = conn;
+	connection->program = program;
+	connection->state = state;
+
+	// a request may lower the fuel of the server, not raise it
+	uint64_t fuel = header.fuel < srv->fuel ? header.fuel : srv->fuel;
+
+	scheduler_submit(&state->scheduler, &program->bc, fuel, binary_input, binary_output, in, out, connection);
+}
+
+// receive the header of a request with the standard input and output of the client
+bool receive_request(int conn, struct server_request_header *header, int fds[2])
+{
+	union
+	{
+		struct cmsghdr align;
+		char buffer[CMSG_SPACE(2 * sizeof(int))];
+	} control;
+
+	struct iovec iov;
+	iov.iov_base = header;
+	iov.iov_len = sizeof(*header);
+
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buffer;
+	msg.msg_controllen = sizeof(control.buffer);
+
+	ssize_t received = recvmsg(conn, &msg, 0);
+	if(received <= 0)
+		return false;
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+
+	if(cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(2 * sizeof(int)))
+	{
+		// the descriptors passed in another layout are closed with the connection
+		if(cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+		{
+			size_t cnt = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+			for(size_t i = 0; i < cnt; i++)
+			{
+				int fd;
+				memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+				close(fd);
+			}
+		}
+
+		return false;
+	}
+
+	memcpy(fds, CMSG_DATA(cmsg), 2 * sizeof(int));
+
+	// the rest of the header follows the descriptors
+	if((msg.msg_flags & MSG_CTRUNC) != 0
+		|| !receive_all(conn, (char *)header + received, sizeof(*header) - received))
+	{
+		close(fds[0]);
+		close(fds[1]);
+		return false;
+	}
+
+	return true;
+}
+
+bool receive_all(int conn, void *data, size_t size)
+{
+	char *bytes = data;
+
+	while(size > 0)
+	{
+		ssize_t received = recv(conn, bytes, size, 0);
+
+		if(received < 0 && errno == EINTR)
+			continue;
+
+		if(received <= 0)
+			return false;
+
+		bytes += received;
+		size -= received;
+	}
+
+	return true;
+}
+
+bool send_all(int conn, const void *data, size_t size)
+{
+	const char *bytes = data;
+
+	while(size > 0)
+	{
+		ssize_t sent = send(conn, bytes, size, MSG_NOSIGNAL);
+
+		if(sent < 0 && errno == EINTR)
+			continue;
+
+		if(sent <= 0)
+			return false;
+
+		bytes += sent;
+		size -= sent;
+	}
+
+	return true;
+}
+
+void send_reply(int conn, int status, const char *message)
+{
+	struct server_reply_header reply;
+	memset(&reply, 0, sizeof(reply));
+
+	memcpy(reply.magic, "YOGR", 4);
+	reply.status = (uint32_t)status;
+	reply.message_len = strlen(message);
+
+	// the client may have gone away, the reply is then dropped
+	if(send_all(conn, &reply, sizeof(reply)))
+		send_all(conn, message, reply.message_len);
+}
+
+// find the program of a source code in the cache or compile it, NULL if it does not compile, the source code is taken over
+struct server_program *acquire_program(struct server *srv, struct server_state *state, char *source, size_t size, FILE *errors)
+{
+	uint64_t hash = yogc_hash(source, size);
+
+	pthread_mutex_lock(&state->lock);
+
+	state->clock++;
+
+	for(struct server_program *program = state->programs; program != NULL; program = program->next)
+	{
+		if(program->hash == hash && program->source_len == size && memcmp(program->source, source, size) == 0)
+		{
+			program->refs++;
+			program->used = state->clock;
+
+			pthread_mutex_unlock(&state->lock);
+
+			yfree(source);
+			return program;
+		}
+	}
+
+	srv->compilations++;
+
+	pthread_mutex_unlock(&state->lock);
+
+	// the requests of a program not in the cache compile it at once, the first compiled one is kept
+	struct compilation comp;
+
+	if(!compile(&comp, source, size, errors))
+	{
+		yfree(source);
+		return NULL;
+	}
+
+	// the bytecode and the line table do not refer to the symbol table nor to the instruction list
+	struct server_program *program = ymalloc(sizeof(struct server_program));
+	program->hash = hash;
+	program->source = source;
+	program->source_len = size;
+	program->bc = comp.bc;
+	program->lines = comp.lines;
+	program->refs = 1;
+
+	instruction_list_clear(&comp.instrs);
+	symbol_table_clear(&comp.st);
+
+	pthread_mutex_lock(&state->lock);
+
+	for(struct server_program *cached = state->programs; cached != NULL; cached = cached->next)
+	{
+		if(cached->hash == hash && cached->source_len == size && memcmp(cached->source, source, size) == 0)
+		{
+			cached->refs++;
+			cached->used = state->clock;
+
+			pthread_mutex_unlock(&state->lock);
+
+			free_program(program);
+			return cached;
+		}
+	}
+
+	program->used = state->clock;
+	program->next = state->programs;
+	state->programs = program;
+	state->programs_cnt++;
+
+	evict_programs(state);
+
+	pthread_mutex_unlock(&state->lock);
+
+	return program;
+}
+
+void release_program(struct server_state *state, struct server_program *program)
+{
+	pthread_mutex_lock(&state->lock);
+	program->refs--;
+	pthread_mutex_unlock(&state->lock);
+}
+
+// remove the least recently requested programs not executed by any request while the cache is full, under the lock
+void evict_programs(struct server_state *state)
+{
+	while(state->programs_cnt > SERVER_CACHE_SIZE)
+	{
+		struct server_program **victim = NULL;
+
+		for(struct server_program **program = &state->programs; *program != NULL; program = &(*program)->next)
+		{
+			if((*program)->refs == 0 && (victim == NULL || (*program)->used < (*victim)->used))
+				victim = program;
+		}
+
+		// the cache grows beyond its size while all its programs are executed
+		if(victim == NULL)
+			return;
+
+		struct server_program *evicted = *victim;
+		*victim = evicted->next;
+		state->programs_cnt--;
+
+		free_program(evicted);
+	}
+}
+
+void free_program(struct server_program *program)
+{
+	bytecode_clear(&program->bc);
+	line_table_clear(&program->lines);
+	yfree(program->source);
+	yfree(program);
+}
+
+// send the outcome of a request to its client, called on the worker which completed it
+void complete_request(void *data, struct interpreter *vm)
+{
+	struct server_connection *connection = data;
+
+	char message[SERVER_MESSAGE_SIZE];
+	int status = describe_outcome(message, vm, connection->program->lines);
+
+	// the written values precede the reply, so the client exits once they are written
+	fclose(vm->in);
+	fclose(vm->out);
+
+	send_reply(connection->conn, status, message);
+	close(connection->conn);
+
+	release_program(connection->state, connection->program);
+	yfree(connection);
+}
+
+// write the message of the runtime error which stopped an execution and return its exit status, as yog reports them
+int describe_outcome(char *message, const struct interpreter *vm, struct line_table lines)
+{
+	message[0] = '\0';
+
+	switch(vm->status)
+	{
+		case INTERPRETER_DIVISION_BY_ZERO:
+			snprintf(message, SERVER_MESSAGE_SIZE, "division by zero at line %zu\n", line_table_find(lines, vm->pc).row);
+			return 6;
+
+		// the request is not resumed, so a non-blocking input without a value yet ends it
+		case INTERPRETER_END_OF_INPUT:
+		case INTERPRETER_NEEDS_INPUT:
+			snprintf(message, SERVER_MESSAGE_SIZE, "end of input at line %zu\n", line_table_find(lines, vm->pc).row);
+			return 7;
+
+		case INTERPRETER_INVALID_INPUT:
+			snprintf(message, SERVER_MESSAGE_SIZE, "invalid input at line %zu\n", line_table_find(lines, vm->pc).row);
+			return 8;
+
+		case INTERPRETER_FUEL_EXHAUSTED:
+		case INTERPRETER_DEADLINE_EXCEEDED:
+			snprintf(message, SERVER_MESSAGE_SIZE, "%s at instruction %zu after %llu instructions\n",
+				vm->status == INTERPRETER_FUEL_EXHAUSTED ? "fuel exhausted" : "deadline exceeded", vm->pc, (unsigned long long)vm->retired);
+			return vm->status == INTERPRETER_FUEL_EXHAUSTED ? 4 : 5;
+
+		default:
+			return 0;
+	}
+}
+
+// remove a socket left by a server which has not been stopped, i.e. which nobody listens to
+void remove_stale_socket(const char *path)
+{
+	struct stat st;
+	if(stat(path, &st) != 0 || !S_ISSOCK(st.st_mode))
+		return;
+
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(probe < 0)
+		return;
+
+	if(connect(probe, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+		unlink(path);
+
+	close(probe);
+}
+
+void stop_signal(int signo)
+{
+	(void)signo;
+	Stopping = 1;
+}
+#endif
@@ -0,0 +1,318 @@
+
+// the signals and the file descriptors are not part of the strict C99 environment
+#if defined(__unix__) || defined(__APPLE__)
+#define YOG_SIGNALS
+#define _POSIX_C_SOURCE 200809L
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "snapshot.h"
+
+/*! @brief The header of a snapshot file, followed by the name of the program and by the frame */
+struct snapshot_header
+{
+	char magic[4];
+	uint32_t version;
+	uint64_t hash;
+	uint64_t pc;
+	uint64_t retired;
+	uint64_t reads;
+	int64_t input_offset;
+	int64_t output_offset;
+	uint64_t frame_size;
+	uint64_t program_len;
+	uint64_t flags;
+};
+
+// the flags of the formats of the input and of the output
+#define FLAG_BINARY_INPUT 1
+#define FLAG_BINARY_OUTPUT 2
+
+// the interpreter checkpointed on SIGUSR1
+static struct interpreter *volatile Checkpointed = NULL;
+
+void write_checkpoint(struct interpreter *vm);
+uint64_t next_fuel(const struct checkpointer *cp, const struct interpreter *vm);
+void truncate_output(FILE *out, int64_t offset);
+
+#ifdef YOG_SIGNALS
+void checkpoint_signal(int signo);
+#endif
+
+uint64_t snapshot_hash(const struct bytecode *bc)
+{
+	const uint64_t counts[3] = { bc->size, bc->vars_cnt, bc->tmp_cnt };
+
+	// FNV-1a hash of the counts, of the instructions and of the constants
+	const unsigned char *parts[3] = { (const unsigned char *)counts, (const unsigned char *)bc->code, (const unsigned char *)bc->constants };
+	const size_t sizes[3] = { sizeof(counts), bc->size * sizeof(struct bytecode_instruction), bc->constants_cnt * sizeof(int64_t) };
+
+	uint64_t hash = 14695981039346656037ULL;
+
+	for(size_t p = 0; p < 3; p++)
+	{
+		for(size_t i = 0; i < sizes[p]; i++)
+		{
+			hash ^= parts[p][i];
+			hash *= 1099511628211ULL;
+		}
+	}
+
+	return hash;
+}
+
+void snapshot_take(struct snapshot *snap, struct interpreter *vm, const char *program)
+{
+	snprintf(snap->program, SNAPSHOT_PROGRAM_SIZE, "%s", program);
+
+	snap->hash = snapshot_hash(vm->bc);
+	snap->pc = vm->pc;
+	snap->retired = vm->retired;
+	snap->reads = vm->reads;
+
+	// the values written so far are part of the snapshot
+	output_bind(&vm->output, vm->out, vm->in);
+	input_bind(&vm->input, vm->in, vm->interactive && !vm->output.binary);
+
+	snap->binary_input = vm->input.binary;
+	snap->binary_output = vm->output.binary;
+	snap->input_offset = input_tell(&vm->input);
+	snap->output_offset = output_tell(&vm->output);
+
+	snap->frame_size = vm->bc->vars_cnt + vm->bc->tmp_cnt;
+	snap->frame = ymalloc(snap->frame_size * sizeof(int64_t));
+	memcpy(snap->frame, vm->frame, snap->frame_size * sizeof(int64_t));
+}
+
+bool snapshot_write(const struct snapshot *snap, const char *filename)
+{
+	struct snapshot_header header;
+	memset(&header, 0, sizeof(header));
+
+	memcpy(header.magic, "YOGS", 4);
+	header.version = SNAPSHOT_VERSION;
+	header.hash = snap->hash;
+	header.pc = snap->pc;
+	header.retired = snap->retired;
+	header.reads = snap->reads;
+	header.input_offset = snap->input_offset;
+	header.output_offset = snap->output_offset;
+	header.frame_size = snap->frame_size;
+	header.program_len = strlen(snap->program);
+	header.flags = (snap->binary_input ? FLAG_BINARY_INPUT : 0) | (snap->binary_output ? FLAG_BINARY_OUTPUT : 0);
+
+	// write a temporary file and rename it, so a crash while writing keeps the previous snapshot
+	char tmp[SNAPSHOT_PROGRAM_SIZE + 32];
+#ifdef YOG_SIGNALS
+	snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", filename, (long)getpid());
+#else
+	snprintf(tmp, sizeof(tmp), "%s.tmp", filename);
+#endif
+
+	FILE *out = fopen(tmp, "wb");
+	if(!out)
+		return false;
+
+	bool written = fwrite(&header, sizeof(header), 1, out) == 1
+		&& fwrite(snap->program, 1, header.program_len, out) == header.program_len
+		&& fwrite(snap->frame, sizeof(int64_t), snap->frame_size, out) == snap->frame_size;
+
+	written = fclose(out) == 0 && written;
+
+#ifndef YOG_SIGNALS
+	remove(filename);
+#endif
+
+	if(!written || rename(tmp, filename) != 0)
+	{
+		remove(tmp);
+		return false;
+	}
+
+	return true;
+}
+
+bool snapshot_read(struct snapshot *snap, const char *filename)
+{
+	FILE *in = fopen(filename, "rb");
+	if(!in)
+		return false;
+
+	struct snapshot_header header;
+
+	bool valid = fread(&header, sizeof(header), 1, in) == 1
+		&& memcmp(header.magic, "YOGS", 4) == 0
+		&& header.version == SNAPSHOT_VERSION
+		&& header.program_len < SNAPSHOT_PROGRAM_SIZE
+		&& header.frame_size <= UINT32_MAX
+		&& fread(snap->program, 1, header.program_len, in) == header.program_len;
+
+	if(!valid)
+	{
+		fclose(in);
+		return false;
+	}
+
+	snap->program[header.program_len] = '\0';
+	snap->hash = header.hash;
+	snap->pc = header.pc;
+	snap->retired = header.retired;
+	snap->reads = header.reads;
+	snap->input_offset = header.input_offset;
+	snap->output_offset = header.output_offset;
+	snap->frame_size = header.frame_size;
+	snap->binary_input = (header.flags & FLAG_BINARY_INPUT) != 0;
+	snap->binary_output = (header.flags & FLAG_BINARY_OUTPUT) != 0;
+	snap->frame = ymalloc(snap->frame_size * sizeof(int64_t));
+
+	valid = fread(snap->frame, sizeof(int64_t), snap->frame_size, in) == snap->frame_size;
+	fclose(in);
+
+	if(!valid)
+		snapshot_clear(snap);
+
+	return valid;
+}
+
+bool snapshot_restore(const struct snapshot *snap, struct interpreter *vm)
+{
+	if(snap->hash != snapshot_hash(vm->bc) || snap->frame_size != vm->bc->vars_cnt + vm->bc->tmp_cnt
+		|| snap->pc > vm->bc->size)
+		return false;
+
+	memcpy(vm->frame, snap->frame, snap->frame_size * sizeof(int64_t));
+
+	vm->pc = snap->pc;
+	vm->retired = snap->retired;
+	vm->reads = snap->reads;
+
+	// the input continues after the values read before the snapshot, in their format
+	vm->input.binary = snap->binary_input;
+	vm->output.binary = snap->binary_output;
+	input_bind(&vm->input, vm->in, vm->interactive && !vm->output.binary);
+
+	if(snap->input_offset < 0 || !input_seek(&vm->input, snap->input_offset))
+	{
+		int64_t value;
+		uint64_t skipped = 0;
+
+		while(skipped < snap->reads && input_int(&vm->input, &value) == INPUT_VALUE)
+			skipped++;
+	}
+
+	// the output continues after the values written before the snapshot
+	if(snap->output_offset >= 0)
+		truncate_output(vm->out, snap->output_offset);
+
+	return true;
+}
+
+void snapshot_clear(struct snapshot *snap)
+{
+	yfree(snap->frame);
+	snap->frame = NULL;
+	snap->frame_size = 0;
+}
+
+void checkpointer_start(struct checkpointer *cp, struct interpreter *vm, const char *filename, const char *program,
+	uint64_t every, uint64_t fuel, double seconds)
+{
+	yassert(Checkpointed == NULL, "only one checkpointer can be active");
+
+	cp->filename = filename;
+	cp->program = program;
+	cp->every = every;
+	cp->fuel = fuel;
+	cp->written = 0;
+
+	interpreter_limit(vm, next_fuel(cp, vm), seconds);
+	interpreter_set_interrupt_handler(vm, write_checkpoint, cp, false);
+	Checkpointed = vm;
+
+#ifdef YOG_SIGNALS
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = checkpoint_signal;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGUSR1, &action, NULL);
+#endif
+}
+
+enum interpreter_status checkpointer_execute(struct checkpointer *cp, struct interpreter *vm)
+{
+	while(true)
+	{
+		enum interpreter_status status = interpreter_execute(vm);
+
+		// the fuel stops the execution at each interval, which is resumed after the snapshot
+		if(status != INTERPRETER_FUEL_EXHAUSTED || vm->retired >= cp->fuel)
+			return status;
+
+		write_checkpoint(vm);
+		vm->fuel = next_fuel(cp, vm);
+	}
+}
+
+void checkpointer_stop(struct checkpointer *cp)
+{
+	(void)cp;
+
+#ifdef YOG_SIGNALS
+	signal(SIGUSR1, SIG_DFL);
+#endif
+
+	Checkpointed = NULL;
+}
+
+// the interrupt handler, the program counter is the next instruction to execute
+void write_checkpoint(struct interpreter *vm)
+{
+	struct checkpointer *cp = vm->interrupt_data;
+
+	struct snapshot snap;
+	snapshot_take(&snap, vm, cp->program);
+
+	if(snapshot_write(&snap, cp->filename))
+		cp->written++;
+	else
+		fprintf(stderr, "failed to write the snapshot %s\n", cp->filename);
+
+	snapshot_clear(&snap);
+}
+
+// the fuel of the interpreter up to the next snapshot
+uint64_t next_fuel(const struct checkpointer *cp, const struct interpreter *vm)
+{
+	if(cp->every == 0 || cp->fuel - vm->retired <= cp->every)
+		return cp->fuel;
+
+	return vm->retired + cp->every;
+}
+
+// discard what the output file holds after an offset and continue writing there
+void truncate_output(FILE *out, int64_t offset)
+{
+#ifdef YOG_SIGNALS
+	struct stat st;
+	fflush(out);
+
+	if(fstat(fileno(out), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > offset && ftruncate(fileno(out), offset) == 0)
+		fseek(out, 0, SEEK_END);
+#else
+	(void)out;
+	(void)offset;
+#endif
+}
+
+#ifdef YOG_SIGNALS
+void checkpoint_signal(int signo)
+{
+	(void)signo;
+
+	if(Checkpointed != NULL)
+		interpreter_interrupt(Checkpointed);
+}
+#endif
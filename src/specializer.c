@@ -0,0 +1,110 @@
+
+#include "specializer.h"
+
+// the variants of an operation are ordered as the frame (V) and the literal (L) kinds
+unsigned kind(struct operand op);
+enum opcode kinds_1(enum opcode base, struct operand src1);
+enum opcode kinds_2(enum opcode base, struct operand src1, struct operand src2);
+
+void specialize(struct instruction_list instrs)
+{
+	for(size_t i = 0; i < instrs.size; i++)
+	{
+		instrs.data[i].op = specialize_instruction(instrs.data[i]);
+
+		// the superinstructions depend on the specialized operations
+		instrs.data[i].super = 0;
+	}
+}
+
+enum opcode specialize_instruction(struct instruction instr)
+{
+	switch(instr.type)
+	{
+		case INSTRUCTION_ASSIGN:
+			return kinds_1(OPCODE_ASSIGN_V, instr.src1);
+
+		case INSTRUCTION_READ:
+			return OPCODE_READ;
+
+		case INSTRUCTION_WRITE:
+			return kinds_1(OPCODE_WRITE_V, instr.src1);
+
+		case INSTRUCTION_ADD:
+			return kinds_2(OPCODE_ADD_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_SUB:
+			return kinds_2(OPCODE_SUB_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_MUL:
+			return kinds_2(OPCODE_MUL_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_DIV:
+			return kinds_2(OPCODE_DIV_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_PLS:
+			return kinds_1(OPCODE_PLS_V, instr.src1);
+
+		case INSTRUCTION_NEG:
+			return kinds_1(OPCODE_NEG_V, instr.src1);
+
+		case INSTRUCTION_EQ:
+			return kinds_2(OPCODE_EQ_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_NEQ:
+			return kinds_2(OPCODE_NEQ_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_LT:
+			return kinds_2(OPCODE_LT_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_LTE:
+			return kinds_2(OPCODE_LTE_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_GT:
+			return kinds_2(OPCODE_GT_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_GTE:
+			return kinds_2(OPCODE_GTE_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_GOTO:
+			return OPCODE_GOTO;
+
+		case INSTRUCTION_BRANCH:
+			return OPCODE_BRANCH;
+
+		case INSTRUCTION_BEQ:
+			return kinds_2(OPCODE_BEQ_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_BNEQ:
+			return kinds_2(OPCODE_BNEQ_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_BLT:
+			return kinds_2(OPCODE_BLT_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_BLTE:
+			return kinds_2(OPCODE_BLTE_VV, instr.src1, instr.src2);
+
+		case INSTRUCTION_BGT:
+			return kinds_2(OPCODE_BGT_VV, instr.src1, instr.src2);
+
+		default: // case INSTRUCTION_BGTE:
+			return kinds_2(OPCODE_BGTE_VV, instr.src1, instr.src2);
+	}
+}
+
+unsigned kind(struct operand op)
+{
+	yassert(op.type != OPERAND_LABEL, "invalid operand kind");
+
+	return op.type == OPERAND_LITERAL;
+}
+
+enum opcode kinds_1(enum opcode base, struct operand src1)
+{
+	return base + kind(src1);
+}
+
+enum opcode kinds_2(enum opcode base, struct operand src1, struct operand src2)
+{
+	return base + 2 * kind(src1) + kind(src2);
+}
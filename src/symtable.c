@@ -86,6 +86,7 @@ struct symbol *symbol_table_add(struct symbol_table *st, const char* id)
 	sym->type = SYMBOL_UNKNOW;
 	sym->loc.row = 0;
 	sym->loc.col = 0;
+	sym->slot = 0;
 	strcpy(sym->id, id);
 
 	uint8_t index = hash_str(id) & (st->buckets_cnt - 1);
@@ -1,66 +1,866 @@
 
-#include "parser.h"
-#include "semanter.h"
+// the standard streams are opened in text mode on Windows
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#include "compiler.h"
+#include "peephole.h"
 #include "interpreter.h"
+#include "jit.h"
+#include "emitter.h"
+#include "profiler.h"
+#include "sampler.h"
+#include "lanes.h"
+#include "batch.h"
+#include "scheduler.h"
+#include "server.h"
+#include "yogc.h"
+#include "snapshot.h"
+#include "offload.h"
+#include "memo.h"
+
+int report_runtime_error(enum interpreter_status outcome, struct line_table lines, size_t pc, uint64_t retired);
+
+void print_usage(void)
+{
+	printf("usage:\tyog [options] <filename>\t(a program or a precompiled .yogc bytecode)\n");
+	printf("\tyog --batch [options] <filename> <inputs...>\n");
+	printf("\tyog --multiplex [options] <filename> <inputs...>\n");
+	printf("\tyog --resume <snapshot> [options] [<filename>]\n");
+	printf("\tyog --serve <socket> [options]\n");
+	printf("\tyog --client <socket> [options] <filename>\n");
+	printf("options:\n");
+	printf("\t--dispatch=call|threaded\tselect the instruction dispatch technique (default threaded)\n");
+	printf("\t--jit\t\t\t\ttranslate the program to native x86-64 code before the execution\n");
+	printf("\t--jit-dump=<file>\t\twrite the native code to file (objdump -D -b binary -m i386:x86-64)\n");
+	printf("\t--tiered\t\t\tcompile the hot loops to native code during the execution\n");
+	printf("\t--tier-threshold=<count>\tcompile a loop after count executions of its back-edge (default %d)\n", INTERPRETER_TIER_THRESHOLD);
+	printf("\t--tier-log\t\t\tprint the compiled loops\n");
+	printf("\t--fuel=<count>\t\t\tstop the execution after about count instructions\n");
+	printf("\t--timeout=<seconds>\t\tstop the execution after seconds of wall-clock time\n");
+	printf("\t--interactive\t\t\tprompt for the read values, the default if the input is a terminal\n");
+	printf("\t--non-interactive\t\tread the values without prompting with the fast scanner, the default otherwise\n");
+	printf("\t--io=text|binary|binary-in|binary-out\tread and write the values as decimal lines or as raw little-endian int64 (default text)\n");
+	printf("\t--output-buffer=<bytes>\t\tbuffer the written values in bytes before writing them (default %d)\n", OUTPUT_BUFFER_SIZE);
+	printf("\t--line-buffered\t\t\twrite each value at once, as when the output is a terminal\n");
+	printf("\t--io-threads\t\t\tparse the read values and write the written values on their own threads, without prompting\n");
+	printf("\t--memo[=<file>]\t\t\treuse the output of a previous execution over the same input values, kept in file (default in the bytecode cache),\n");
+	printf("\t\t\t\t\treading the whole input first if the program reads, so not from a terminal nor an open pipe\n");
+	printf("\t--memo-size=<bytes>\t\tbound the kept outputs to bytes (default %d)\n", MEMO_CAPACITY);
+	printf("\t--lanes\t\t\t\texecute the program once per line of the standard input, %d lines at a time\n", LANES_CNT);
+	printf("\t--batch\t\t\t\texecute the program once for each input file, writing the outputs in order\n");
+	printf("\t-j<count>, --jobs=<count>\texecute the batch with count workers (default the number of processors)\n");
+	printf("\t--pin\t\t\t\tpin the workers of the batch to the processors\n");
+	printf("\t--multiplex\t\t\texecute the program once for each input, suspending the executions waiting for their input\n");
+	printf("\t--quantum=<count>\t\tswitch the multiplexed execution after count instructions\n");
+	printf("\t--serve <socket>\t\texecute the programs of the clients of socket, keeping them compiled\n");
+	printf("\t--client <socket>\t\texecute the program on the server of socket over the standard streams\n");
+	printf("\t--checkpoint=<file>\t\twrite a snapshot of the execution to file on SIGUSR1 (default <filename>.snapshot)\n");
+	printf("\t--checkpoint-every=<count>\twrite a snapshot of the execution every count instructions\n");
+	printf("\t--resume <snapshot>\t\tcontinue the execution from snapshot, checkpointing it to snapshot\n");
+	printf("\t--compile-only[=<file>]\t\tcompile the program to the bytecode cache, or to file, instead of executing it\n");
+	printf("\t--no-cache\t\t\tneither load nor store the compiled program in the bytecode cache\n");
+	printf("\t--emit-c <file>\t\t\ttranslate the program to a C translation unit instead of executing it\n");
+	printf("\t--stats\t\t\t\tprint the compilation statistics\n");
+	printf("\t--profile[=cycles]\t\treport the hottest source lines and loops by executions or by cycles\n");
+	printf("\t--sample-profile=<hz>\t\treport the hottest source lines and loops by samples taken hz times per second\n");
+	printf("\t--sample-folded=<file>\t\twrite the samples to file as folded stacks for the flame graph tools\n");
+	printf("\t--profile-sequences=<file>\tappend the profile of the executed sequences of operations to file\n");
+}
 
 int main(int argc, char* argv[])
 {
-	if(argc < 2)
+	const char *filename = NULL;
+	enum interpreter_dispatch dispatch = DISPATCH_THREADED;
+	bool stats = false;
+	const char *sequences = NULL;
+	bool profile = false;
+	bool profile_cycles = false;
+	const char *jit_dump_file = NULL;
+	const char *c_file = NULL;
+	uint64_t tier_threshold = INTERPRETER_TIER_THRESHOLD;
+	bool tier_log = false;
+	uint64_t fuel = UINT64_MAX;
+	double timeout = 0;
+	unsigned sample_hz = 0;
+	const char *folded_file = NULL;
+	bool lanes = false;
+	bool batch = false;
+	bool multiplex = false;
+	uint64_t quantum = UINT64_MAX;
+	const char *serve_socket = NULL;
+	const char *client_socket = NULL;
+	size_t workers_cnt = 0;
+	bool pin = false;
+	bool compile_only = false;
+	const char *compile_file = NULL;
+	bool use_cache = true;
+	const char *checkpoint_file = NULL;
+	uint64_t checkpoint_every = 0;
+	const char *resume_file = NULL;
+	bool interactive = input_is_terminal(stdin);
+	bool binary_input = false;
+	bool binary_output = false;
+	size_t output_buffer = OUTPUT_BUFFER_SIZE;
+	bool line_buffered = false;
+	bool io_threads = false;
+	bool memoize = false;
+	const char *memo_file = NULL;
+	size_t memo_size = MEMO_CAPACITY;
+	const char *inputs[argc];
+	size_t inputs_cnt = 0;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "--dispatch=call") == 0)
+		{
+			dispatch = DISPATCH_CALL;
+		}
+		else if(strcmp(argv[i], "--dispatch=threaded") == 0)
+		{
+			dispatch = DISPATCH_THREADED;
+		}
+		else if(strcmp(argv[i], "--jit") == 0)
+		{
+			dispatch = DISPATCH_JIT;
+		}
+		else if(strncmp(argv[i], "--jit-dump=", 11) == 0)
+		{
+			dispatch = DISPATCH_JIT;
+			jit_dump_file = argv[i] + 11;
+		}
+		else if(strcmp(argv[i], "--tiered") == 0)
+		{
+			dispatch = DISPATCH_TIERED;
+		}
+		else if(strncmp(argv[i], "--tier-threshold=", 17) == 0)
+		{
+			tier_threshold = strtoull(argv[i] + 17, NULL, 10);
+		}
+		else if(strcmp(argv[i], "--tier-log") == 0)
+		{
+			tier_log = true;
+		}
+		else if(strncmp(argv[i], "--fuel=", 7) == 0)
+		{
+			fuel = strtoull(argv[i] + 7, NULL, 10);
+		}
+		else if(strncmp(argv[i], "--timeout=", 10) == 0)
+		{
+			timeout = strtod(argv[i] + 10, NULL);
+		}
+		else if(strcmp(argv[i], "--interactive") == 0)
+		{
+			interactive = true;
+		}
+		else if(strcmp(argv[i], "--non-interactive") == 0)
+		{
+			interactive = false;
+		}
+		else if(strcmp(argv[i], "--io=text") == 0)
+		{
+			binary_input = false;
+			binary_output = false;
+		}
+		else if(strcmp(argv[i], "--io=binary") == 0)
+		{
+			binary_input = true;
+			binary_output = true;
+		}
+		else if(strcmp(argv[i], "--io=binary-in") == 0)
+		{
+			binary_input = true;
+		}
+		else if(strcmp(argv[i], "--io=binary-out") == 0)
+		{
+			binary_output = true;
+		}
+		else if(strncmp(argv[i], "--output-buffer=", 16) == 0)
+		{
+			output_buffer = strtoull(argv[i] + 16, NULL, 10);
+		}
+		else if(strcmp(argv[i], "--line-buffered") == 0)
+		{
+			line_buffered = true;
+		}
+		else if(strcmp(argv[i], "--io-threads") == 0)
+		{
+			io_threads = true;
+		}
+		else if(strcmp(argv[i], "--memo") == 0)
+		{
+			memoize = true;
+		}
+		else if(strncmp(argv[i], "--memo=", 7) == 0)
+		{
+			memoize = true;
+			memo_file = argv[i] + 7;
+		}
+		else if(strncmp(argv[i], "--memo-size=", 12) == 0)
+		{
+			memo_size = strtoull(argv[i] + 12, NULL, 10);
+		}
+		else if(strcmp(argv[i], "--lanes") == 0)
+		{
+			lanes = true;
+		}
+		else if(strcmp(argv[i], "--batch") == 0)
+		{
+			batch = true;
+		}
+		else if(strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+		{
+			workers_cnt = strtoul(argv[++i], NULL, 10);
+		}
+		else if(strncmp(argv[i], "-j", 2) == 0 && argv[i][2] != '\0')
+		{
+			workers_cnt = strtoul(argv[i] + 2, NULL, 10);
+		}
+		else if(strncmp(argv[i], "--jobs=", 7) == 0)
+		{
+			workers_cnt = strtoul(argv[i] + 7, NULL, 10);
+		}
+		else if(strcmp(argv[i], "--pin") == 0)
+		{
+			pin = true;
+		}
+		else if(strcmp(argv[i], "--multiplex") == 0)
+		{
+			multiplex = true;
+		}
+		else if(strncmp(argv[i], "--quantum=", 10) == 0)
+		{
+			quantum = strtoull(argv[i] + 10, NULL, 10);
+		}
+		else if(strcmp(argv[i], "--serve") == 0 && i + 1 < argc)
+		{
+			serve_socket = argv[++i];
+		}
+		else if(strcmp(argv[i], "--client") == 0 && i + 1 < argc)
+		{
+			client_socket = argv[++i];
+		}
+		else if(strncmp(argv[i], "--checkpoint=", 13) == 0)
+		{
+			checkpoint_file = argv[i] + 13;
+		}
+		else if(strncmp(argv[i], "--checkpoint-every=", 19) == 0)
+		{
+			checkpoint_every = strtoull(argv[i] + 19, NULL, 10);
+		}
+		else if(strcmp(argv[i], "--resume") == 0 && i + 1 < argc)
+		{
+			resume_file = argv[++i];
+		}
+		else if(strcmp(argv[i], "--compile-only") == 0)
+		{
+			compile_only = true;
+		}
+		else if(strncmp(argv[i], "--compile-only=", 15) == 0)
+		{
+			compile_only = true;
+			compile_file = argv[i] + 15;
+		}
+		else if(strcmp(argv[i], "--no-cache") == 0)
+		{
+			use_cache = false;
+		}
+		else if(strcmp(argv[i], "--emit-c") == 0 && i + 1 < argc)
+		{
+			c_file = argv[++i];
+		}
+		else if(strcmp(argv[i], "--stats") == 0)
+		{
+			stats = true;
+		}
+		else if(strcmp(argv[i], "--profile") == 0)
+		{
+			profile = true;
+		}
+		else if(strcmp(argv[i], "--profile=cycles") == 0)
+		{
+			profile = true;
+			profile_cycles = true;
+		}
+		else if(strncmp(argv[i], "--sample-profile=", 17) == 0)
+		{
+			sample_hz = (unsigned)strtoul(argv[i] + 17, NULL, 10);
+		}
+		else if(strncmp(argv[i], "--sample-folded=", 16) == 0)
+		{
+			folded_file = argv[i] + 16;
+		}
+		else if(strncmp(argv[i], "--profile-sequences=", 20) == 0)
+		{
+			sequences = argv[i] + 20;
+		}
+		else if(argv[i][0] != '-' && filename == NULL)
+		{
+			filename = argv[i];
+		}
+		else if(argv[i][0] != '-' && (batch || multiplex))
+		{
+			inputs[inputs_cnt++] = argv[i];
+		}
+		else
+		{
+			print_usage();
+			return 1;
+		}
+	}
+
+	// the server executes the programs of its clients, which pass it their standard streams
+	if(serve_socket != NULL || client_socket != NULL)
 	{
-		printf("usage:\tyog <filename>\n");
+		if((serve_socket != NULL) == (filename != NULL) || (client_socket != NULL && serve_socket != NULL))
+		{
+			print_usage();
+			return 1;
+		}
+
+		if(!server_supported())
+		{
+			fprintf(stderr, "the server is not supported on this platform\n");
+			return 1;
+		}
+
+		if(batch || multiplex || lanes || profile || sample_hz > 0 || folded_file != NULL || sequences != NULL || c_file != NULL
+			|| io_threads || timeout > 0 || checkpoint_file != NULL || checkpoint_every > 0 || resume_file != NULL || compile_only
+			|| jit_dump_file != NULL || memoize || (client_socket != NULL && quantum != UINT64_MAX))
+		{
+			fprintf(stderr, "the server cannot be combined with the other execution modes\n");
+			return 1;
+		}
+
+		if(dispatch == DISPATCH_JIT || dispatch == DISPATCH_TIERED)
+		{
+			fprintf(stderr, "the served programs are interpreted, so that each request can be limited\n");
+			return 1;
+		}
+
+		if(client_socket != NULL)
+		{
+			size_t len = strlen(filename);
+			if(len > 5 && strcmp(filename + len - 5, ".yogc") == 0)
+			{
+				fprintf(stderr, "the server compiles the source code of the programs\n");
+				return 1;
+			}
+
+			return server_request(client_socket, filename, fuel, binary_input, binary_output, stderr);
+		}
+
+		struct server srv;
+		server_init(&srv, serve_socket, dispatch, workers_cnt > 0 ? workers_cnt : batch_processors());
+
+		// the requests are bounded and time-sliced unless the server is given its own limits
+		if(fuel != UINT64_MAX)
+			srv.fuel = fuel;
+
+		if(quantum != UINT64_MAX)
+			srv.quantum = quantum;
+
+		int status = server_serve(&srv, stderr);
+
+		if(stats && status == 0)
+		{
+			fprintf(stderr, "requests: %llu\n", (unsigned long long)srv.requests);
+			fprintf(stderr, "compilations: %llu\n", (unsigned long long)srv.compilations);
+			fprintf(stderr, "suspensions: %llu\n", (unsigned long long)srv.suspensions);
+		}
+
+		return status;
+	}
+
+	// a resumed execution continues the program of its snapshot
+	struct snapshot snap;
+	if(resume_file != NULL)
+	{
+		if(!snapshot_read(&snap, resume_file))
+		{
+			printf("failed to read the snapshot %s\n", resume_file);
+			return 2;
+		}
+
+		if(filename == NULL)
+			filename = snap.program;
+	}
+
+	if(filename == NULL || (inputs_cnt > 0 && !batch && !multiplex))
+	{
+		print_usage();
 		return 1;
 	}
 
-	const char *filename = argv[1];
+	if((dispatch == DISPATCH_JIT || dispatch == DISPATCH_TIERED) && !jit_supported())
+	{
+		fprintf(stderr, "native code not supported on this platform, using the threaded dispatch\n");
+		dispatch = DISPATCH_THREADED;
+	}
 
-	FILE *source = fopen(filename, "r");
-	if(!source)
+	if((fuel != UINT64_MAX || timeout > 0 || quantum != UINT64_MAX) && (dispatch == DISPATCH_JIT || dispatch == DISPATCH_TIERED))
 	{
-		printf("failed to open %s\n", filename);
-		return 2;
+		fprintf(stderr, "the native code cannot be limited\n");
+		return 1;
 	}
 
-	struct error_list errs;
-	error_list_init(&errs);
+	if(folded_file != NULL && sample_hz == 0)
+		sample_hz = 1000;
 
-	struct symbol_table st;
-	symbol_table_init(&st);
+	if(sample_hz > 0 && !sampler_supported())
+	{
+		fprintf(stderr, "sampling not supported on this platform\n");
+		sample_hz = 0;
+		folded_file = NULL;
+	}
 
-	struct parse_context ctx;
-	parse_context_init(&ctx, source, &st, &errs);
+	if(sample_hz > 0 && (dispatch == DISPATCH_JIT || dispatch == DISPATCH_TIERED || profile || sequences != NULL))
+	{
+		fprintf(stderr, "only the interpreted execution can be sampled\n");
+		return 1;
+	}
 
-	// parse the source code and obtain the abstract syntax tree
-	struct ast *tree = parse(&ctx);
+	if(batch && (lanes || profile || sample_hz > 0 || sequences != NULL || c_file != NULL))
+	{
+		fprintf(stderr, "the batch execution cannot be combined with the other execution modes\n");
+		return 1;
+	}
+
+	if(multiplex && (batch || lanes || profile || sample_hz > 0 || sequences != NULL || c_file != NULL || io_threads || timeout > 0))
+	{
+		fprintf(stderr, "the multiplexed execution cannot be combined with the other execution modes\n");
+		return 1;
+	}
+
+	if(lanes && (binary_input || binary_output))
+	{
+		fprintf(stderr, "the multi-lane execution reads and writes text lines\n");
+		return 1;
+	}
+
+	if(io_threads && !offload_supported())
+	{
+		fprintf(stderr, "I/O threads not supported on this platform\n");
+		io_threads = false;
+	}
+
+	if(io_threads && (lanes || batch || profile || sequences != NULL))
+	{
+		fprintf(stderr, "the I/O threads cannot be combined with the other execution modes\n");
+		return 1;
+	}
+
+	// the memo keys the executions with their whole input, which is read before them
+	if(memoize && (batch || multiplex || lanes || profile || sample_hz > 0 || sequences != NULL || c_file != NULL || io_threads
+		|| timeout > 0 || compile_only))
+	{
+		fprintf(stderr, "the memoized execution cannot be combined with the other execution modes\n");
+		return 1;
+	}
 
-	struct semantic_context sem_ctx;
-	semantic_context_init(&sem_ctx, &st, &errs, tree);
+	// the prompts would be mixed into the binary values, and the reader thread and the memo read ahead of them
+	if(binary_input || binary_output || io_threads || memoize)
+		interactive = false;
 
-	// analyse the abstract syntax tree and obtain the instruction list
-	struct instruction_list instrs = semantic_context_analyse(&sem_ctx);
+#ifdef _WIN32
+	if(binary_input)
+		_setmode(_fileno(stdin), _O_BINARY);
 
-	// check if a compile-time error has been occured
-	if(error_list_empty(errs))
+	if(binary_output)
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+	if(lanes && (dispatch == DISPATCH_JIT || dispatch == DISPATCH_TIERED || fuel != UINT64_MAX || timeout > 0
+		|| profile || sample_hz > 0 || sequences != NULL))
 	{
-		struct interpreter vm;
-		interpreter_init(&vm, instrs, sem_ctx.tmp_cnt);
+		fprintf(stderr, "the multi-lane execution cannot be combined with the other execution modes\n");
+		return 1;
+	}
 
-		// execute the instructions
-		interpreter_execute(&vm);
+	bool checkpoint = checkpoint_file != NULL || checkpoint_every > 0 || resume_file != NULL;
+
+	if(checkpoint && (dispatch == DISPATCH_JIT || dispatch == DISPATCH_TIERED || lanes || batch || multiplex || profile || io_threads
+		|| memoize || sample_hz > 0 || sequences != NULL || c_file != NULL || compile_only))
+	{
+		fprintf(stderr, "only the interpreted execution can be checkpointed\n");
+		return 1;
+	}
+
+	// the snapshots replace the snapshot the execution is resumed from
+	char snapshot_file[SNAPSHOT_PROGRAM_SIZE + 16];
+	if(checkpoint_file == NULL && resume_file != NULL)
+	{
+		checkpoint_file = resume_file;
+	}
+	else if(checkpoint_file == NULL && checkpoint)
+	{
+		snprintf(snapshot_file, sizeof(snapshot_file), "%s.snapshot", filename);
+		checkpoint_file = snapshot_file;
+	}
+
+	int status = 0;
+
+	// the bytecode is compiled from the source code or loaded from a precompiled file
+	struct compilation comp;
+	struct yogc image;
+	bool compiled = false;
+	bool loaded = false;
+	char cache_file[YOGC_PATH_SIZE];
+	size_t name_len = strlen(filename);
+
+	if(name_len > 5 && strcmp(filename + name_len - 5, ".yogc") == 0)
+	{
+		if(sequences != NULL || compile_only)
+		{
+			fprintf(stderr, "the bytecode is already compiled\n");
+			return 1;
+		}
+
+		if(!yogc_load(&image, filename, NULL))
+		{
+			printf("failed to load %s\n", filename);
+			return 2;
+		}
+
+		loaded = true;
+	}
+	else
+	{
+		size_t size;
+		char *source = yread_file(filename, &size);
+		if(!source)
+		{
+			printf("failed to open %s\n", filename);
+			return 2;
+		}
+
+		// the cache is keyed by the hash of the source code, the profile of the sequences needs the instructions
+		uint64_t hash = yogc_hash(source, size);
+		bool cached = use_cache && compile_file == NULL && yogc_cache_path(cache_file, hash);
+
+		if(cached && !compile_only && sequences == NULL)
+			loaded = yogc_load(&image, cache_file, &hash);
+
+		if(!loaded)
+		{
+			compiled = compile(&comp, source, size, stdout);
+
+			// a failure to store the bytecode only costs a compilation at the next execution
+			if(compiled && cached)
+				yogc_write(cache_file, &comp.bc, comp.lines, hash);
+		}
+
+		yfree(source);
+
+		if(compiled && compile_file != NULL && !yogc_write(compile_file, &comp.bc, comp.lines, hash))
+		{
+			printf("failed to write %s\n", compile_file);
+			status = 2;
+		}
+		else if(compiled && compile_only && compile_file == NULL && !cached)
+		{
+			printf("the bytecode cache is not available\n");
+			status = 2;
+		}
+	}
+
+	if(compiled || loaded)
+	{
+		// the bytecode and the line table are owned by the compilation or by the precompiled file
+		struct bytecode bc = compiled ? comp.bc : image.bc;
+		struct line_table lines = compiled ? comp.lines : image.lines;
+
+		if(stats)
+		{
+			fprintf(stderr, "instructions: %zu\n", bc.size);
+			fprintf(stderr, "variables: %zu\n", bc.vars_cnt);
+			if(compiled)
+				fprintf(stderr, "temporaries: %zu (%zu registers)\n", comp.tmp_cnt, bc.tmp_cnt);
+			else
+				fprintf(stderr, "temporaries: %zu registers (precompiled)\n", bc.tmp_cnt);
+
+			fprintf(stderr, "constants: %zu\n", bc.constants_cnt);
+		}
+
+		if(compile_only)
+		{
+			// the bytecode has been stored, it is not executed
+		}
+		else if(c_file != NULL)
+		{
+			// translate the bytecode to C instead of executing it
+			FILE *out = fopen(c_file, "w");
+			if(out)
+			{
+				emit_c(out, &bc, lines, filename);
+				fclose(out);
+			}
+			else
+			{
+				printf("failed to open %s\n", c_file);
+				status = 2;
+			}
+		}
+		else if(batch)
+		{
+			// execute the bytecode once for each input file, sharing it among the workers
+			struct batch runner;
+			batch_init(&runner, &bc, dispatch, workers_cnt > 0 ? workers_cnt : batch_processors());
+
+			runner.fuel = fuel;
+			runner.timeout = timeout;
+			runner.pin = pin;
+			runner.binary_input = binary_input;
+			runner.binary_output = binary_output;
+
+			status = batch_execute(&runner, inputs, inputs_cnt, stdout, stderr);
+
+			if(stats)
+			{
+				fprintf(stderr, "jobs: %zu\n", runner.jobs_cnt);
+				fprintf(stderr, "workers: %zu (%llu steals)\n", runner.workers_cnt, (unsigned long long)runner.steals);
+			}
+
+			batch_clear(&runner);
+		}
+		else if(multiplex)
+		{
+			// execute the bytecode once for each input, suspending the sessions without input
+			struct scheduler scheduler;
+			scheduler_init(&scheduler, &bc, dispatch, workers_cnt > 0 ? workers_cnt : batch_processors());
+
+			scheduler.fuel = fuel;
+			scheduler.quantum = quantum;
+			scheduler.binary_input = binary_input;
+			scheduler.binary_output = binary_output;
+
+			status = scheduler_execute(&scheduler, inputs, inputs_cnt, stdout, stderr);
+
+			if(stats)
+			{
+				fprintf(stderr, "sessions: %zu\n", inputs_cnt);
+				fprintf(stderr, "workers: %zu (%llu steals)\n", scheduler.workers_cnt, (unsigned long long)scheduler.steals);
+				fprintf(stderr, "suspensions: %llu\n", (unsigned long long)scheduler.suspensions);
+			}
+		}
+		else if(lanes)
+		{
+			// execute the bytecode over the input records, many at once
+			struct lanes vm;
+			lanes_init(&vm, &bc);
+			status = lanes_execute(&vm, lines, stdin, stdout, stderr);
+
+			if(stats)
+			{
+				fprintf(stderr, "records: %llu\n", (unsigned long long)vm.records);
+				fprintf(stderr, "groups: %llu (%llu diverged)\n", (unsigned long long)vm.groups, (unsigned long long)vm.diverged);
+			}
+
+			lanes_clear(&vm);
+		}
+		else
+		{
+			struct interpreter vm;
+			interpreter_init(&vm, &bc, dispatch);
+
+			vm.tier_threshold = tier_threshold;
+			vm.tier_log = tier_log ? stderr : NULL;
+			vm.interactive = interactive;
+			vm.input.binary = binary_input;
+			vm.output.binary = binary_output;
+			output_configure(&vm.output, output_buffer, line_buffered);
+
+			if((fuel != UINT64_MAX || timeout > 0) && !checkpoint)
+				interpreter_limit(&vm, fuel, timeout);
+
+			if(jit_dump_file != NULL && !jit_dump(vm.jit, jit_dump_file))
+				printf("failed to open %s\n", jit_dump_file);
+
+			if(sequences != NULL || profile)
+			{
+				// execute the bytecode counting the executions of each instruction
+				uint64_t *counts = ycalloc(bc.size, sizeof(uint64_t));
+				uint64_t *cycles = profile_cycles ? ycalloc(bc.size, sizeof(uint64_t)) : NULL;
+				interpreter_execute_counting(&vm, counts, cycles);
+
+				status = report_runtime_error(vm.status, lines, vm.pc, vm.retired);
+
+				if(profile)
+					profile_report(stderr, &bc, lines, cycles != NULL ? cycles : counts,
+						cycles != NULL ? "cycles" : "executed instructions", counts, filename);
+
+				if(sequences != NULL)
+				{
+					FILE *out = fopen(sequences, "a");
+					if(out)
+					{
+						write_sequence_profile(out, comp.instrs, counts);
+						fclose(out);
+					}
+					else
+					{
+						printf("failed to open %s\n", sequences);
+					}
+				}
+
+				yfree(cycles);
+				yfree(counts);
+			}
+			else if(resume_file != NULL && !snapshot_restore(&snap, &vm))
+			{
+				printf("the snapshot %s has not been taken from %s\n", resume_file, filename);
+				status = 2;
+			}
+			else if(memoize && memo_reads(&bc) && input_is_terminal(stdin))
+			{
+				// the whole input is read before the execution, so a terminal would be read without prompts until its end
+				fprintf(stderr, "the memoized execution reads its whole input first, which cannot be a terminal\n");
+				status = 1;
+			}
+			else
+			{
+				struct sampler sampler;
+				struct checkpointer cp;
+				struct offload offload;
+				struct memo memo;
+				char memo_path[YOGC_PATH_SIZE];
+				uint64_t program = snapshot_hash(&bc);
+
+				// the memo is kept with the bytecode cache unless given a file
+				if(memoize)
+				{
+					memo_init(&memo, memo_size);
+
+					if(memo_file == NULL && use_cache && memo_cache_path(memo_path, program))
+						memo_file = memo_path;
+
+					if(memo_file != NULL)
+						memo_load(&memo, memo_file);
+				}
+
+				if(sample_hz > 0)
+					sampler_start(&sampler, &vm, sample_hz);
+
+				if(io_threads)
+					offload_start(&offload, &vm);
+
+				// the checkpointer limits the execution, which it resumes after each snapshot
+				if(checkpoint)
+					checkpointer_start(&cp, &vm, checkpoint_file, filename, checkpoint_every, fuel, timeout);
+
+				// execute the bytecode
+				enum interpreter_status outcome = checkpoint ? checkpointer_execute(&cp, &vm)
+					: memoize ? memo_execute(&memo, &vm, program) : interpreter_execute(&vm);
+
+				if(memoize)
+				{
+					// a failure to save the memo only costs the executions of the next runs
+					if(memo_file != NULL && memo.modified && !memo_save(&memo, memo_file))
+						fprintf(stderr, "failed to write the memo %s\n", memo_file);
+
+					if(stats)
+						fprintf(stderr, "memo: %llu hits, %llu misses, %llu evictions\n", (unsigned long long)memo.hits,
+							(unsigned long long)memo.misses, (unsigned long long)memo.evictions);
+
+					memo_clear(&memo);
+				}
+
+				// the written values precede the reports
+				if(io_threads)
+				{
+					offload_stop(&offload);
+
+					if(stats)
+						fprintf(stderr, "read stalls: %llu\nwrite stalls: %llu\n",
+							(unsigned long long)offload.read_stalls, (unsigned long long)offload.write_stalls);
+				}
+
+				if(checkpoint)
+				{
+					checkpointer_stop(&cp);
+
+					if(stats)
+						fprintf(stderr, "snapshots: %llu\n", (unsigned long long)cp.written);
+				}
+
+				if(sample_hz > 0)
+				{
+					sampler_stop(&sampler);
+					profile_report(stderr, &bc, lines, sampler.samples, "samples", NULL, filename);
+
+					if(folded_file != NULL)
+					{
+						FILE *out = fopen(folded_file, "w");
+						if(out)
+						{
+							profile_write_folded(out, &bc, lines, sampler.samples, filename);
+							fclose(out);
+						}
+						else
+						{
+							printf("failed to open %s\n", folded_file);
+						}
+					}
+
+					sampler_clear(&sampler);
+				}
+
+				status = report_runtime_error(outcome, lines, vm.pc, vm.retired);
+			}
+
+			interpreter_clear(&vm);
+		}
 
-		interpreter_clear(&vm);
 	}
 	else
 	{
-		error_list_show(errs);
+		// the translation has not been produced
+		if(c_file != NULL || compile_only)
+			status = 3;
 	}
 
 	// cleanup
-	instruction_list_clear(&instrs);
-	ast_clear(tree);
-	symbol_table_clear(&st);
-	error_list_clear(&errs);
-	fclose(source);
+	if(compiled)
+		compilation_clear(&comp);
+
+	if(loaded)
+		yogc_clear(&image);
 
-	return 0;
+	if(resume_file != NULL)
+		snapshot_clear(&snap);
+
+	return status;
 }
 
+
+// report the runtime error which stopped an execution and return its exit status, zero if none
+int report_runtime_error(enum interpreter_status outcome, struct line_table lines, size_t pc, uint64_t retired)
+{
+	switch(outcome)
+	{
+		case INTERPRETER_FUEL_EXHAUSTED:
+		case INTERPRETER_DEADLINE_EXCEEDED:
+			fprintf(stderr, "%s at instruction %zu after %llu instructions\n",
+				outcome == INTERPRETER_FUEL_EXHAUSTED ? "fuel exhausted" : "deadline exceeded", pc, (unsigned long long)retired);
+			return outcome == INTERPRETER_FUEL_EXHAUSTED ? 4 : 5;
+
+		case INTERPRETER_DIVISION_BY_ZERO:
+			fprintf(stderr, "division by zero at line %zu\n", line_table_find(lines, pc).row);
+			return 6;
+
+		// the execution is not resumed, so a non-blocking input without a value yet ends it
+		case INTERPRETER_END_OF_INPUT:
+		case INTERPRETER_NEEDS_INPUT:
+			fprintf(stderr, "end of input at line %zu\n", line_table_find(lines, pc).row);
+			return 7;
+
+		case INTERPRETER_INVALID_INPUT:
+			fprintf(stderr, "invalid input at line %zu\n", line_table_find(lines, pc).row);
+			return 8;
+
+		default:
+			return 0;
+	}
+}
@@ -0,0 +1,330 @@
+
+// the file mapping is not part of the strict C99 environment
+#if defined(__unix__) || defined(__APPLE__)
+#define YOG_MMAP
+#define _POSIX_C_SOURCE 200809L
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <errno.h>
+
+#include "yogc.h"
+#include "superinstructions.h"
+
+// the operations and the superinstructions, whose numbering is stored in the instructions
+#define LAYOUT_0(name) #name " "
+#define LAYOUT_1(name, k) #name "_" #k " "
+#define LAYOUT_2(name, k1, k2) #name "_" #k1 #k2 " "
+#define SUPER_LAYOUT_2(a, b) #a "+" #b " "
+#define SUPER_LAYOUT_3(a, b, c) #a "+" #b "+" #c " "
+
+static const char Layout[] =
+	OPCODE_LIST(LAYOUT_0, LAYOUT_1, LAYOUT_2)
+	SUPERINSTRUCTION_PAIRS(SUPER_LAYOUT_2)
+	SUPERINSTRUCTION_TRIPLES(SUPER_LAYOUT_3);
+
+uint64_t layout_fingerprint(void);
+uint64_t hash_bytes(uint64_t hash, const void *data, size_t size);
+size_t align8(size_t offset);
+bool write_section(FILE *out, size_t *pos, size_t offset, const void *data, size_t size);
+bool valid_section(const struct yogc_header *header, uint64_t offset, uint64_t cnt, size_t size);
+bool valid_lines(struct line_table lines);
+bool make_directories(char *path);
+
+uint64_t yogc_hash(const char *source, size_t size)
+{
+	uint64_t hash = layout_fingerprint();
+	return hash_bytes(hash, source, size);
+}
+
+bool yogc_write(const char *filename, const struct bytecode *bc, struct line_table lines, uint64_t hash)
+{
+	struct yogc_header header;
+	memset(&header, 0, sizeof(header));
+
+	memcpy(header.magic, "YOGC", 4);
+	header.version = YOGC_VERSION;
+	header.layout = layout_fingerprint();
+	header.hash = hash;
+	header.size = bc->size;
+	header.constants_cnt = bc->constants_cnt;
+	header.vars_cnt = bc->vars_cnt;
+	header.tmp_cnt = bc->tmp_cnt;
+	header.lines_cnt = lines.size;
+
+	header.code_offset = align8(sizeof(header));
+	header.constants_offset = align8(header.code_offset + bc->size * sizeof(struct bytecode_instruction));
+	header.names_offset = align8(header.constants_offset + bc->constants_cnt * sizeof(int64_t));
+	header.lines_offset = align8(header.names_offset + bc->vars_cnt * ID_STR_SIZE);
+	header.file_size = header.lines_offset + lines.size * sizeof(struct line_entry);
+
+	// write a temporary file and rename it, which replaces the file at once
+	char tmp[YOGC_PATH_SIZE];
+#ifdef YOG_MMAP
+	snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", filename, (long)getpid());
+#else
+	snprintf(tmp, sizeof(tmp), "%s.tmp", filename);
+#endif
+
+	FILE *out = fopen(tmp, "wb");
+	if(!out)
+		return false;
+
+	size_t pos = 0;
+	bool written = write_section(out, &pos, 0, &header, sizeof(header))
+		&& write_section(out, &pos, header.code_offset, bc->code, bc->size * sizeof(struct bytecode_instruction))
+		&& write_section(out, &pos, header.constants_offset, bc->constants, bc->constants_cnt * sizeof(int64_t))
+		&& write_section(out, &pos, header.names_offset, bc->names, bc->vars_cnt * ID_STR_SIZE)
+		&& write_section(out, &pos, header.lines_offset, lines.entries, lines.size * sizeof(struct line_entry));
+
+	written = fclose(out) == 0 && written;
+
+#ifndef YOG_MMAP
+	remove(filename);
+#endif
+
+	if(!written || rename(tmp, filename) != 0)
+	{
+		remove(tmp);
+		return false;
+	}
+
+	return true;
+}
+
+bool yogc_load(struct yogc *image, const char *filename, const uint64_t *hash)
+{
+	image->base = NULL;
+	image->size = 0;
+	image->mapped = false;
+
+#ifdef YOG_MMAP
+	int fd = open(filename, O_RDONLY);
+	if(fd < 0)
+		return false;
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(struct yogc_header))
+	{
+		close(fd);
+		return false;
+	}
+
+	void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if(base == MAP_FAILED)
+		return false;
+
+	image->base = base;
+	image->size = st.st_size;
+	image->mapped = true;
+#else
+	FILE *in = fopen(filename, "rb");
+	if(!in)
+		return false;
+
+	size_t capacity = 4096;
+	image->base = ymalloc(capacity);
+
+	size_t cnt;
+	while((cnt = fread((char *)image->base + image->size, 1, capacity - image->size, in)) > 0)
+	{
+		image->size += cnt;
+
+		if(image->size == capacity)
+		{
+			capacity *= 2;
+			image->base = yrealloc(image->base, capacity);
+		}
+	}
+
+	fclose(in);
+#endif
+
+	const struct yogc_header *header = image->base;
+
+	bool valid = image->size >= sizeof(struct yogc_header)
+		&& memcmp(header->magic, "YOGC", 4) == 0
+		&& header->version == YOGC_VERSION
+		&& header->layout == layout_fingerprint()
+		&& (hash == NULL || header->hash == *hash)
+		&& header->file_size == image->size
+		&& valid_section(header, header->code_offset, header->size, sizeof(struct bytecode_instruction))
+		&& valid_section(header, header->constants_offset, header->constants_cnt, sizeof(int64_t))
+		&& valid_section(header, header->names_offset, header->vars_cnt, ID_STR_SIZE)
+		&& valid_section(header, header->lines_offset, header->lines_cnt, sizeof(struct line_entry))
+		&& header->vars_cnt + header->tmp_cnt <= UINT32_MAX;
+
+	if(!valid)
+	{
+		yogc_clear(image);
+		return false;
+	}
+
+	// the sections are used in place, the mapping is read-only as the bytecode
+	char *bytes = image->base;
+
+	image->bc.code = (struct bytecode_instruction *)(bytes + header->code_offset);
+	image->bc.size = header->size;
+	image->bc.constants = (int64_t *)(bytes + header->constants_offset);
+	image->bc.constants_cnt = header->constants_cnt;
+	image->bc.names = (char (*)[ID_STR_SIZE])(bytes + header->names_offset);
+	image->bc.vars_cnt = header->vars_cnt;
+	image->bc.tmp_cnt = header->tmp_cnt;
+
+	image->lines.entries = (struct line_entry *)(bytes + header->lines_offset);
+	image->lines.size = header->lines_cnt;
+	image->lines.capacity = header->lines_cnt;
+
+	// the instructions are verified once, so that the interpreters execute them without checks
+	if(!bytecode_valid(&image->bc) || !valid_lines(image->lines))
+	{
+		yogc_clear(image);
+		return false;
+	}
+
+	return true;
+}
+
+void yogc_clear(struct yogc *image)
+{
+#ifdef YOG_MMAP
+	if(image->mapped)
+		munmap(image->base, image->size);
+	else
+		yfree(image->base);
+#else
+	yfree(image->base);
+#endif
+
+	image->base = NULL;
+	image->size = 0;
+	image->mapped = false;
+}
+
+bool yogc_cache_path(char *path, uint64_t hash)
+{
+	const char *dir = getenv("YOG_CACHE_DIR");
+	const char *base = getenv("XDG_CACHE_HOME");
+	const char *home = getenv("HOME");
+	int len;
+
+	if(dir != NULL && dir[0] != '\0')
+		len = snprintf(path, YOGC_PATH_SIZE, "%s", dir);
+	else if(base != NULL && base[0] != '\0')
+		len = snprintf(path, YOGC_PATH_SIZE, "%s/yog", base);
+	else if(home != NULL && home[0] != '\0')
+		len = snprintf(path, YOGC_PATH_SIZE, "%s/.cache/yog", home);
+	else
+		return false;
+
+	if(len < 0 || len >= YOGC_PATH_SIZE - 32 || !make_directories(path))
+		return false;
+
+	snprintf(path + len, YOGC_PATH_SIZE - len, "/%016llx.yogc", (unsigned long long)hash);
+
+	return true;
+}
+
+// the fingerprint of the layout of the bytecode in memory, a file written with another layout is not loaded
+uint64_t layout_fingerprint(void)
+{
+	const size_t sizes[] =
+	{
+		sizeof(struct bytecode_instruction),
+		sizeof(struct line_entry),
+		sizeof(size_t),
+		ID_STR_SIZE,
+		1 // whose bytes depend on the byte order
+	};
+
+	uint64_t hash = 14695981039346656037ULL;
+	hash = hash_bytes(hash, sizes, sizeof(sizes));
+	hash = hash_bytes(hash, Layout, sizeof(Layout));
+
+	return hash;
+}
+
+// FNV-1a hash
+uint64_t hash_bytes(uint64_t hash, const void *data, size_t size)
+{
+	const unsigned char *bytes = data;
+
+	for(size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+size_t align8(size_t offset)
+{
+	return (offset + 7) & ~(size_t)7;
+}
+
+// write the padding up to the offset of a section and the section
+bool write_section(FILE *out, size_t *pos, size_t offset, const void *data, size_t size)
+{
+	static const char Padding[8] = { 0 };
+
+	if(offset > *pos && fwrite(Padding, 1, offset - *pos, out) != offset - *pos)
+		return false;
+
+	if(size > 0 && fwrite(data, 1, size, out) != size)
+		return false;
+
+	*pos = offset + size;
+
+	return true;
+}
+
+bool valid_section(const struct yogc_header *header, uint64_t offset, uint64_t cnt, size_t size)
+{
+	return offset % 8 == 0 && offset >= sizeof(struct yogc_header) && offset <= header->file_size
+		&& cnt <= (header->file_size - offset) / size;
+}
+
+// the entries of the line table are sorted by instruction index
+bool valid_lines(struct line_table lines)
+{
+	for(size_t i = 1; i < lines.size; i++)
+	{
+		if(lines.entries[i].pc < lines.entries[i - 1].pc)
+			return false;
+	}
+
+	return true;
+}
+
+// create the directories of a path, as mkdir -p
+bool make_directories(char *path)
+{
+#ifdef YOG_MMAP
+	for(char *c = path + 1; ; c++)
+	{
+		if(*c == '/' || *c == '\0')
+		{
+			char saved = *c;
+			*c = '\0';
+
+			int result = mkdir(path, 0777);
+			*c = saved;
+
+			if(result != 0 && errno != EEXIST)
+				return false;
+
+			if(saved == '\0')
+				return true;
+		}
+	}
+#else
+	(void)path;
+	return true;
+#endif
+}
@@ -0,0 +1,52 @@
+
+# the outputs of a batch and of the multiplexed sessions are written in the order of the inputs, whichever job ends first
+
+. "$(dirname "$0")/common.sh"
+
+cat > spin.yog <<'YOG'
+var
+	n : int;
+	i : int;
+begin
+	read n;
+	i := 0;
+	while(i < n)
+	begin
+		i := i + 1;
+	end
+	write n;
+	write i;
+end
+YOG
+
+# the first inputs take the longest, so the later jobs end first
+inputs=""
+: > expected.out
+
+for k in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16
+do
+	n=$(((17 - k) * 50000 + k))
+	printf '%s\n' "$n" > in$k.txt
+	printf '%s\n%s\n' "$n" "$n" >> expected.out
+	inputs="$inputs in$k.txt"
+done
+
+for jobs in 1 4
+do
+	expect "batch -j$jobs" 0 expected.out "$YOG" --batch -j$jobs spin.yog $inputs
+	expect "multiplexed -j$jobs" 0 expected.out "$YOG" --multiplex -j$jobs spin.yog $inputs
+	expect "multiplexed -j$jobs with a quantum" 0 expected.out "$YOG" --multiplex -j$jobs --quantum=1000 spin.yog $inputs
+done
+
+# a failed job reports its failure, keeps the outputs of the others in order and sets the exit status
+printf '1\n' > one.txt
+printf '1\n1\n1\n1\n' > expected.out
+
+expect "batch with a missing input" 2 expected.out "$YOG" --batch -j4 spin.yog one.txt missing.txt one.txt
+expect_message "batch with a missing input" "missing.txt"
+
+printf 'x\n' > invalid.txt
+expect "batch with an invalid input" 8 expected.out "$YOG" --batch -j4 spin.yog one.txt invalid.txt one.txt
+expect_message "batch with an invalid input" "invalid.txt: invalid input"
+
+finish
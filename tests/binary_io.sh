@@ -0,0 +1,58 @@
+
+# the values read and written as raw little-endian integers, with each execution mode
+
+. "$(dirname "$0")/common.sh"
+
+cat > copy.yog <<'YOG'
+var
+	n : int;
+	x : int;
+begin
+	read n;
+	write n;
+	while(n > 0)
+	begin
+		read x;
+		write x;
+		n := n - 1;
+	end
+end
+YOG
+
+# the count of the values, then the values
+seq -3000 7 3000 > values.txt
+printf '%s\n%s\n%s\n' 9223372036854775807 -9223372036854775807 0 >> values.txt
+wc -l < values.txt | tr -d ' ' > copy.in
+cat values.txt >> copy.in
+
+printf '\014\0\0\0\0\0\0\0' > sum.bin
+printf '\005\0\0\0\0\0\0\0\007\0\0\0\0\0\0\0' > sum.bin.in
+printf '12\n' > sum.out
+printf '\375\377\377\377\377\377\377\377' > negative.bin
+printf '\003\0\0\0\0\0\0\0' > abs.bin
+
+modes="--dispatch=threaded --dispatch=call --io-threads"
+[ "$(uname -m)" = x86_64 ] && modes="$modes --jit --tiered"
+
+for mode in $modes
+do
+	expect "$mode binary output" 0 sum.bin "$YOG" $mode --io=binary-out "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+	expect "$mode binary input" 0 sum.out "$YOG" $mode --io=binary-in "$EXAMPLES/sum.yog" < sum.bin.in
+	expect "$mode binary" 0 abs.bin "$YOG" $mode --io=binary "$EXAMPLES/abs.yog" < negative.bin
+
+	# the text converted to binary and back is unchanged
+	"$YOG" $mode --io=binary-out copy.yog < copy.in > copy.bin
+	expect "$mode round trip" 0 copy.in "$YOG" $mode --io=binary-in copy.yog < copy.bin
+	expect "$mode binary copy" 0 copy.bin "$YOG" $mode --io=binary copy.yog < copy.bin
+
+	# a value cut short is invalid, a missing one ends the input
+	head -c 11 sum.bin.in > truncated.bin
+	expect "$mode truncated value" 8 "" "$YOG" $mode --io=binary-in "$EXAMPLES/sum.yog" < truncated.bin
+	expect_message "$mode truncated value" "invalid input at line 12"
+
+	head -c 8 sum.bin.in > short.bin
+	expect "$mode missing value" 7 "" "$YOG" $mode --io=binary-in "$EXAMPLES/sum.yog" < short.bin
+	expect_message "$mode missing value" "end of input at line 12"
+done
+
+finish
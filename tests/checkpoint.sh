@@ -0,0 +1,68 @@
+
+# an execution stopped after a checkpoint and resumed from its snapshot writes the output of an execution never stopped
+
+. "$(dirname "$0")/common.sh"
+
+cat > acc.yog <<'YOG'
+var
+	n : int;
+	x : int;
+	s : int;
+	i : int;
+begin
+	read n;
+	s := 0;
+	while(n > 0)
+	begin
+		read x;
+		i := 0;
+		while(i < 1000)
+		begin
+			s := s + x;
+			i := i + 1;
+		end
+		write s;
+		n := n - 1;
+	end
+end
+YOG
+
+printf '50\n' > acc.in
+i=1
+while [ $i -le 50 ]
+do
+	printf '%s\n' $i >> acc.in
+	i=$((i + 1))
+done
+
+"$YOG" acc.yog < acc.in > full.out
+
+for dispatch in threaded call
+do
+	# the fuel stops the execution between two checkpoints, the resumed one truncates the output written since the last one
+	expect "$dispatch stopped" 4 "" "$YOG" --dispatch=$dispatch --checkpoint-every=20000 --fuel=100000 acc.yog < acc.in
+	cp stdout.txt resumed.out
+	cmp -s full.out resumed.out && fail "$dispatch not stopped"
+
+	"$YOG" --resume acc.yog.snapshot < acc.in >> resumed.out 2> stderr.txt
+	status=$?
+	[ $status -eq 0 ] || fail "$dispatch resumed from a file: exit status $status instead of 0"
+	cmp -s full.out resumed.out || fail "$dispatch resumed from a file: unexpected output"
+
+	# an input pipe skips the values read before the snapshot
+	"$YOG" --dispatch=$dispatch --checkpoint=acc.snap --checkpoint-every=20000 --fuel=100000 acc.yog < acc.in > resumed.out 2> /dev/null
+	cat acc.in | "$YOG" --resume acc.snap >> resumed.out 2> stderr.txt
+	status=$?
+	[ $status -eq 0 ] || fail "$dispatch resumed from a pipe: exit status $status instead of 0"
+	cmp -s full.out resumed.out || fail "$dispatch resumed from a pipe: unexpected output"
+done
+
+# a snapshot only resumes its program
+expect "another program" 2 "" "$YOG" --resume acc.snap "$EXAMPLES/count.yog" < acc.in
+expect_message "another program" "has not been taken from"
+
+head -c 50 acc.snap > truncated.snap
+expect "truncated snapshot" 2 "" "$YOG" --resume truncated.snap < acc.in
+expect_message "truncated snapshot" "failed to read the snapshot"
+
+finish
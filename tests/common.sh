@@ -0,0 +1,65 @@
+
+# the helpers of the regression tests, which are run with the yog executable and the examples directory as arguments
+
+YOG=$1
+EXAMPLES=$2
+FAILURES=0
+
+# the files of a test and the bytecode cache are kept in a temporary directory, removed when the test exits
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+YOG_CACHE_DIR=$WORK/cache
+export YOG_CACHE_DIR
+cd "$WORK" || exit 1
+
+# report a failed check: fail <description>
+fail()
+{
+	echo "FAIL: $1" >&2
+	FAILURES=$((FAILURES + 1))
+}
+
+# run a command and check its exit status and, unless empty, its output: expect <description> <status> <output file> <command...>
+# the standard output and error are kept in stdout.txt and stderr.txt for expect_message
+expect()
+{
+	description=$1
+	status=$2
+	expected=$3
+	shift 3
+
+	"$@" > stdout.txt 2> stderr.txt
+	actual=$?
+
+	[ "$actual" -eq "$status" ] || fail "$description: exit status $actual instead of $status"
+	[ -z "$expected" ] || cmp -s "$expected" stdout.txt || fail "$description: unexpected output"
+}
+
+# check the messages of the last command, which the failures to load write to the standard output: expect_message <description> <text>
+expect_message()
+{
+	grep -F -q -- "$2" stderr.txt stdout.txt || fail "$1: no message \"$2\""
+}
+
+# the infinite loop used to exhaust the fuel and the deadline
+write_loop()
+{
+	cat > loop.yog <<'YOG'
+var
+	x : int;
+begin
+	x := 0;
+	while(1 < 2)
+	begin
+		x := x + 1;
+	end
+end
+YOG
+}
+
+# exit with the outcome of the checks
+finish()
+{
+	[ "$FAILURES" -eq 0 ] || exit 1
+	exit 0
+}
@@ -0,0 +1,42 @@
+
+# the exit statuses and the messages of the runtime errors, with each dispatch technique
+
+. "$(dirname "$0")/common.sh"
+
+write_loop
+printf '12\n' > sum.out
+
+for dispatch in threaded call
+do
+	expect "$dispatch halted" 0 sum.out "$YOG" --dispatch=$dispatch "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+
+	expect "$dispatch fuel" 4 "" "$YOG" --dispatch=$dispatch --fuel=1000 loop.yog < /dev/null
+	expect_message "$dispatch fuel" "fuel exhausted at instruction"
+
+	expect "$dispatch deadline" 5 "" "$YOG" --dispatch=$dispatch --timeout=1 loop.yog < /dev/null
+	expect_message "$dispatch deadline" "deadline exceeded at instruction"
+
+	expect "$dispatch division" 6 "" "$YOG" --dispatch=$dispatch "$EXAMPLES/divbyzero.yog" < /dev/null
+	expect_message "$dispatch division" "division by zero at line 4"
+
+	expect "$dispatch end of input" 7 "" "$YOG" --dispatch=$dispatch "$EXAMPLES/sum.yog" < /dev/null
+	expect_message "$dispatch end of input" "end of input at line 11"
+
+	printf '5\nx\n' > invalid.in
+	expect "$dispatch invalid input" 8 "" "$YOG" --dispatch=$dispatch "$EXAMPLES/sum.yog" < invalid.in
+	expect_message "$dispatch invalid input" "invalid input at line 12"
+done
+
+# the profiled executions are limited as well
+for profile in --profile --profile=cycles
+do
+	expect "$profile fuel" 4 "" "$YOG" $profile --fuel=1000000 loop.yog < /dev/null
+	expect_message "$profile fuel" "fuel exhausted at instruction"
+
+	expect "$profile deadline" 5 "" "$YOG" $profile --timeout=1 loop.yog < /dev/null
+	expect_message "$profile deadline" "deadline exceeded at instruction"
+done
+
+expect "missing program" 2 "" "$YOG" missing.yog < /dev/null
+
+finish
@@ -0,0 +1,48 @@
+# each record of --lanes has the output, the runtime error and the line of a plain execution over it
+
+. "$(dirname "$0")/common.sh"
+
+cat > records.in <<'IN'
+5 7
+5
+5 x 7
+99999999999999999999 1
+-9223372036854775808 0
+
++3 	4
+3 4 5
+-
+IN
+
+"$YOG" --lanes "$EXAMPLES/sum.yog" < records.in > lanes.out 2> lanes.err
+status=$?
+
+# the first failed record is the second one, which ends its input
+[ "$status" -eq 7 ] || fail "lanes: exit status $status instead of 7"
+
+record=0
+
+while IFS= read -r line
+do
+	record=$((record + 1))
+
+	printf '%s\n' "$line" > record.in
+	"$YOG" "$EXAMPLES/sum.yog" < record.in > record.out 2> record.err
+	scalar=$?
+
+	# the lanes write the values of a record on one line
+	expected=$(tr '\n' ' ' < record.out | sed 's/ $//')
+	actual=$(sed -n "${record}p" lanes.out)
+	[ "$actual" = "$expected" ] || fail "record $record: output \"$actual\" instead of \"$expected\""
+
+	if [ "$scalar" -eq 0 ]
+	then
+		! grep -q "^record $record:" lanes.err || fail "record $record: reported without a runtime error"
+	else
+		grep -F -q -x "record $record: $(cat record.err)" lanes.err || fail "record $record: no report \"$(cat record.err)\""
+	fi
+done < records.in
+
+[ "$record" -eq "$(wc -l < lanes.out)" ] || fail "lanes: $(wc -l < lanes.out) output lines for $record records"
+
+finish
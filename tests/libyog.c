@@ -0,0 +1,170 @@
+// libyog: compile and run programs through the embedding API, with the values read and written by callbacks
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libyog.h"
+
+#define VALUES_MAX 16
+
+// the values given to the read statements and taken from the write statements
+struct io
+{
+	int64_t inputs[VALUES_MAX];
+	size_t inputs_cnt;
+	size_t next_input;
+	char names[VALUES_MAX][8];
+	int64_t outputs[VALUES_MAX];
+	size_t outputs_cnt;
+};
+
+int test_failures = 0;
+
+void test_check(bool condition, const char *description);
+bool read_input(void *data, const char *name, int64_t *value);
+void write_output(void *data, int64_t value);
+struct yog_program *compile_source(const char *source);
+void test_callbacks(void);
+void test_fuel(void);
+void test_compile_error(void);
+void test_status_str(void);
+
+int main(void)
+{
+	test_callbacks();
+	test_fuel();
+	test_compile_error();
+	test_status_str();
+
+	return test_failures == 0 ? 0 : 1;
+}
+
+void test_check(bool condition, const char *description)
+{
+	if(!condition)
+	{
+		fprintf(stderr, "FAIL: %s\n", description);
+		test_failures++;
+	}
+}
+
+bool read_input(void *data, const char *name, int64_t *value)
+{
+	struct io *io = data;
+
+	if(io->next_input == io->inputs_cnt)
+		return false;
+
+	snprintf(io->names[io->next_input], sizeof(io->names[0]), "%s", name);
+	*value = io->inputs[io->next_input++];
+
+	return true;
+}
+
+void write_output(void *data, int64_t value)
+{
+	struct io *io = data;
+
+	if(io->outputs_cnt < VALUES_MAX)
+		io->outputs[io->outputs_cnt] = value;
+
+	io->outputs_cnt++;
+}
+
+struct yog_program *compile_source(const char *source)
+{
+	struct yog_program *program = NULL;
+	enum yog_status status = yog_compile(source, strlen(source), stderr, &program);
+
+	test_check(status == YOG_OK && program != NULL, "compile: the program is not compiled");
+
+	return program;
+}
+
+// the values are read and written through the callbacks, over many runs of a context
+void test_callbacks(void)
+{
+	struct yog_program *program = compile_source(
+		"var\n"
+		"\ta : int;\n"
+		"\tb : int;\n"
+		"begin\n"
+		"\tread a;\n"
+		"\tread b;\n"
+		"\twrite a + b;\n"
+		"\twrite a * b;\n"
+		"end\n");
+
+	if(program == NULL)
+		return;
+
+	struct yog_context *ctx = yog_context_new(program);
+	test_check(ctx != NULL, "context: no context");
+
+	struct io io = {.inputs = {5, 7}, .inputs_cnt = 2};
+	yog_context_set_callbacks(ctx, read_input, write_output, &io);
+
+	test_check(yog_run(ctx) == YOG_OK, "callbacks: the run fails");
+	test_check(io.outputs_cnt == 2 && io.outputs[0] == 12 && io.outputs[1] == 35, "callbacks: unexpected outputs");
+	test_check(strcmp(io.names[0], "a") == 0 && strcmp(io.names[1], "b") == 0, "callbacks: unexpected read variables");
+	test_check(yog_context_line(ctx) == 0, "callbacks: a line after a complete run");
+
+	// a run without enough values ends its input at the second read
+	io = (struct io){.inputs = {5}, .inputs_cnt = 1};
+
+	test_check(yog_run(ctx) == YOG_END_OF_INPUT, "end of input: unexpected status");
+	test_check(yog_context_line(ctx) == 6, "end of input: unexpected line");
+	test_check(io.outputs_cnt == 0, "end of input: unexpected outputs");
+
+	yog_context_free(ctx);
+	yog_program_free(program);
+}
+
+// the fuel stops an endless loop in its body
+void test_fuel(void)
+{
+	struct yog_program *program = compile_source(
+		"var\n"
+		"\tx : int;\n"
+		"begin\n"
+		"\tx := 0;\n"
+		"\twhile(1 < 2)\n"
+		"\tbegin\n"
+		"\t\tx := x + 1;\n"
+		"\tend\n"
+		"end\n");
+
+	if(program == NULL)
+		return;
+
+	struct yog_context *ctx = yog_context_new(program);
+	yog_context_set_limits(ctx, 1000, 0);
+
+	test_check(yog_run(ctx) == YOG_FUEL_EXHAUSTED, "fuel: unexpected status");
+
+	size_t line = yog_context_line(ctx);
+	test_check(line >= 5 && line <= 7, "fuel: the run does not stop in the loop");
+
+	yog_context_free(ctx);
+	yog_program_free(program);
+}
+
+void test_compile_error(void)
+{
+	const char *source = "var\n\tx : int;\nbegin\n\tx := ;\nend\n";
+	struct yog_program *program = (struct yog_program *)&test_failures;
+
+	test_check(yog_compile(source, strlen(source), NULL, &program) == YOG_COMPILE_ERROR, "compile error: unexpected status");
+	test_check(program == NULL, "compile error: a program is returned");
+}
+
+void test_status_str(void)
+{
+	test_check(strcmp(yog_status_str(YOG_OK), "ok") == 0, "status: YOG_OK");
+	test_check(strcmp(yog_status_str(YOG_COMPILE_ERROR), "compile error") == 0, "status: YOG_COMPILE_ERROR");
+	test_check(strcmp(yog_status_str(YOG_DIVISION_BY_ZERO), "division by zero") == 0, "status: YOG_DIVISION_BY_ZERO");
+	test_check(strcmp(yog_status_str(YOG_FUEL_EXHAUSTED), "fuel exhausted") == 0, "status: YOG_FUEL_EXHAUSTED");
+	test_check(strcmp(yog_status_str(YOG_DEADLINE_EXCEEDED), "deadline exceeded") == 0, "status: YOG_DEADLINE_EXCEEDED");
+	test_check(strcmp(yog_status_str(YOG_END_OF_INPUT), "end of input") == 0, "status: YOG_END_OF_INPUT");
+	test_check(strcmp(yog_status_str(YOG_INVALID_INPUT), "invalid input") == 0, "status: YOG_INVALID_INPUT");
+}
@@ -0,0 +1,85 @@
+
+# a repeated input replays the outcome of its first execution, a different one is executed
+
+. "$(dirname "$0")/common.sh"
+
+printf '12\n' > sum.out
+printf '5\nx\n' > invalid.in
+printf '5\n8\n' > other.in
+printf '13\n' > other.out
+
+expect "first" 0 sum.out "$YOG" --memo=sum.memo --stats "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+expect_message "first" "memo: 0 hits, 1 misses"
+
+expect "repeated" 0 sum.out "$YOG" --memo=sum.memo --stats "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+expect_message "repeated" "memo: 1 hits, 0 misses"
+
+expect "other input" 0 other.out "$YOG" --memo=sum.memo --stats "$EXAMPLES/sum.yog" < other.in
+expect_message "other input" "memo: 0 hits, 1 misses"
+
+# the runtime errors are stored, then replayed with their statuses and their messages
+for hits in 0 1
+do
+	expect "invalid input" 8 "" "$YOG" --stats --memo=sum.memo "$EXAMPLES/sum.yog" < invalid.in
+	expect_message "invalid input" "invalid input at line 12"
+	expect_message "invalid input" "memo: $hits hits"
+
+	expect "end of input" 7 "" "$YOG" --stats --memo=sum.memo "$EXAMPLES/sum.yog" < /dev/null
+	expect_message "end of input" "end of input at line 11"
+	expect_message "end of input" "memo: $hits hits"
+
+	expect "division" 6 "" "$YOG" --stats --memo=divbyzero.memo "$EXAMPLES/divbyzero.yog" < /dev/null
+	expect_message "division" "division by zero at line 4"
+	expect_message "division" "memo: $hits hits"
+done
+
+# the fuel is part of the key
+expect "unlimited" 0 "" "$YOG" --stats --memo=count.memo "$EXAMPLES/count.yog" < /dev/null
+
+for hits in 0 1
+do
+	expect "fuel" 4 "" "$YOG" --stats --memo=count.memo --fuel=20 "$EXAMPLES/count.yog" < /dev/null
+	expect_message "fuel" "fuel exhausted"
+	expect_message "fuel" "memo: $hits hits"
+done
+
+# a program without read statements does not wait for the end of its input, here a pipe whose writer stays open
+seq 0 9 > count.out
+mkfifo open.fifo
+sleep 120 > open.fifo &
+writer=$!
+
+for hits in 0 1
+do
+	expect "open pipe" 0 count.out "$YOG" --stats --memo=pipe.memo "$EXAMPLES/count.yog" < open.fifo
+	expect_message "open pipe" "memo: $hits hits"
+done
+
+kill "$writer"
+
+# a program which reads is rejected on a terminal, given by the script of util-linux when available
+if script -qec true /dev/null < /dev/null > /dev/null 2>&1
+then
+	expect "terminal" 1 "" script -qec "'$YOG' --memo=sum.memo '$EXAMPLES/sum.yog'" /dev/null
+	expect_message "terminal" "cannot be a terminal"
+else
+	echo "SKIP: terminal, no script command" >&2
+fi
+
+# the bytecode cache keeps the memo of a program when no file is given
+expect "cached memo" 0 sum.out "$YOG" --memo "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+expect "cached memo" 0 sum.out "$YOG" --memo --stats "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+expect_message "cached memo" "memo: 1 hits, 0 misses"
+
+# a memo too small for an outcome with its input does not keep it
+expect "small memo" 0 sum.out "$YOG" --memo=small.memo --memo-size=64 "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+expect "small memo" 0 sum.out "$YOG" --memo=small.memo --memo-size=64 --stats "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+expect_message "small memo" "memo: 0 hits, 1 misses"
+
+# a file which is not a memo of this version is ignored and replaced
+printf 'YOGM\001\0\0\0garbage' > garbage.memo
+expect "garbage memo" 0 sum.out "$YOG" --memo=garbage.memo "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+expect "garbage memo" 0 sum.out "$YOG" --memo=garbage.memo --stats "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+expect_message "garbage memo" "memo: 1 hits, 0 misses"
+
+finish
@@ -0,0 +1,87 @@
+# each execution mode has the output, the exit status and the runtime error of the plain interpreter on the same program
+
+. "$(dirname "$0")/common.sh"
+
+# a hot loop which divides by zero after its compilation by the tiered execution
+cat > hot.yog <<'YOG'
+var
+	i : int;
+begin
+	i := 10;
+
+	while(i > -10)
+	begin
+		write 100 / i;
+		i := i - 1;
+	end
+end
+YOG
+
+printf '5\nx\n' > invalid.in
+: > empty.in
+
+# the programs with their inputs
+set -- \
+	"$EXAMPLES/sum.yog" "$EXAMPLES/sum.in" \
+	"$EXAMPLES/sum.yog" invalid.in \
+	"$EXAMPLES/sum.yog" empty.in \
+	"$EXAMPLES/abs.yog" "$EXAMPLES/abs.in" \
+	"$EXAMPLES/axbpc.yog" "$EXAMPLES/axbpc.in" \
+	"$EXAMPLES/count.yog" empty.in \
+	"$EXAMPLES/fibonacci.yog" empty.in \
+	"$EXAMPLES/divbyzero.yog" empty.in \
+	hot.yog empty.in
+
+CC=${CC:-cc}
+command -v "$CC" > /dev/null || echo "SKIP: emit-c, no C compiler $CC" >&2
+
+# compare a mode with the plain execution: compare <description> <expected status> <expected output> <expected error>
+compare()
+{
+	[ "$actual" -eq "$1" ] || fail "$description: exit status $actual instead of $1"
+	cmp -s "$2" stdout.txt || fail "$description: unexpected output"
+	[ -z "$3" ] || grep -F -q -x -- "$3" stderr.txt || fail "$description: no message \"$3\""
+}
+
+while [ $# -gt 0 ]
+do
+	program=$1
+	input=$2
+	shift 2
+	name=$(basename "$program" .yog)_$(basename "$input" .in)
+
+	"$YOG" "$program" < "$input" > expected.out 2> expected.err
+	status=$?
+	message=$(head -n 1 expected.err)
+
+	# the tiered execution compiles each loop at its first back-edge
+	for mode in --profile --profile=cycles --sample-profile=1000 "--tiered --tier-threshold=1"
+	do
+		description="$name $mode"
+		"$YOG" $mode "$program" < "$input" > stdout.txt 2> stderr.txt
+		actual=$?
+		compare "$status" expected.out "$message"
+	done
+
+	if command -v "$CC" > /dev/null
+	then
+		description="$name --emit-c"
+		"$YOG" --emit-c "$name.c" "$program" && "$CC" -o "$name" "$name.c" || fail "$description: not compiled"
+		"./$name" < "$input" > stdout.txt 2> stderr.txt
+		actual=$?
+		compare "$status" expected.out "$message"
+	fi
+
+	# the lanes execute the input as one record, whose values are written on one line
+	description="$name --lanes"
+	tr '\n' ' ' < "$input" | sed 's/ $//' > record.in
+	printf '\n' >> record.in
+	tr '\n' ' ' < expected.out | sed 's/ $//' > lanes.out
+	printf '\n' >> lanes.out
+
+	"$YOG" --lanes "$program" < record.in > stdout.txt 2> stderr.txt
+	actual=$?
+	compare "$status" lanes.out "${message:+record 1: $message}"
+done
+
+finish
@@ -0,0 +1,44 @@
+# the samples are attributed to the lines running when the timer fires, not to the back-edges of their loops
+
+. "$(dirname "$0")/common.sh"
+
+cat > hot.yog <<'YOG'
+var
+	i : int;
+	a : int;
+	b : int;
+begin
+	i := 0;
+	a := 0;
+	b := 0;
+
+	while(i < 10000000)
+	begin
+		a := a + i * 3 + i * 5 + i * 7 + i * 11 + i * 13;
+		b := b + i * 17 + i * 19 + i * 23 + i * 29 + i * 31;
+		i := i + 1;
+	end
+
+	write a;
+	write b;
+end
+YOG
+
+expect "plain" 0 "" "$YOG" hot.yog
+mv stdout.txt hot.out
+
+expect "sampled" 0 hot.out "$YOG" --sample-profile=1000 hot.yog
+
+# the hottest lines report a line number and its samples on each row, until the hottest loops
+samples()
+{
+	awk -v line="$1" '/^hottest loops/ { exit } $1 == line { print $2 }' stderr.txt
+}
+
+for line in 12 13
+do
+	count=$(samples $line)
+	[ -n "$count" ] && [ "$count" -gt 0 ] || fail "sampled: no samples on line $line"
+done
+
+finish
@@ -0,0 +1,96 @@
+
+# the requests of the clients of a server, their statuses, their limits and the stop of the server
+
+. "$(dirname "$0")/common.sh"
+
+write_loop
+printf '12\n' > sum.out
+printf '5\nx\n' > invalid.in
+
+# a single worker with the default fuel and quantum, so a request which never ends must yield to the others
+"$YOG" --serve server.sock -j1 --stats 2> server.err &
+server=$!
+trap 'kill $server 2> /dev/null; rm -rf "$WORK"' EXIT
+
+tries=0
+while [ ! -S server.sock ] && [ $tries -lt 50 ]
+do
+	sleep 0.1
+	tries=$((tries + 1))
+done
+
+[ -S server.sock ] || { fail "server not started"; finish; }
+
+expect "halted" 0 sum.out "$YOG" --client server.sock "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+expect "cached" 0 sum.out "$YOG" --client server.sock "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+
+printf '\005\0\0\0\0\0\0\0\007\0\0\0\0\0\0\0' > sum.bin.in
+printf '\014\0\0\0\0\0\0\0' > sum.bin
+expect "binary" 0 sum.bin "$YOG" --client server.sock --io=binary "$EXAMPLES/sum.yog" < sum.bin.in
+
+expect "division" 6 "" "$YOG" --client server.sock "$EXAMPLES/divbyzero.yog" < /dev/null
+expect_message "division" "division by zero at line 4"
+
+expect "end of input" 7 "" "$YOG" --client server.sock "$EXAMPLES/sum.yog" < /dev/null
+expect_message "end of input" "end of input at line 11"
+
+expect "invalid input" 8 "" "$YOG" --client server.sock "$EXAMPLES/sum.yog" < invalid.in
+expect_message "invalid input" "invalid input at line 12"
+
+expect "fuel of the request" 4 "" "$YOG" --client server.sock --fuel=1000 loop.yog < /dev/null
+expect_message "fuel of the request" "fuel exhausted"
+
+# a request which never ends does not hold the worker, and it is stopped with the server
+"$YOG" --client server.sock loop.yog < /dev/null > /dev/null 2> loop.err &
+loop=$!
+sleep 0.2
+
+expect "beside an endless request" 0 sum.out "$YOG" --client server.sock "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+
+# several clients at once, each with its own input
+clients=""
+i=1
+while [ $i -le 8 ]
+do
+	printf '%s\n%s\n' $i $((i * 100)) > many$i.in
+	"$YOG" --client server.sock "$EXAMPLES/sum.yog" < many$i.in > many$i.out &
+	clients="$clients $!"
+	i=$((i + 1))
+done
+
+wait $clients
+
+i=1
+while [ $i -le 8 ]
+do
+	[ "$(cat many$i.out)" = $((i * 101)) ] || fail "concurrent request $i: unexpected output"
+	i=$((i + 1))
+done
+
+# a request waiting for its input when the server stops ends as at the end of its input, the fifo is held open meanwhile
+mkfifo pending
+exec 3<> pending
+"$YOG" --client server.sock "$EXAMPLES/sum.yog" < pending > /dev/null 2> pending.err &
+pending=$!
+sleep 0.2
+
+kill -TERM $server
+wait $server
+status=$?
+[ $status -eq 0 ] || fail "stop: exit status $status instead of 0"
+
+wait $pending
+status=$?
+[ $status -eq 7 ] || fail "pending request: exit status $status instead of 7"
+
+wait $loop
+status=$?
+[ $status -eq 5 ] || fail "endless request: exit status $status instead of 5"
+exec 3>&-
+
+[ -S server.sock ] && fail "socket not removed"
+grep -q "compilations: 3" server.err || fail "cache: $(grep compilations server.err)"
+
+expect "stopped server" 2 "" "$YOG" --client server.sock "$EXAMPLES/sum.yog" < "$EXAMPLES/sum.in"
+
+finish
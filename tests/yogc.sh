@@ -0,0 +1,65 @@
+
+# the precompiled bytecode executes as its source code, and a corrupted bytecode is rejected rather than executed
+
+. "$(dirname "$0")/common.sh"
+
+for program in "$EXAMPLES"/*.yog
+do
+	name=$(basename "$program" .yog)
+	input=/dev/null
+	[ -f "$EXAMPLES/$name.in" ] && input=$EXAMPLES/$name.in
+
+	expect "$name compiled" 0 "" "$YOG" --compile-only="$name.yogc" "$program"
+
+	for dispatch in threaded call
+	do
+		"$YOG" --dispatch=$dispatch --no-cache "$program" < "$input" > "$name.out" 2> /dev/null
+		status=$?
+
+		expect "$name.yogc $dispatch" $status "$name.out" "$YOG" --dispatch=$dispatch "$name.yogc" < "$input"
+
+		# the second execution of the source code loads it from the bytecode cache
+		expect "$name cached $dispatch" $status "$name.out" "$YOG" --dispatch=$dispatch "$program" < "$input"
+		expect "$name cached $dispatch" $status "$name.out" "$YOG" --dispatch=$dispatch "$program" < "$input"
+	done
+done
+
+# overwrite bytes of a bytecode: corrupt <bytecode> <offset> <bytes>
+corrupt()
+{
+	printf "$3" | dd of="$1" bs=1 seek="$2" conv=notrunc 2> /dev/null
+}
+
+# the instructions start at the offset stored after the magic number, the version and eight other fields
+code=$(od -An -t u8 -j 72 -N 8 count.yogc | tr -d ' ')
+printf '0\n1\n2\n3\n4\n5\n6\n7\n8\n9\n' > count.out
+
+for corrupted in magic type operation kinds super source destination truncated
+do
+	cp count.yogc $corrupted.yogc
+done
+
+corrupt magic.yogc 0 'XXXX'
+corrupt type.yogc $code '\310'
+corrupt operation.yogc $((code + 1)) '\372'
+corrupt kinds.yogc $((code + 2)) '\377'
+corrupt super.yogc $((code + 3)) '\377'
+corrupt source.yogc $((code + 4)) '\377\377\377\177'
+corrupt destination.yogc $((code + 12)) '\377\377\377\177'
+head -c 100 count.yogc > truncated.yogc
+
+for corrupted in magic type operation kinds super source destination truncated
+do
+	expect "$corrupted rejected" 2 "" "$YOG" $corrupted.yogc < /dev/null
+	grep -q '^0$' stdout.txt && fail "$corrupted executed"
+done
+
+# a corrupted file of the cache is compiled again
+for cached in cache/*.yogc
+do
+	corrupt "$cached" $code '\310'
+done
+
+expect "corrupted cache" 0 count.out "$YOG" "$EXAMPLES/count.yog" < /dev/null
+
+finish
@@ -0,0 +1,170 @@
+
+// supergen: select the superinstructions from the sequence profiles written by yog --profile-sequences
+// and generate the superinstructions header, as the most frequent pairs and triples of operations
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_SIZE 256
+#define SUPERINSTRUCTIONS_MAX 255
+
+struct sequence
+{
+	char ops[LINE_SIZE];
+	int length;
+	unsigned long long count;
+};
+
+int compare_ops(const void *a, const void *b)
+{
+	return strcmp(((const struct sequence *)a)->ops, ((const struct sequence *)b)->ops);
+}
+
+int compare_benefit(const void *a, const void *b)
+{
+	const struct sequence *x = a;
+	const struct sequence *y = b;
+
+	// a sequence of n operations saves n - 1 dispatches on each execution
+	unsigned long long bx = x->count * (x->length - 1);
+	unsigned long long by = y->count * (y->length - 1);
+
+	if(bx != by)
+		return bx < by ? 1 : -1;
+
+	return strcmp(x->ops, y->ops);
+}
+
+void print_list(FILE *out, const char *name, struct sequence *seqs, size_t cnt, int length)
+{
+	fprintf(out, "#define %s(X)", name);
+
+	for(size_t i = 0; i < cnt; i++)
+	{
+		if(seqs[i].length != length)
+			continue;
+
+		fprintf(out, " \\\n\tX(");
+
+		// separate the operations with commas
+		for(const char *c = seqs[i].ops; *c != '\0'; c++)
+		{
+			if(*c == ' ')
+				fputs(", ", out);
+			else
+				fputc(*c, out);
+		}
+
+		fprintf(out, ")");
+	}
+
+	fprintf(out, "\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *output = NULL;
+	size_t max_cnt = 32;
+	int first = 1;
+
+	for(; first < argc && argv[first][0] == '-'; first++)
+	{
+		if(strcmp(argv[first], "-o") == 0 && first + 1 < argc)
+			output = argv[++first];
+		else if(strcmp(argv[first], "-n") == 0 && first + 1 < argc)
+			max_cnt = strtoul(argv[++first], NULL, 10);
+		else
+			break;
+	}
+
+	if(first >= argc || max_cnt > SUPERINSTRUCTIONS_MAX)
+	{
+		fprintf(stderr, "usage:\tsupergen [-n count] [-o output] <profile>...\n");
+		return 1;
+	}
+
+	struct sequence *seqs = NULL;
+	size_t seqs_cnt = 0;
+	size_t seqs_cap = 0;
+
+	// read the sequences of all the profiles
+	for(int i = first; i < argc; i++)
+	{
+		FILE *in = fopen(argv[i], "r");
+		if(!in)
+		{
+			fprintf(stderr, "failed to open %s\n", argv[i]);
+			return 2;
+		}
+
+		char line[LINE_SIZE];
+		while(fgets(line, LINE_SIZE, in))
+		{
+			unsigned long long count;
+			int offset;
+
+			if(sscanf(line, "%llu %n", &count, &offset) != 1)
+				continue;
+
+			if(seqs_cnt == seqs_cap)
+			{
+				seqs_cap = seqs_cap ? 2 * seqs_cap : 64;
+				seqs = realloc(seqs, seqs_cap * sizeof(struct sequence));
+				if(!seqs)
+					return 3;
+			}
+
+			struct sequence *seq = &seqs[seqs_cnt++];
+			line[strcspn(line, "\r\n")] = '\0';
+			strcpy(seq->ops, line + offset);
+			seq->count = count;
+			seq->length = 1;
+
+			for(const char *c = seq->ops; *c != '\0'; c++)
+				seq->length += *c == ' ';
+		}
+
+		fclose(in);
+	}
+
+	// merge the counts of the same sequences
+	qsort(seqs, seqs_cnt, sizeof(struct sequence), compare_ops);
+
+	size_t merged_cnt = 0;
+	for(size_t i = 0; i < seqs_cnt; i++)
+	{
+		if(merged_cnt > 0 && strcmp(seqs[merged_cnt-1].ops, seqs[i].ops) == 0)
+			seqs[merged_cnt-1].count += seqs[i].count;
+		else
+			seqs[merged_cnt++] = seqs[i];
+	}
+
+	// keep the sequences saving the most dispatches
+	qsort(seqs, merged_cnt, sizeof(struct sequence), compare_benefit);
+
+	if(merged_cnt > max_cnt)
+		merged_cnt = max_cnt;
+
+	FILE *out = output ? fopen(output, "w") : stdout;
+	if(!out)
+	{
+		fprintf(stderr, "failed to open %s\n", output);
+		return 2;
+	}
+
+	fprintf(out, "\n/*! @file superinstructions.h */\n\n");
+	fprintf(out, "// generated by supergen from a sequence profile, regenerate it with the superinstructions target\n\n");
+	fprintf(out, "#pragma once\n\n");
+	fprintf(out, "/*! @brief The superinstructions made of two operations */\n");
+	print_list(out, "SUPERINSTRUCTION_PAIRS", seqs, merged_cnt, 2);
+	fprintf(out, "\n/*! @brief The superinstructions made of three operations */\n");
+	print_list(out, "SUPERINSTRUCTION_TRIPLES", seqs, merged_cnt, 3);
+
+	if(output)
+		fclose(out);
+
+	free(seqs);
+
+	return 0;
+}